@@ -0,0 +1,328 @@
+#ifndef _DEF_RTAC_BASE_BENCHMARK_H_
+#define _DEF_RTAC_BASE_BENCHMARK_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <cstdint>
+
+#include <rtac_base/time.h>
+#include <rtac_base/perf_counters.h>
+#include <rtac_base/allocation_tracker.h>
+
+namespace rtac { namespace bench {
+
+// Micro-benchmark harness.
+//
+// A benchmark is a function taking a State. The timed part is the body of
+// the range-for loop over the state, which runs state.iterations() times :
+//
+//     rtac::bench::Suite suite("reductions");
+//     suite.add("reduce", [](rtac::bench::State& state) {
+//         std::vector<float> data(state.param("size"), 1.0f);
+//         for(auto _ : state) {
+//             rtac::bench::do_not_optimize(reduce(data.data(), data.size()));
+//         }
+//         state.set_bytes_per_iteration(data.size()*sizeof(float));
+//     }).sweep("size", rtac::bench::range(1024, 1 << 24, 8));
+//     return suite.main(argc, argv);
+//
+// Each parameter combination is warmed up while the number of iterations per
+// sample is adapted to make a sample long enough to be measured accurately.
+// Then samples are taken until both a minimum number of samples and a minimum
+// time are reached. The reported time per iteration is the median of the
+// samples, with the median absolute deviation as the noise estimate (samples
+// further than 3 deviations from the median are reported as outliers and
+// excluded from the robust mean).
+//
+// Results can be written as JSON (--json=file) and compared with the
+// bench_compare tool. When the executable links rtac_base_allocation_hooks,
+// the heap allocations per iteration of the timed part are reported as well.
+
+/**
+ * Prevents the compiler from optimizing away the computation of value (the
+ * value is considered read and possibly modified by an opaque operation).
+ */
+template <typename T> inline void do_not_optimize(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+template <typename T> inline void do_not_optimize(T& value)
+{
+    #if defined(__clang__)
+    asm volatile("" : "+r,m"(value) : : "memory");
+    #else
+    asm volatile("" : "+m,r"(value) : : "memory");
+    #endif
+}
+
+/**
+ * Forces all pending memory writes to be considered visible (prevents the
+ * compiler from eliminating stores to memory which is never read).
+ */
+inline void clobber_memory()
+{
+    asm volatile("" : : : "memory");
+}
+
+using Parameters = std::vector<std::pair<std::string, int64_t>>;
+
+/**
+ * Benchmark state : parameters, iteration count and timer of one sample.
+ */
+class State
+{
+    public:
+
+    using Ticks = time::TickClock::Ticks;
+
+    class Iterator
+    {
+        protected:
+
+        State*   state_;
+        uint64_t remaining_;
+
+        public:
+
+        // The user-provided destructor makes the compiler consider the loop
+        // variable used (no unused variable warning for "auto _").
+        struct Value { ~Value() {} };
+
+        Iterator(State* state, uint64_t remaining) : state_(state), remaining_(remaining) {}
+
+        Value     operator*() const { return Value(); }
+        Iterator& operator++()      { remaining_--; return *this; }
+        bool operator!=(const Iterator&) {
+            if(remaining_ > 0)
+                return true;
+            state_->pause_timing();
+            return false;
+        }
+    };
+
+    protected:
+
+    const Parameters&              params_;
+    uint64_t                       iterations_;
+    Ticks                          start_;
+    Ticks                          elapsed_;
+    bool                           running_;
+    bool                           iterated_;
+    double                         bytesPerIteration_;
+    double                         itemsPerIteration_;
+    std::map<std::string, double>  counters_;
+    std::string                    error_;
+    time::PerfCounterGroup*        perf_;
+    time::PerfCounterValues        perfValues_;
+    bool                           trackAllocations_;
+    uint64_t                       allocationStart_;
+    uint64_t                       allocations_;
+
+    public:
+
+    State(const Parameters& params, uint64_t iterations,
+          time::PerfCounterGroup* perf = nullptr);
+
+    Iterator begin() {
+        iterated_ = true;
+        this->resume_timing();
+        return Iterator(this, iterations_);
+    }
+    Iterator end() { return Iterator(this, 0); }
+
+    /**
+     * Excludes a part of the loop body from the measurement.
+     */
+    void pause_timing() {
+        if(!running_) return;
+        elapsed_ += time::TickClock::now() - start_;
+        running_  = false;
+        if(perf_) perfValues_ += perf_->stop();
+        if(trackAllocations_) allocations_ += thread_allocations() - allocationStart_;
+    }
+    void resume_timing() {
+        if(running_) return;
+        running_ = true;
+        if(trackAllocations_) allocationStart_ = thread_allocations();
+        if(perf_) perf_->start();
+        start_ = time::TickClock::now();
+    }
+
+    uint64_t          iterations() const { return iterations_; }
+    const Parameters& params()     const { return params_; }
+    int64_t param(const std::string& name) const;
+    int64_t param(unsigned int index)      const { return params_.at(index).second; }
+
+    void set_bytes_per_iteration(double bytes) { bytesPerIteration_ = bytes; }
+    void set_items_per_iteration(double items) { itemsPerIteration_ = items; }
+    // Additional value reported as is (last sample wins).
+    void set_counter(const std::string& name, double value) { counters_[name] = value; }
+    // Stops the benchmark for these parameters, reporting message.
+    void skip(const std::string& message) { error_ = message; }
+
+    bool   iterated()            const { return iterated_; }
+    double seconds()             const { return time::TickClock::to_seconds(elapsed_); }
+    double bytes_per_iteration() const { return bytesPerIteration_; }
+    double items_per_iteration() const { return itemsPerIteration_; }
+    const std::map<std::string, double>& counters()    const { return counters_;   }
+    const std::string&                   error()       const { return error_;      }
+    const time::PerfCounterValues&       perf_values() const { return perfValues_; }
+    // Heap allocations in the timed part (0 if not tracked).
+    uint64_t allocations() const { return allocations_; }
+
+    static uint64_t thread_allocations() {
+        return memory::AllocationTracker::thread_counters().allocations;
+    }
+};
+
+/**
+ * Robust statistics of a set of samples.
+ */
+struct SampleStats
+{
+    std::size_t count      = 0;
+    double      median     = 0.0;
+    double      mad        = 0.0; // median absolute deviation, scaled to be
+                                  // comparable to a standard deviation
+    double      mean       = 0.0;
+    double      robustMean = 0.0; // mean without the outliers
+    double      stddev     = 0.0;
+    double      min        = 0.0;
+    double      max        = 0.0;
+    std::size_t outliers   = 0;   // samples further than 3 mad from the median
+
+    static SampleStats compute(std::vector<double> samples);
+};
+
+/**
+ * Measurements of a benchmark for a single parameter combination. Times are
+ * in seconds per iteration.
+ */
+struct Result
+{
+    std::string                   name;    // family/param:value/...
+    std::string                   family;
+    Parameters                    params;
+    uint64_t                      iterations = 0; // per sample
+    SampleStats                   time;
+    double                        bytesPerSecond = 0.0;
+    double                        itemsPerSecond = 0.0;
+    std::map<std::string, double> counters; // user counters and hardware counters per iteration
+    std::string                   error;
+};
+
+struct Options
+{
+    double      warmupTime     = 0.05;
+    double      minSampleTime  = 2.0e-3; // adapts iterations per sample
+    double      minTime        = 0.2;    // minimum total sampled time
+    double      maxTime        = 5.0;
+    std::size_t minSamples     = 10;
+    std::size_t maxSamples     = 1000;
+    bool        perfCounters   = false;
+    std::string filter;                  // runs only names containing filter
+    std::string jsonPath;
+};
+
+/**
+ * A benchmark function with its parameter sweeps. The benchmark is run for
+ * each combination (cartesian product) of the swept values.
+ */
+class Benchmark
+{
+    public:
+
+    using Function = std::function<void(State&)>;
+
+    protected:
+
+    std::string                                               name_;
+    Function                                                  function_;
+    std::vector<std::pair<std::string, std::vector<int64_t>>> sweeps_;
+
+    public:
+
+    Benchmark(const std::string& name, Function function) :
+        name_(name), function_(std::move(function))
+    {}
+
+    Benchmark& sweep(const std::string& param, const std::vector<int64_t>& values) {
+        sweeps_.push_back(std::make_pair(param, values));
+        return *this;
+    }
+
+    const std::string& name()     const { return name_;     }
+    const Function&    function() const { return function_; }
+    std::vector<Parameters> combinations() const;
+};
+
+// Geometric sequence from first to last (included).
+std::vector<int64_t> range(int64_t first, int64_t last, int64_t multiplier = 2);
+// Powers of 2 from 1 to the number of hardware threads (included).
+std::vector<int64_t> thread_range();
+
+class Suite
+{
+    protected:
+
+    std::string            name_;
+    std::vector<Benchmark> benchmarks_;
+
+    public:
+
+    Suite(const std::string& name) : name_(name) {}
+
+    Benchmark& add(const std::string& name, Benchmark::Function function);
+
+    Result              run(const Benchmark& benchmark, const Parameters& params,
+                            const Options& options) const;
+    std::vector<Result> run(const Options& options, std::ostream& os = std::cout) const;
+
+    /**
+     * Runs the suite with options from the command line (--help for the
+     * list). Returns a process exit code.
+     */
+    int main(int argc, char** argv) const;
+
+    const std::string& name() const { return name_; }
+};
+
+void print_result(std::ostream& os, const Result& result);
+void write_json(std::ostream& os, const std::string& suiteName,
+                const std::vector<Result>& results);
+void write_json(const std::string& path, const std::string& suiteName,
+                const std::vector<Result>& results);
+std::vector<Result> read_json(const std::string& path);
+
+/**
+ * Relative change of the median time of a benchmark between two runs.
+ */
+struct Comparison
+{
+    enum Verdict { Unchanged, Improved, Regressed, Missing, New };
+
+    std::string name;
+    double      oldTime = 0.0;
+    double      newTime = 0.0;
+    double      change  = 0.0; // newTime / oldTime - 1
+    Verdict     verdict = Unchanged;
+};
+
+/**
+ * A benchmark is flagged when its median time changed by more than
+ * threshold (relative) and by more than 3 standard errors of the difference
+ * of the medians (estimated from the deviations and sample counts).
+ */
+std::vector<Comparison> compare(const std::vector<Result>& oldResults,
+                                const std::vector<Result>& newResults,
+                                double threshold = 0.05);
+std::ostream& print_comparisons(std::ostream& os, const std::vector<Comparison>& comparisons);
+
+}; //namespace bench
+}; //namespace rtac
+
+#endif //_DEF_RTAC_BASE_BENCHMARK_H_
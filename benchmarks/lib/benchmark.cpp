@@ -0,0 +1,662 @@
+#include <rtac_base/benchmark.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <unistd.h>
+
+namespace rtac { namespace bench {
+
+// State implementation //////////////////////////////////////////////////
+State::State(const Parameters& params, uint64_t iterations, time::PerfCounterGroup* perf) :
+    params_(params),
+    iterations_(iterations),
+    start_(0),
+    elapsed_(0),
+    running_(false),
+    iterated_(false),
+    bytesPerIteration_(0.0),
+    itemsPerIteration_(0.0),
+    perf_(perf),
+    trackAllocations_(memory::AllocationTracker::hooks_installed()),
+    allocationStart_(0),
+    allocations_(0)
+{}
+
+int64_t State::param(const std::string& name) const
+{
+    for(auto& p : params_) {
+        if(p.first == name)
+            return p.second;
+    }
+    throw std::runtime_error("Unknown benchmark parameter : " + name);
+}
+
+// SampleStats implementation ////////////////////////////////////////////
+SampleStats SampleStats::compute(std::vector<double> samples)
+{
+    SampleStats res;
+    res.count = samples.size();
+    if(res.count == 0)
+        return res;
+
+    auto median = [](std::vector<double>& values) {
+        std::sort(values.begin(), values.end());
+        std::size_t n = values.size();
+        return n % 2 ? values[n / 2] : 0.5*(values[n/2 - 1] + values[n/2]);
+    };
+
+    res.median = median(samples);
+    res.min    = samples.front();
+    res.max    = samples.back();
+
+    std::vector<double> deviations(samples.size());
+    for(std::size_t i = 0; i < samples.size(); i++) {
+        deviations[i] = std::abs(samples[i] - res.median);
+    }
+    // 1.4826 makes the MAD an estimator of the standard deviation for
+    // normally distributed samples.
+    res.mad = 1.4826*median(deviations);
+
+    double sum = 0.0, sumSquared = 0.0, inlierSum = 0.0;
+    std::size_t inliers = 0;
+    for(auto s : samples) {
+        sum        += s;
+        sumSquared += s*s;
+        if(res.mad > 0.0 && std::abs(s - res.median) > 3.0*res.mad) {
+            res.outliers++;
+            continue;
+        }
+        inlierSum += s;
+        inliers++;
+    }
+    res.mean       = sum / res.count;
+    res.stddev     = std::sqrt(std::max(sumSquared / res.count - res.mean*res.mean, 0.0));
+    res.robustMean = inlierSum / inliers;
+    return res;
+}
+
+// Benchmark implementation //////////////////////////////////////////////
+std::vector<Parameters> Benchmark::combinations() const
+{
+    std::vector<Parameters> res(1);
+    for(auto& sweep : sweeps_) {
+        std::vector<Parameters> expanded;
+        for(auto& params : res) {
+            for(auto value : sweep.second) {
+                expanded.push_back(params);
+                expanded.back().push_back(std::make_pair(sweep.first, value));
+            }
+        }
+        res = std::move(expanded);
+    }
+    return res;
+}
+
+std::vector<int64_t> range(int64_t first, int64_t last, int64_t multiplier)
+{
+    std::vector<int64_t> res;
+    for(int64_t v = first; v <= last; v *= std::max<int64_t>(multiplier, 2)) {
+        res.push_back(v);
+    }
+    if(res.size() > 0 && res.back() != last)
+        res.push_back(last);
+    return res;
+}
+
+std::vector<int64_t> thread_range()
+{
+    return range(1, std::max(1u, std::thread::hardware_concurrency()), 2);
+}
+
+// Suite implementation //////////////////////////////////////////////////
+Benchmark& Suite::add(const std::string& name, Benchmark::Function function)
+{
+    benchmarks_.push_back(Benchmark(name, std::move(function)));
+    return benchmarks_.back();
+}
+
+static std::string result_name(const std::string& family, const Parameters& params)
+{
+    std::string res = family;
+    for(auto& p : params) {
+        res += "/" + p.first + ":" + std::to_string(p.second);
+    }
+    return res;
+}
+
+/**
+ * Runs a benchmark for a single parameter combination.
+ */
+Result Suite::run(const Benchmark& benchmark, const Parameters& params,
+                  const Options& options) const
+{
+    Result res;
+    res.family = benchmark.name();
+    res.params = params;
+    res.name   = result_name(res.family, params);
+
+    std::unique_ptr<time::PerfCounterGroup> perf;
+    if(options.perfCounters)
+        perf.reset(new time::PerfCounterGroup());
+
+    auto run_sample = [&](uint64_t iterations, bool measurePerf) {
+        State state(params, iterations, measurePerf ? perf.get() : nullptr);
+        benchmark.function()(state);
+        if(state.error().empty() && !state.iterated())
+            state.skip("benchmark function did not iterate over the state");
+        return state;
+    };
+
+    // Warmup, adapting the number of iterations per sample.
+    uint64_t iterations = 1;
+    time::Clock clock;
+    while(true) {
+        auto state = run_sample(iterations, false);
+        if(!state.error().empty()) {
+            res.error = state.error();
+            return res;
+        }
+        double t = state.seconds();
+        if(t < options.minSampleTime) {
+            double factor = t > 0.0 ? 1.4*options.minSampleTime / t : 10.0;
+            iterations = std::max<uint64_t>(iterations + 1,
+                                            iterations*std::min(factor, 10.0));
+            continue;
+        }
+        if(clock.now() >= options.warmupTime)
+            break;
+    }
+    res.iterations = iterations;
+
+    std::vector<double> samples;
+    double total = 0.0;
+    time::PerfCounterValues perfValues;
+    uint64_t allocations = 0;
+    while(samples.size() < options.maxSamples && total < options.maxTime
+          && (samples.size() < options.minSamples || total < options.minTime))
+    {
+        auto state = run_sample(iterations, true);
+        if(!state.error().empty()) {
+            res.error = state.error();
+            return res;
+        }
+        samples.push_back(state.seconds() / iterations);
+        total += state.seconds();
+        perfValues += state.perf_values();
+        allocations += state.allocations();
+        res.counters = state.counters();
+        res.bytesPerSecond = state.bytes_per_iteration();
+        res.itemsPerSecond = state.items_per_iteration();
+    }
+
+    res.time = SampleStats::compute(samples);
+    if(res.time.median > 0.0) {
+        res.bytesPerSecond /= res.time.median;
+        res.itemsPerSecond /= res.time.median;
+    }
+    double totalIterations = double(iterations)*samples.size();
+    if(memory::AllocationTracker::hooks_installed())
+        res.counters["allocations"] = allocations / totalIterations;
+    if(perf) {
+        for(unsigned int c = 0; c < time::PerfCounterValues::CounterCount; c++) {
+            auto counter = (time::PerfCounterValues::Counter)c;
+            if(perfValues.valid(counter)) {
+                res.counters[time::PerfCounterValues::name(counter)]
+                    = perfValues[counter] / totalIterations;
+            }
+        }
+    }
+    return res;
+}
+
+std::vector<Result> Suite::run(const Options& options, std::ostream& os) const
+{
+    std::vector<Result> results;
+    for(auto& benchmark : benchmarks_) {
+        for(auto& params : benchmark.combinations()) {
+            if(!options.filter.empty()
+               && result_name(benchmark.name(), params).find(options.filter) == std::string::npos)
+                continue;
+            results.push_back(this->run(benchmark, params, options));
+            print_result(os, results.back());
+        }
+    }
+    return results;
+}
+
+int Suite::main(int argc, char** argv) const
+{
+    Options options;
+    for(int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        auto value = [&](const std::string& prefix) {
+            return arg.substr(prefix.size());
+        };
+        if(arg == "--help" || arg == "-h") {
+            std::cout << "Usage : " << argv[0] << " [options]\n"
+                      << "    --filter=<text>      runs benchmarks whose name contains text\n"
+                      << "    --json=<path>        writes the results as JSON\n"
+                      << "    --min-time=<s>       minimum sampled time per benchmark ("
+                      << options.minTime << ")\n"
+                      << "    --warmup=<s>         warmup time per benchmark ("
+                      << options.warmupTime << ")\n"
+                      << "    --min-samples=<n>    minimum number of samples ("
+                      << options.minSamples << ")\n"
+                      << "    --perf               measures hardware counters\n";
+            return 0;
+        }
+        else if(arg.rfind("--filter=", 0) == 0)      options.filter     = value("--filter=");
+        else if(arg.rfind("--json=", 0) == 0)        options.jsonPath   = value("--json=");
+        else if(arg.rfind("--min-time=", 0) == 0)    options.minTime    = std::stod(value("--min-time="));
+        else if(arg.rfind("--warmup=", 0) == 0)      options.warmupTime = std::stod(value("--warmup="));
+        else if(arg.rfind("--min-samples=", 0) == 0) options.minSamples = std::stoul(value("--min-samples="));
+        else if(arg == "--perf")                     options.perfCounters = true;
+        else {
+            std::cerr << "Unknown option " << arg << " (--help for usage)" << std::endl;
+            return 1;
+        }
+    }
+
+    if(options.perfCounters) {
+        time::PerfCounterGroup group;
+        if(!group.available())
+            std::cout << "Hardware counters unavailable : " << group.error() << "\n";
+    }
+    std::cout << "Benchmark suite " << name_ << " (" << std::thread::hardware_concurrency()
+              << " hardware threads, " << (time::TickClock::uses_tsc() ? "TSC" : "monotonic")
+              << " clock)\n";
+
+    auto results = this->run(options);
+    if(!options.jsonPath.empty())
+        write_json(options.jsonPath, name_, results);
+    return 0;
+}
+
+// Output ////////////////////////////////////////////////////////////////
+static std::string format_time(double seconds)
+{
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(3);
+    if(seconds < 1.0e-6)      oss << 1.0e9*seconds << "ns";
+    else if(seconds < 1.0e-3) oss << 1.0e6*seconds << "us";
+    else if(seconds < 1.0)    oss << 1.0e3*seconds << "ms";
+    else                      oss << seconds << "s";
+    return oss.str();
+}
+
+void print_result(std::ostream& os, const Result& result)
+{
+    auto flags     = os.flags();
+    auto precision = os.precision();
+    os << std::left << std::setw(48) << result.name << std::right;
+    if(!result.error.empty()) {
+        os << " skipped : " << result.error << std::endl;
+        os.flags(flags);
+        return;
+    }
+    os << std::setw(14) << format_time(result.time.median)
+       << " +/- " << std::fixed << std::setprecision(1) << std::setw(5)
+       << (result.time.median > 0.0 ? 100.0*result.time.mad / result.time.median : 0.0) << "%"
+       << std::setw(10) << result.iterations << " x " << std::left << std::setw(5)
+       << result.time.count << std::right;
+    if(result.time.outliers > 0)
+        os << " (" << result.time.outliers << " outliers)";
+    os << std::setprecision(3);
+    if(result.bytesPerSecond > 0.0)
+        os << "  " << 1.0e-9*result.bytesPerSecond << " GB/s";
+    if(result.itemsPerSecond > 0.0)
+        os << "  " << 1.0e-6*result.itemsPerSecond << " M items/s";
+    for(auto& c : result.counters) {
+        os << "  " << c.first << " : " << c.second;
+    }
+    os << std::endl;
+    os.flags(flags);
+    os.precision(precision);
+}
+
+static std::string json_string(const std::string& s)
+{
+    std::string res = "\"";
+    for(char c : s) {
+        if(c == '"' || c == '\\') { res += '\\'; res += c; }
+        else if(c == '\n')        { res += "\\n"; }
+        else if((unsigned char)c < 0x20) { res += ' '; }
+        else                      { res += c; }
+    }
+    return res + "\"";
+}
+
+void write_json(std::ostream& os, const std::string& suiteName,
+                const std::vector<Result>& results)
+{
+    char host[256] = "unknown";
+    gethostname(host, sizeof(host) - 1);
+    std::time_t now = std::time(nullptr);
+    char date[64];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    auto flags     = os.flags();
+    auto precision = os.precision();
+    os << std::setprecision(9);
+    os << "{\n  \"context\": {\n"
+       << "    \"suite\": "            << json_string(suiteName) << ",\n"
+       << "    \"date\": "             << json_string(date) << ",\n"
+       << "    \"host\": "             << json_string(host) << ",\n"
+       << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n"
+       << "    \"clock\": "            << json_string(time::TickClock::uses_tsc() ? "tsc" : "monotonic")
+       << "\n  },\n  \"benchmarks\": [";
+    for(std::size_t i = 0; i < results.size(); i++) {
+        auto& r = results[i];
+        os << (i ? "," : "") << "\n    {\n"
+           << "      \"name\": "   << json_string(r.name)   << ",\n"
+           << "      \"family\": " << json_string(r.family) << ",\n"
+           << "      \"params\": {";
+        for(std::size_t p = 0; p < r.params.size(); p++) {
+            os << (p ? ", " : "") << json_string(r.params[p].first) << ": " << r.params[p].second;
+        }
+        os << "},\n";
+        if(!r.error.empty()) {
+            os << "      \"error\": " << json_string(r.error) << "\n    }";
+            continue;
+        }
+        os << "      \"iterations\": "       << r.iterations         << ",\n"
+           << "      \"samples\": "          << r.time.count         << ",\n"
+           << "      \"median\": "           << r.time.median        << ",\n"
+           << "      \"mad\": "              << r.time.mad           << ",\n"
+           << "      \"mean\": "             << r.time.mean          << ",\n"
+           << "      \"robust_mean\": "      << r.time.robustMean    << ",\n"
+           << "      \"stddev\": "           << r.time.stddev        << ",\n"
+           << "      \"min\": "              << r.time.min           << ",\n"
+           << "      \"max\": "              << r.time.max           << ",\n"
+           << "      \"outliers\": "         << r.time.outliers      << ",\n"
+           << "      \"bytes_per_second\": " << r.bytesPerSecond     << ",\n"
+           << "      \"items_per_second\": " << r.itemsPerSecond     << ",\n"
+           << "      \"counters\": {";
+        std::size_t c = 0;
+        for(auto& counter : r.counters) {
+            os << (c++ ? ", " : "") << json_string(counter.first) << ": " << counter.second;
+        }
+        os << "}\n    }";
+    }
+    os << "\n  ]\n}\n";
+    os.flags(flags);
+    os.precision(precision);
+}
+
+void write_json(const std::string& path, const std::string& suiteName,
+                const std::vector<Result>& results)
+{
+    std::ofstream f(path);
+    if(!f.is_open())
+        throw std::runtime_error("Could not open file for writing : " + path);
+    write_json(f, suiteName, results);
+}
+
+// JSON reading //////////////////////////////////////////////////////////
+namespace details {
+
+/**
+ * Minimal JSON parser, sufficient to read back the output of write_json.
+ */
+struct JsonValue
+{
+    enum Type { Null, Bool, Number, String, Array, Object };
+
+    Type                                          type   = Null;
+    double                                        number = 0.0;
+    std::string                                   string;
+    std::vector<JsonValue>                        array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    const JsonValue* find(const std::string& key) const {
+        for(auto& item : object) {
+            if(item.first == key) return &item.second;
+        }
+        return nullptr;
+    }
+    double number_or(const std::string& key, double fallback) const {
+        auto v = this->find(key);
+        return v && v->type == Number ? v->number : fallback;
+    }
+    std::string string_or(const std::string& key, const std::string& fallback) const {
+        auto v = this->find(key);
+        return v && v->type == String ? v->string : fallback;
+    }
+};
+
+class JsonParser
+{
+    protected:
+
+    const std::string& text_;
+    std::size_t        pos_;
+
+    void skip_spaces() {
+        while(pos_ < text_.size() && std::isspace((unsigned char)text_[pos_])) pos_++;
+    }
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("JSON parse error at offset " + std::to_string(pos_) + " : " + what);
+    }
+    void expect(char c) {
+        this->skip_spaces();
+        if(pos_ >= text_.size() || text_[pos_] != c)
+            this->fail(std::string("expected '") + c + "'");
+        pos_++;
+    }
+    bool accept(char c) {
+        this->skip_spaces();
+        if(pos_ < text_.size() && text_[pos_] == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    std::string parse_string() {
+        this->expect('"');
+        std::string res;
+        while(pos_ < text_.size() && text_[pos_] != '"') {
+            char c = text_[pos_++];
+            if(c == '\\' && pos_ < text_.size()) {
+                c = text_[pos_++];
+                if(c == 'n') c = '\n';
+                else if(c == 't') c = '\t';
+            }
+            res += c;
+        }
+        this->expect('"');
+        return res;
+    }
+
+    public:
+
+    JsonParser(const std::string& text) : text_(text), pos_(0) {}
+
+    JsonValue parse() {
+        JsonValue res;
+        this->skip_spaces();
+        if(pos_ >= text_.size())
+            this->fail("unexpected end of input");
+        char c = text_[pos_];
+        if(c == '{') {
+            pos_++;
+            res.type = JsonValue::Object;
+            if(this->accept('}')) return res;
+            do {
+                this->skip_spaces();
+                std::string key = this->parse_string();
+                this->expect(':');
+                res.object.push_back(std::make_pair(key, this->parse()));
+            } while(this->accept(','));
+            this->expect('}');
+        }
+        else if(c == '[') {
+            pos_++;
+            res.type = JsonValue::Array;
+            if(this->accept(']')) return res;
+            do {
+                res.array.push_back(this->parse());
+            } while(this->accept(','));
+            this->expect(']');
+        }
+        else if(c == '"') {
+            res.type   = JsonValue::String;
+            res.string = this->parse_string();
+        }
+        else if(text_.compare(pos_, 4, "true") == 0 || text_.compare(pos_, 5, "false") == 0) {
+            res.type   = JsonValue::Bool;
+            res.number = text_[pos_] == 't';
+            pos_ += text_[pos_] == 't' ? 4 : 5;
+        }
+        else if(text_.compare(pos_, 4, "null") == 0) {
+            pos_ += 4;
+        }
+        else {
+            const char* begin = text_.c_str() + pos_;
+            char* end;
+            res.type   = JsonValue::Number;
+            res.number = std::strtod(begin, &end);
+            if(end == begin)
+                this->fail("invalid value");
+            pos_ += end - begin;
+        }
+        return res;
+    }
+};
+
+}; //namespace details
+
+std::vector<Result> read_json(const std::string& path)
+{
+    std::ifstream f(path);
+    if(!f.is_open())
+        throw std::runtime_error("Could not open file for reading : " + path);
+    std::stringstream ss;
+    ss << f.rdbuf();
+    std::string text = ss.str();
+
+    auto root = details::JsonParser(text).parse();
+    auto benchmarks = root.find("benchmarks");
+    if(!benchmarks || benchmarks->type != details::JsonValue::Array)
+        throw std::runtime_error("Not a benchmark result file : " + path);
+
+    std::vector<Result> res;
+    for(auto& b : benchmarks->array) {
+        Result r;
+        r.name   = b.string_or("name", "");
+        r.family = b.string_or("family", "");
+        r.error  = b.string_or("error", "");
+        if(auto params = b.find("params")) {
+            for(auto& p : params->object) {
+                r.params.push_back(std::make_pair(p.first, (int64_t)p.second.number));
+            }
+        }
+        r.iterations      = b.number_or("iterations", 0);
+        r.time.count      = b.number_or("samples", 0);
+        r.time.median     = b.number_or("median", 0.0);
+        r.time.mad        = b.number_or("mad", 0.0);
+        r.time.mean       = b.number_or("mean", 0.0);
+        r.time.robustMean = b.number_or("robust_mean", 0.0);
+        r.time.stddev     = b.number_or("stddev", 0.0);
+        r.time.min        = b.number_or("min", 0.0);
+        r.time.max        = b.number_or("max", 0.0);
+        r.time.outliers   = b.number_or("outliers", 0);
+        r.bytesPerSecond  = b.number_or("bytes_per_second", 0.0);
+        r.itemsPerSecond  = b.number_or("items_per_second", 0.0);
+        if(auto counters = b.find("counters")) {
+            for(auto& c : counters->object) {
+                r.counters[c.first] = c.second.number;
+            }
+        }
+        res.push_back(r);
+    }
+    return res;
+}
+
+// Comparison ////////////////////////////////////////////////////////////
+std::vector<Comparison> compare(const std::vector<Result>& oldResults,
+                                const std::vector<Result>& newResults,
+                                double threshold)
+{
+    std::map<std::string, const Result*> olds;
+    for(auto& r : oldResults) {
+        if(r.error.empty()) olds[r.name] = &r;
+    }
+
+    std::vector<Comparison> res;
+    for(auto& r : newResults) {
+        if(!r.error.empty())
+            continue;
+        Comparison c;
+        c.name    = r.name;
+        c.newTime = r.time.median;
+        auto it = olds.find(r.name);
+        if(it == olds.end()) {
+            c.verdict = Comparison::New;
+            res.push_back(c);
+            continue;
+        }
+        const Result& old = *it->second;
+        olds.erase(it);
+
+        c.oldTime = old.time.median;
+        if(c.oldTime > 0.0)
+            c.change = c.newTime / c.oldTime - 1.0;
+        // Standard errors of the medians (1.2533 sigma / sqrt(n) for normal samples).
+        auto standard_error = [](const SampleStats& stats) {
+            return stats.count > 0 ? 1.2533*stats.mad / std::sqrt(double(stats.count)) : 0.0;
+        };
+        double noise = 3.0*std::hypot(standard_error(old.time), standard_error(r.time));
+        if(std::abs(c.newTime - c.oldTime) > noise && std::abs(c.change) > threshold)
+            c.verdict = c.change > 0.0 ? Comparison::Regressed : Comparison::Improved;
+        res.push_back(c);
+    }
+    for(auto& old : olds) {
+        Comparison c;
+        c.name    = old.first;
+        c.oldTime = old.second->time.median;
+        c.verdict = Comparison::Missing;
+        res.push_back(c);
+    }
+    return res;
+}
+
+std::ostream& print_comparisons(std::ostream& os, const std::vector<Comparison>& comparisons)
+{
+    static const char* verdicts[] = {"", "improved", "REGRESSED", "missing", "new"};
+
+    auto flags     = os.flags();
+    auto precision = os.precision();
+    os << std::left << std::setw(48) << "benchmark" << std::right
+       << std::setw(14) << "old" << std::setw(14) << "new"
+       << std::setw(10) << "change" << "\n";
+    for(auto& c : comparisons) {
+        os << std::left << std::setw(48) << c.name << std::right
+           << std::setw(14) << (c.oldTime > 0.0 ? format_time(c.oldTime) : "-")
+           << std::setw(14) << (c.newTime > 0.0 ? format_time(c.newTime) : "-");
+        if(c.verdict == Comparison::Missing || c.verdict == Comparison::New) {
+            os << std::setw(10) << "-";
+        }
+        else {
+            os << std::fixed << std::setprecision(1) << std::showpos
+               << std::setw(9) << 100.0*c.change << std::noshowpos << "%";
+        }
+        os << "  " << verdicts[c.verdict] << "\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
+
+}; //namespace bench
+}; //namespace rtac
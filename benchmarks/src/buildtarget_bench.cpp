@@ -0,0 +1,111 @@
+#include <vector>
+#include <functional>
+
+#include <rtac_base/types/BuildTarget.h>
+#include <rtac_base/benchmark.h>
+using namespace rtac::types;
+using namespace rtac::bench;
+
+class Target : public BuildTarget
+{
+    public:
+
+    using Ptr = rtac::types::Handle<Target>;
+
+    protected:
+
+    Target() {}
+    void do_build() const {}
+
+    public:
+
+    static Ptr Create() { return Ptr(new Target()); }
+};
+
+// Chain of depth targets, each depending on the previous one.
+std::vector<Target::Ptr> make_deep(unsigned int depth)
+{
+    std::vector<Target::Ptr> targets({Target::Create()});
+    for(unsigned int i = 1; i < depth; i++) {
+        targets.push_back(Target::Create());
+        targets.back()->add_dependency(targets[i - 1]);
+    }
+    return targets;
+}
+
+// Layers of width targets, each depending on all the targets of the previous
+// layer. The number of paths from the last layer to the first one is
+// width^(depth-1) : a recursive walk of such a graph is exponential.
+std::vector<Target::Ptr> make_diamonds(unsigned int depth, unsigned int width)
+{
+    std::vector<Target::Ptr> targets;
+    for(unsigned int w = 0; w < width; w++) {
+        targets.push_back(Target::Create());
+    }
+    for(unsigned int d = 1; d < depth; d++) {
+        for(unsigned int w = 0; w < width; w++) {
+            auto target = Target::Create();
+            for(unsigned int p = 0; p < width; p++) {
+                target->add_dependency(targets[(d - 1)*width + p]);
+            }
+            targets.push_back(target);
+        }
+    }
+    return targets;
+}
+
+using MakeGraph = std::function<std::vector<Target::Ptr>(unsigned int depth)>;
+
+// Adds the benchmarks of the graphs built by make (the root is the last target).
+void add_graph(Suite& suite, const std::string& graph, const MakeGraph& make,
+               const std::vector<int64_t>& depths)
+{
+    suite.add(graph + "/create", [make](State& state) {
+        for(auto _ : state) {
+            auto targets = make(state.param("depth"));
+            state.pause_timing();
+            targets.clear();
+            state.resume_timing();
+        }
+    }).sweep("depth", depths);
+
+    suite.add(graph + "/build", [make](State& state) {
+        for(auto _ : state) {
+            state.pause_timing();
+            auto targets = make(state.param("depth"));
+            state.resume_timing();
+            targets.back()->build();
+            state.pause_timing();
+            targets.clear();
+            state.resume_timing();
+        }
+    }).sweep("depth", depths);
+
+    suite.add(graph + "/needs_build", [make](State& state) {
+        auto targets = make(state.param("depth"));
+        targets.back()->build();
+        for(auto _ : state) {
+            do_not_optimize(targets.back()->needs_build());
+        }
+        if(targets.back()->needs_build())
+            state.skip("clean graph reported as dirty");
+    }).sweep("depth", depths);
+
+    suite.add(graph + "/bump+build", [make](State& state) {
+        auto targets = make(state.param("depth"));
+        targets.back()->build();
+        for(auto _ : state) {
+            targets.front()->bump_version();
+            targets.back()->build();
+        }
+    }).sweep("depth", depths);
+}
+
+int main(int argc, char** argv)
+{
+    Suite suite("buildtarget");
+    add_graph(suite, "deep", make_deep, {10, 100, 1000, 10000});
+    add_graph(suite, "diamonds4", [](unsigned int depth) { return make_diamonds(depth, 4); },
+              {8, 16, 32, 64});
+    return suite.main(argc, argv);
+}
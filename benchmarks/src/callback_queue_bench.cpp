@@ -0,0 +1,65 @@
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include <rtac_base/types/CallbackQueue.h>
+#include <rtac_base/benchmark.h>
+using namespace rtac::types;
+using namespace rtac::bench;
+
+// Latency of CallbackQueue::call (4 trivial callbacks registered) while
+// threads - 1 other threads publish concurrently on the same queue. With
+// writer:1, another thread periodically adds and removes a callback. The
+// items rate is the total call throughput of all the publishers.
+int main(int argc, char** argv)
+{
+    Suite suite("callback_queue");
+
+    suite.add("call", [](State& state) {
+        CallbackQueue<int> queue;
+        std::atomic<long> counter(0);
+        for(int i = 0; i < 4; i++) {
+            queue.add_callback([&](int v) { counter.fetch_add(v, std::memory_order_relaxed); });
+        }
+
+        struct alignas(64) CallCount { std::atomic<uint64_t> value{0}; };
+        std::vector<CallCount> calls(state.param("threads"));
+
+        std::atomic<bool> stop(false);
+        std::vector<std::thread> threads;
+        for(int64_t p = 1; p < state.param("threads"); p++) {
+            threads.emplace_back([&, p]() {
+                while(!stop) {
+                    queue.call(1);
+                    calls[p].value.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        auto other_calls = [&]() {
+            uint64_t total = 0;
+            for(auto& c : calls) total += c.value.load(std::memory_order_relaxed);
+            return total;
+        };
+        if(state.param("writer")) {
+            threads.emplace_back([&]() {
+                while(!stop) {
+                    auto id = queue.add_callback([](int) {});
+                    queue.remove_callback(id);
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            });
+        }
+
+        uint64_t start = other_calls();
+        for(auto _ : state) {
+            queue.call(1);
+        }
+        uint64_t others = other_calls() - start;
+
+        stop = true;
+        for(auto& t : threads) t.join();
+        state.set_items_per_iteration(1.0 + double(others) / state.iterations());
+    }).sweep("threads", {1, 2, 4, 8, 16}).sweep("writer", {0, 1});
+
+    return suite.main(argc, argv);
+}
@@ -0,0 +1,45 @@
+#include <chrono>
+#include <ctime>
+
+#include <rtac_base/time.h>
+#include <rtac_base/profiling.h>
+#include <rtac_base/benchmark.h>
+using namespace rtac::bench;
+
+// Cost of the timestamp sources used by rtac::time, and of a profiling scope.
+int main(int argc, char** argv)
+{
+    Suite suite("clocks");
+
+    suite.add("TickClock::now", [](State& state) {
+        for(auto _ : state) {
+            do_not_optimize(rtac::time::TickClock::now());
+        }
+    });
+    suite.add("steady_clock::now", [](State& state) {
+        for(auto _ : state) {
+            do_not_optimize(std::chrono::steady_clock::now());
+        }
+    });
+    suite.add("clock_gettime(CLOCK_MONOTONIC)", [](State& state) {
+        timespec t;
+        for(auto _ : state) {
+            clock_gettime(CLOCK_MONOTONIC, &t);
+            do_not_optimize(t);
+        }
+    });
+    suite.add("RTAC_PROFILE_SCOPE", [](State& state) {
+        for(auto _ : state) {
+            RTAC_PROFILE_SCOPE("clock_bench/scope");
+            clobber_memory();
+        }
+    });
+    suite.add("FrameCounter::get", [](State& state) {
+        rtac::time::FrameCounter counter(1, state.param("window"));
+        for(auto _ : state) {
+            do_not_optimize(counter.get());
+        }
+    }).sweep("window", {16, 1024});
+
+    return suite.main(argc, argv);
+}
@@ -0,0 +1,236 @@
+#include <vector>
+#include <numeric>
+#include <random>
+#include <cmath>
+
+#include <rtac_base/types/common.h>
+#include <rtac_base/types/Pose.h>
+#include <rtac_base/types/Complex.h>
+#include <rtac_base/types/SharedVector.h>
+#include <rtac_base/types/VectorView.h>
+#include <rtac_base/types/RingBuffer.h>
+#include <rtac_base/types/GridMap.h>
+#include <rtac_base/functors.h>
+#include <rtac_base/interpolation.h>
+#include <rtac_base/geometry.h>
+#include <rtac_base/navigation.h>
+#include <rtac_base/benchmark.h>
+using namespace rtac::bench;
+using namespace rtac::types;
+
+// Baseline numbers for the CPU math of rtac_base (mostly header-only
+// templates, so regressions only show up in code instantiating them).
+
+template <class InterpolatorT>
+void interpolation_bench(State& state)
+{
+    auto x0 = Vector<float>::LinSpaced(state.param("knots"), 0.0f, 1.0f);
+    Vector<float> y0 = x0.array().sin();
+    InterpolatorT interpolator(x0, y0);
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    Vector<float> x(state.param("queries")), output(x.size());
+    for(int i = 0; i < x.size(); i++) x(i) = dist(rng);
+    std::sort(x.data(), x.data() + x.size());
+
+    for(auto _ : state) {
+        interpolator.interpolate(x, output);
+        do_not_optimize(output.data());
+        clobber_memory();
+    }
+    state.set_items_per_iteration(x.size());
+}
+
+std::vector<Posef> random_poses(std::size_t count)
+{
+    std::mt19937 rng(0);
+    std::normal_distribution<float> dist;
+    std::vector<Posef> res(count);
+    for(auto& p : res) {
+        Quaternion<float> q(dist(rng), dist(rng), dist(rng), dist(rng));
+        p = Posef(Vector3<float>(dist(rng), dist(rng), dist(rng)), q.normalized());
+    }
+    return res;
+}
+
+int main(int argc, char** argv)
+{
+    Suite suite("compute");
+
+    const std::vector<int64_t> sizes = range(1024, 1 << 20, 32);
+
+    // Interpolation
+    suite.add("InterpolatorNearest::interpolate",
+              interpolation_bench<rtac::algorithm::InterpolatorNearest<float>>)
+        .sweep("knots", {16, 4096}).sweep("queries", sizes);
+    suite.add("InterpolatorLinear::interpolate",
+              interpolation_bench<rtac::algorithm::InterpolatorLinear<float>>)
+        .sweep("knots", {16, 4096}).sweep("queries", sizes);
+    suite.add("InterpolatorCubicSpline::interpolate",
+              interpolation_bench<rtac::algorithm::InterpolatorCubicSpline<float>>)
+        .sweep("knots", {16, 4096}).sweep("queries", sizes);
+
+    // Poses
+    suite.add("Pose::operator*", [](State& state) {
+        auto poses = random_poses(state.param("poses"));
+        for(auto _ : state) {
+            Posef acc;
+            for(auto& p : poses) acc *= p;
+            do_not_optimize(acc);
+        }
+        state.set_items_per_iteration(poses.size());
+    }).sweep("poses", {1024, 65536});
+
+    suite.add("Pose::inverse", [](State& state) {
+        auto poses = random_poses(state.param("poses"));
+        std::vector<Posef> output(poses.size());
+        for(auto _ : state) {
+            for(std::size_t i = 0; i < poses.size(); i++) output[i] = poses[i].inverse();
+            do_not_optimize(output.data());
+            clobber_memory();
+        }
+        state.set_items_per_iteration(poses.size());
+    }).sweep("poses", {1024, 65536});
+
+    // Geometry
+    suite.add("geometry::orthonormalized", [](State& state) {
+        std::mt19937 rng(0);
+        std::normal_distribution<float> dist(0.0f, 1.0e-3f);
+        std::vector<Matrix3<float>> matrices(state.param("matrices"));
+        for(auto& m : matrices) {
+            m = Matrix3<float>::Identity();
+            for(int i = 0; i < 9; i++) m.data()[i] += dist(rng);
+        }
+        for(auto _ : state) {
+            for(auto& m : matrices) do_not_optimize(rtac::geometry::orthonormalized(m));
+        }
+        state.set_items_per_iteration(matrices.size());
+    }).sweep("matrices", {1024});
+
+    suite.add("navigation::ned_to_enu(Pose)", [](State& state) {
+        auto poses = random_poses(state.param("poses"));
+        std::vector<Posef> output(poses.size());
+        for(auto _ : state) {
+            for(std::size_t i = 0; i < poses.size(); i++) {
+                output[i] = rtac::navigation::ned_to_enu(poses[i]);
+            }
+            do_not_optimize(output.data());
+            clobber_memory();
+        }
+        state.set_items_per_iteration(poses.size());
+    }).sweep("poses", {1024, 65536});
+
+    suite.add("navigation::ned_to_enu(Vector3)", [](State& state) {
+        std::vector<Vector3<float>> input(state.param("vectors"), Vector3<float>(1,2,3));
+        std::vector<Vector3<float>> output(input.size());
+        for(auto _ : state) {
+            for(std::size_t i = 0; i < input.size(); i++) {
+                output[i] = rtac::navigation::ned_to_enu(input[i]);
+            }
+            do_not_optimize(output.data());
+            clobber_memory();
+        }
+        state.set_items_per_iteration(input.size());
+    }).sweep("vectors", sizes);
+
+    // Complex arithmetic : z = z*a + b, and magnitudes.
+    suite.add("Complex multiply-add", [](State& state) {
+        std::vector<Complex<float>> a(state.param("size"), Complex<float>(0.6f, 0.8f));
+        std::vector<Complex<float>> z(a.size(), Complex<float>(1.0f, 0.0f));
+        Complex<float> b(0.1f, -0.1f);
+        for(auto _ : state) {
+            for(std::size_t i = 0; i < z.size(); i++) z[i] = z[i]*a[i] + b;
+            do_not_optimize(z.data());
+            clobber_memory();
+        }
+        state.set_items_per_iteration(z.size());
+        state.set_bytes_per_iteration(2*z.size()*sizeof(Complex<float>));
+    }).sweep("size", sizes);
+
+    suite.add("Complex abs", [](State& state) {
+        std::vector<Complex<float>> z(state.param("size"), Complex<float>(3.0f, 4.0f));
+        std::vector<float> output(z.size());
+        for(auto _ : state) {
+            for(std::size_t i = 0; i < z.size(); i++) output[i] = abs(z[i]);
+            do_not_optimize(output.data());
+            clobber_memory();
+        }
+        state.set_items_per_iteration(z.size());
+    }).sweep("size", sizes);
+
+    // Containers iteration (sum), with std::vector as a reference.
+    suite.add("std::vector iteration", [](State& state) {
+        std::vector<float> v(state.param("size"), 1.0f);
+        for(auto _ : state) {
+            do_not_optimize(std::accumulate(v.begin(), v.end(), 0.0f));
+        }
+        state.set_bytes_per_iteration(v.size()*sizeof(float));
+    }).sweep("size", sizes);
+
+    suite.add("SharedVector iteration", [](State& state) {
+        SharedVector<float> v(state.param("size"));
+        std::fill(v.begin(), v.end(), 1.0f);
+        for(auto _ : state) {
+            do_not_optimize(std::accumulate(v.begin(), v.end(), 0.0f));
+        }
+        state.set_bytes_per_iteration(v.size()*sizeof(float));
+    }).sweep("size", sizes);
+
+    suite.add("VectorView iteration", [](State& state) {
+        std::vector<float> data(state.param("size"), 1.0f);
+        VectorView<const float> v(data.size(), data.data());
+        for(auto _ : state) {
+            float sum = 0.0f;
+            for(std::size_t i = 0; i < v.size(); i++) sum += v[i];
+            do_not_optimize(sum);
+        }
+        state.set_bytes_per_iteration(v.size()*sizeof(float));
+    }).sweep("size", sizes);
+
+    // Ring buffers : push then pop of a batch of handles on a single thread
+    // (the cost of the queue itself, without cross-core traffic).
+    suite.add("SpscRingBuffer push/pop", [](State& state) {
+        SpscRingBuffer<Handle<int>> queue(state.param("batch"));
+        auto item = std::make_shared<int>(0);
+        Handle<int> output;
+        for(auto _ : state) {
+            for(int64_t i = 0; i < state.param(0); i++) queue.try_push(item);
+            while(queue.try_pop(output));
+            do_not_optimize(output);
+        }
+        state.set_items_per_iteration(state.param(0));
+    }).sweep("batch", {16, 1024});
+
+    suite.add("MpmcRingBuffer push/pop", [](State& state) {
+        MpmcRingBuffer<Handle<int>> queue(state.param("batch"));
+        auto item = std::make_shared<int>(0);
+        Handle<int> output;
+        for(auto _ : state) {
+            for(int64_t i = 0; i < state.param(0); i++) queue.try_push(item);
+            while(queue.try_pop(output));
+            do_not_optimize(output);
+        }
+        state.set_items_per_iteration(state.param(0));
+    }).sweep("batch", {16, 1024});
+
+    // GridMap : pixel indexes to metric coordinates.
+    suite.add("GridMap coordinates", [](State& state) {
+        using Affine = rtac::functors::AffineTransform<float, std::size_t, float, float>;
+        GridMap<Affine, Affine> grid(Affine{0.01f, -5.0f}, Affine{0.02f, -2.0f});
+        std::size_t side = state.param("side");
+        std::vector<std::array<float,2>> output(side*side);
+        for(auto _ : state) {
+            for(std::size_t h = 0; h < side; h++) {
+                for(std::size_t w = 0; w < side; w++) {
+                    output[side*h + w] = grid(w, h);
+                }
+            }
+            do_not_optimize(output.data());
+            clobber_memory();
+        }
+        state.set_items_per_iteration(side*side);
+    }).sweep("side", {64, 1024});
+
+    return suite.main(argc, argv);
+}
@@ -0,0 +1,439 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/stat.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#ifdef RTAC_PNG
+#include <png.h>
+#endif
+#ifdef RTAC_JPEG
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+#include <rtac_base/files.h>
+#include <rtac_base/types/PointCloud.h>
+#include <rtac_base/types/Mesh.h>
+#include <rtac_base/external/obj_codec.h>
+#include <rtac_base/external/ImageCodec.h>
+#include <rtac_base/benchmark.h>
+using namespace rtac::bench;
+
+using PointCloud = rtac::types::PointCloud<>;
+using Mesh       = rtac::types::Mesh<>;
+
+// Load / save throughput of the rtac_base file formats on synthetic datasets.
+//
+// Datasets are generated on first use in a temporary directory (in $TMPDIR,
+// /tmp by default) which is removed at exit. Throughput is computed from the
+// file size. For loads, peak_rss_mb is the peak resident memory of the
+// process during the load and rss_growth_mb its increase over the resident
+// memory before the load (Linux only, 0 if unavailable).
+
+/**
+ * Temporary directory removed (with the files created through it) on
+ * destruction.
+ */
+class TempDir
+{
+    protected:
+
+    std::string              path_;
+    std::vector<std::string> files_;
+    std::vector<std::string> directories_;
+
+    public:
+
+    TempDir() {
+        const char* tmp = std::getenv("TMPDIR");
+        std::string pattern = std::string(tmp ? tmp : "/tmp") + "/rtac_io_bench_XXXXXX";
+        std::vector<char> buffer(pattern.begin(), pattern.end());
+        buffer.push_back('\0');
+        if(!mkdtemp(buffer.data()))
+            throw std::runtime_error("Could not create temporary directory " + pattern);
+        path_ = buffer.data();
+    }
+    ~TempDir() {
+        for(auto& f : files_) unlink(f.c_str());
+        for(auto it = directories_.rbegin(); it != directories_.rend(); it++) {
+            rmdir(it->c_str());
+        }
+        rmdir(path_.c_str());
+    }
+
+    std::string file(const std::string& name) {
+        files_.push_back(path_ + "/" + name);
+        return files_.back();
+    }
+    std::string directory(const std::string& name) {
+        std::string path = path_ + "/" + name;
+        mkdir(path.c_str(), 0755);
+        directories_.push_back(path);
+        return path;
+    }
+};
+
+TempDir& temp_dir()
+{
+    static TempDir dir;
+    return dir;
+}
+
+std::size_t file_size(const std::string& path)
+{
+    struct stat s;
+    return stat(path.c_str(), &s) == 0 ? s.st_size : 0;
+}
+
+// Memory statistics ///////////////////////////////////////////////////////
+double status_mb(const std::string& field)
+{
+    std::ifstream f("/proc/self/status");
+    std::string line;
+    while(std::getline(f, line)) {
+        if(line.compare(0, field.size(), field) == 0) {
+            return std::stod(line.substr(field.size() + 1)) / 1024.0; // kB
+        }
+    }
+    return 0.0;
+}
+
+/**
+ * Resets the peak resident memory (VmHWM) to the current resident memory.
+ * Free heap memory is released to the system first so the resident memory
+ * only accounts for live allocations.
+ */
+bool reset_peak_rss()
+{
+    #ifdef __GLIBC__
+    malloc_trim(0);
+    #endif
+    std::ofstream f("/proc/self/clear_refs");
+    return f.is_open() && (f << "5").good();
+}
+
+/**
+ * Measures the memory footprint of a load : resets the peak resident memory
+ * before the load, reads it after.
+ */
+struct RssProbe
+{
+    double baseline;
+
+    RssProbe() {
+        reset_peak_rss();
+        baseline = status_mb("VmRSS:");
+    }
+    void report(State& state) {
+        double peak = status_mb("VmHWM:");
+        state.set_counter("peak_rss_mb",   peak);
+        state.set_counter("rss_growth_mb", std::max(0.0, peak - baseline));
+    }
+};
+
+// Synthetic datasets //////////////////////////////////////////////////////
+PointCloud make_point_cloud(std::size_t size)
+{
+    PointCloud pc(size);
+    for(std::size_t i = 0; i < size; i++) {
+        float t = 0.001f*i;
+        pc[i].x = std::cos(t)*(1.0f + 0.1f*t);
+        pc[i].y = std::sin(t)*(1.0f + 0.1f*t);
+        pc[i].z = 0.01f*t;
+    }
+    return pc;
+}
+
+/**
+ * Regular grid mesh with about faceCount triangles.
+ */
+Mesh::Ptr make_mesh(std::size_t faceCount)
+{
+    std::size_t n = std::max<std::size_t>(2, std::sqrt(0.5*faceCount) + 1);
+    auto mesh = Mesh::Create();
+    mesh->points().resize(n*n);
+    for(std::size_t h = 0; h < n; h++) {
+        for(std::size_t w = 0; w < n; w++) {
+            auto& p = mesh->points()[n*h + w];
+            p.x = w; p.y = h; p.z = std::sin(0.1f*w)*std::cos(0.1f*h);
+        }
+    }
+    for(uint32_t h = 0; h + 1 < n; h++) {
+        for(uint32_t w = 0; w + 1 < n; w++) {
+            uint32_t i = n*h + w;
+            mesh->faces().push_back({i, i + 1, i + (uint32_t)n});
+            mesh->faces().push_back({i + 1, i + 1 + (uint32_t)n, i + (uint32_t)n});
+        }
+    }
+    return mesh;
+}
+
+/**
+ * .obj dataset (own directory, with a .mtl file) made of a grid mesh with
+ * uvs and normals, whose faces are split in groupCount material groups.
+ */
+std::string make_obj_dataset(const std::string& name, std::size_t faceCount,
+                             unsigned int groupCount)
+{
+    auto mesh = make_mesh(faceCount);
+    std::string dir = temp_dir().directory(name);
+    temp_dir().file(name + "/mesh.obj");
+    temp_dir().file(name + "/mesh.mtl");
+
+    std::ofstream mtl(dir + "/mesh.mtl");
+    for(unsigned int g = 0; g < groupCount; g++) {
+        mtl << "newmtl material_" << g << "\nKd 0.8 0.8 0.8\nillum 1\n\n";
+    }
+
+    std::ofstream obj(dir + "/mesh.obj");
+    obj << "mtllib mesh.mtl\n";
+    for(auto& p : mesh->points()) {
+        obj << "v " << p.x << " " << p.y << " " << p.z << "\n";
+    }
+    for(auto& p : mesh->points()) {
+        obj << "vt " << 0.01f*p.x << " " << 0.01f*p.y << "\n";
+    }
+    obj << "vn 0 0 1\n";
+    std::size_t groupSize = (mesh->faces().size() + groupCount - 1) / groupCount;
+    for(std::size_t i = 0; i < mesh->faces().size(); i++) {
+        if(i % groupSize == 0)
+            obj << "usemtl material_" << i / groupSize << "\n";
+        auto& f = mesh->faces()[i];
+        obj << "f " << f.x + 1 << "/" << f.x + 1 << "/1 "
+                    << f.y + 1 << "/" << f.y + 1 << "/1 "
+                    << f.z + 1 << "/" << f.z + 1 << "/1\n";
+    }
+    return dir;
+}
+
+std::vector<uint8_t> make_image(std::size_t side, unsigned int channels)
+{
+    std::vector<uint8_t> data(side*side*channels);
+    for(std::size_t h = 0; h < side; h++) {
+        for(std::size_t w = 0; w < side; w++) {
+            for(unsigned int c = 0; c < channels; c++) {
+                data[channels*(side*h + w) + c] = (w*(c + 1) + h) & 0xff;
+            }
+        }
+    }
+    return data;
+}
+
+#ifdef RTAC_PNG
+void write_png(const std::string& path, std::size_t side, const std::vector<uint8_t>& rgb)
+{
+    png_image image;
+    std::memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+    image.width   = side;
+    image.height  = side;
+    image.format  = PNG_FORMAT_RGB;
+    if(!png_image_write_to_file(&image, path.c_str(), 0, rgb.data(), 0, nullptr))
+        throw std::runtime_error("Could not write png file " + path);
+}
+#endif
+
+#ifdef RTAC_JPEG
+void write_jpeg(const std::string& path, std::size_t side, const std::vector<uint8_t>& rgb)
+{
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if(!f)
+        throw std::runtime_error("Could not open file for writing : " + path);
+    jpeg_compress_struct info;
+    jpeg_error_mgr       error;
+    info.err = jpeg_std_error(&error);
+    jpeg_create_compress(&info);
+    jpeg_stdio_dest(&info, f);
+    info.image_width      = side;
+    info.image_height     = side;
+    info.input_components = 3;
+    info.in_color_space   = JCS_RGB;
+    jpeg_set_defaults(&info);
+    jpeg_set_quality(&info, 90, TRUE);
+    jpeg_start_compress(&info, TRUE);
+    while(info.next_scanline < info.image_height) {
+        JSAMPROW row = const_cast<uint8_t*>(rgb.data() + 3*side*info.next_scanline);
+        jpeg_write_scanlines(&info, &row, 1);
+    }
+    jpeg_finish_compress(&info);
+    jpeg_destroy_compress(&info);
+    std::fclose(f);
+}
+#endif
+
+/**
+ * Returns the path of a dataset, generating it on first use.
+ */
+std::string dataset(const std::string& kind, int64_t size)
+{
+    static std::map<std::string, std::string> datasets;
+    std::string name = kind + "_" + std::to_string(size);
+    auto it = datasets.find(name);
+    if(it != datasets.end())
+        return it->second;
+
+    std::string path;
+    if(kind == "pointcloud") {
+        path = temp_dir().file(name + ".ply");
+        make_point_cloud(size).export_ply(path);
+    }
+    else if(kind == "mesh") {
+        path = temp_dir().file(name + ".ply");
+        make_mesh(size)->export_ply(path);
+    }
+    else if(kind == "ppm") {
+        path = temp_dir().file(name + ".ppm");
+        rtac::files::write_ppm(path, size, size, (const char*)make_image(size, 3).data());
+    }
+    #ifdef RTAC_PNG
+    else if(kind == "png") {
+        path = temp_dir().file(name + ".png");
+        write_png(path, size, make_image(size, 3));
+    }
+    #endif
+    #ifdef RTAC_JPEG
+    else if(kind == "jpg") {
+        path = temp_dir().file(name + ".jpg");
+        write_jpeg(path, size, make_image(size, 3));
+    }
+    #endif
+    else {
+        throw std::runtime_error("Unknown dataset kind : " + kind);
+    }
+    datasets[name] = path;
+    return path;
+}
+
+int main(int argc, char** argv)
+{
+    Suite suite("io");
+
+    // .ply point clouds
+    suite.add("PointCloud::export_ply", [](State& state) {
+        auto pc   = make_point_cloud(state.param("points"));
+        auto path = temp_dir().file("pointcloud_out.ply");
+        bool ascii = state.param("ascii");
+        for(auto _ : state) {
+            pc.export_ply(path, ascii);
+        }
+        state.set_bytes_per_iteration(file_size(path));
+        state.set_items_per_iteration(pc.size());
+    }).sweep("points", {10000, 1000000}).sweep("ascii", {0, 1});
+
+    suite.add("PointCloud::from_ply", [](State& state) {
+        auto path = dataset("pointcloud", state.param("points"));
+        RssProbe rss;
+        for(auto _ : state) {
+            do_not_optimize(PointCloud::from_ply(path));
+        }
+        rss.report(state);
+        state.set_bytes_per_iteration(file_size(path));
+        state.set_items_per_iteration(state.param("points"));
+    }).sweep("points", {10000, 1000000});
+
+    // .ply meshes
+    suite.add("Mesh::export_ply", [](State& state) {
+        auto mesh = make_mesh(state.param("faces"));
+        auto path = temp_dir().file("mesh_out.ply");
+        for(auto _ : state) {
+            mesh->export_ply(path);
+        }
+        state.set_bytes_per_iteration(file_size(path));
+        state.set_items_per_iteration(mesh->faces().size());
+    }).sweep("faces", {10000, 1000000});
+
+    suite.add("Mesh::from_ply", [](State& state) {
+        auto path = dataset("mesh", state.param("faces"));
+        RssProbe rss;
+        for(auto _ : state) {
+            do_not_optimize(Mesh::from_ply(path));
+        }
+        rss.report(state);
+        state.set_bytes_per_iteration(file_size(path));
+        state.set_items_per_iteration(state.param("faces"));
+    }).sweep("faces", {10000, 1000000});
+
+    // .obj datasets with material groups
+    suite.add("ObjLoader::load_geometry", [](State& state) {
+        std::string name = "obj_" + std::to_string(state.param("faces"))
+                         + "_" + std::to_string(state.param("groups"));
+        static std::map<std::string, std::string> dirs;
+        if(dirs.find(name) == dirs.end())
+            dirs[name] = make_obj_dataset(name, state.param("faces"), state.param("groups"));
+        RssProbe rss;
+        for(auto _ : state) {
+            state.pause_timing();
+            rtac::external::ObjLoader loader(dirs[name]);
+            state.resume_timing();
+            loader.load_geometry();
+            do_not_optimize(loader.faces());
+        }
+        rss.report(state);
+        state.set_bytes_per_iteration(file_size(dirs[name] + "/mesh.obj"));
+        state.set_items_per_iteration(state.param("faces"));
+    }).sweep("faces", {10000, 200000}).sweep("groups", {1, 16});
+
+    // PGM / PPM images
+    suite.add("files::write_pgm", [](State& state) {
+        std::size_t side = state.param("side");
+        auto image = make_image(side, 1);
+        auto path  = temp_dir().file("image_out.pgm");
+        for(auto _ : state) {
+            rtac::files::write_pgm(path, side, side, (const char*)image.data());
+        }
+        state.set_bytes_per_iteration(file_size(path));
+    }).sweep("side", {256, 4096});
+
+    suite.add("files::read_ppm", [](State& state) {
+        auto path = dataset("ppm", state.param("side"));
+        std::size_t width, height;
+        std::vector<uint8_t> data;
+        RssProbe rss;
+        for(auto _ : state) {
+            rtac::files::read_ppm(path, width, height, data);
+            do_not_optimize(data.data());
+        }
+        rss.report(state);
+        state.set_bytes_per_iteration(file_size(path));
+    }).sweep("side", {256, 4096});
+
+    // Compressed images through ImageCodec
+    for(std::string kind : {"png", "jpg"}) {
+        suite.add("ImageCodec::read_image(" + kind + ")", [kind](State& state) {
+            #ifndef RTAC_PNG
+            if(kind == "png") {
+                state.skip("rtac_base built without png support");
+                return;
+            }
+            #endif
+            #ifndef RTAC_JPEG
+            if(kind == "jpg") {
+                state.skip("rtac_base built without jpeg support");
+                return;
+            }
+            #endif
+            auto path = dataset(kind, state.param("side"));
+            rtac::external::ImageCodec codec;
+            RssProbe rss;
+            for(auto _ : state) {
+                do_not_optimize(codec.read_image(path));
+            }
+            rss.report(state);
+            state.set_bytes_per_iteration(file_size(path));
+            state.set_items_per_iteration(state.param("side")*state.param("side"));
+        }).sweep("side", {256, 4096});
+    }
+
+    return suite.main(argc, argv);
+}
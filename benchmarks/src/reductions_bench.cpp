@@ -0,0 +1,91 @@
+#include <vector>
+#include <cstring>
+
+#include <rtac_base/reductions.h>
+#include <rtac_base/benchmark.h>
+using namespace rtac::algorithm;
+using namespace rtac::operators;
+using namespace rtac::bench;
+
+// Reductions are memory bound for large inputs : the memcpy entry gives the
+// reference bandwidth of the machine.
+
+// Input data shared by all benchmarks (not reallocated for each sample).
+const std::vector<float>& input(std::size_t size)
+{
+    static std::vector<float> data;
+    if(data.size() != size) {
+        data.resize(size);
+        for(std::size_t i = 0; i < size; i++) data[i] = (i % 1000) * 1.0e-3f;
+    }
+    return data;
+}
+
+template <class F>
+void reduction_bench(State& state, F&& f)
+{
+    const auto& data    = input(state.param("size"));
+    unsigned int threads = state.param("threads");
+    for(auto _ : state) {
+        do_not_optimize(f(data, threads));
+    }
+    state.set_bytes_per_iteration(data.size()*sizeof(float));
+}
+
+int main(int argc, char** argv)
+{
+    Suite suite("reductions");
+    auto sizes = range(1 << 16, 1 << 24, 16);
+
+    suite.add("memcpy", [](State& state) {
+        const auto& data = input(state.param("size"));
+        std::vector<float> copy(data.size());
+        for(auto _ : state) {
+            std::memcpy(copy.data(), data.data(), data.size()*sizeof(float));
+            clobber_memory();
+        }
+        // read + write
+        state.set_bytes_per_iteration(2*data.size()*sizeof(float));
+    }).sweep("size", sizes);
+
+    suite.add("reduce<Direct>", [](State& state) {
+        reduction_bench(state, [](const std::vector<float>& data, unsigned int threads) {
+            return reduce(data.data(), data.size(), Accumulation::Direct, threads);
+        });
+    }).sweep("size", sizes).sweep("threads", thread_range());
+    suite.add("reduce<Pairwise>", [](State& state) {
+        reduction_bench(state, [](const std::vector<float>& data, unsigned int threads) {
+            return reduce(data.data(), data.size(), Accumulation::Pairwise, threads);
+        });
+    }).sweep("size", sizes).sweep("threads", thread_range());
+    suite.add("reduce<Kahan>", [](State& state) {
+        reduction_bench(state, [](const std::vector<float>& data, unsigned int threads) {
+            return reduce(data.data(), data.size(), Accumulation::Kahan, threads);
+        });
+    }).sweep("size", sizes).sweep("threads", thread_range());
+    suite.add("reduce<Maximum>", [](State& state) {
+        reduction_bench(state, [](const std::vector<float>& data, unsigned int threads) {
+            return reduce<float,Maximum>(data.data(), data.size(), Accumulation::Direct, threads);
+        });
+    }).sweep("size", sizes).sweep("threads", thread_range());
+    suite.add("fused_reduce<Min,Max,Add>", [](State& state) {
+        reduction_bench(state, [](const std::vector<float>& data, unsigned int threads) {
+            return fused_reduce<float,Minimum,Maximum,Addition>(
+                data.data(), data.size(), Accumulation::Direct, threads)[2];
+        });
+    }).sweep("size", sizes).sweep("threads", thread_range());
+
+    suite.add("reduce_lines(1024 wide)", [](State& state) {
+        const auto& data     = input(state.param("size"));
+        unsigned int threads = state.param("threads");
+        std::vector<float> output(data.size() / 1024); // one result per line
+        for(auto _ : state) {
+            reduce_lines(data.data(), output.data(), 1024, data.size() / 1024, 0, 1,
+                         Accumulation::Direct, threads);
+            clobber_memory();
+        }
+        state.set_bytes_per_iteration(data.size()*sizeof(float));
+    }).sweep("size", sizes).sweep("threads", thread_range());
+
+    return suite.main(argc, argv);
+}
@@ -0,0 +1,35 @@
+#include <iostream>
+#include <string>
+using namespace std;
+
+#include <rtac_base/benchmark.h>
+using namespace rtac::bench;
+
+// Compares two benchmark result files written with --json. Returns 1 if a
+// benchmark regressed (median time increased beyond threshold and noise).
+int main(int argc, char** argv)
+{
+    if(argc < 3) {
+        cerr << "Usage : " << argv[0] << " old.json new.json [threshold (default 0.05)]" << endl;
+        return 2;
+    }
+    double threshold = 0.05;
+    if(argc > 3) threshold = std::stod(argv[3]);
+
+    std::vector<Comparison> comparisons;
+    try {
+        comparisons = compare(read_json(argv[1]), read_json(argv[2]), threshold);
+    }
+    catch(const std::exception& e) {
+        cerr << e.what() << endl;
+        return 2;
+    }
+    print_comparisons(cout, comparisons);
+
+    int regressions = 0;
+    for(auto& c : comparisons) {
+        if(c.verdict == Comparison::Regressed) regressions++;
+    }
+    cout << regressions << " regression(s) (threshold " << 100.0*threshold << "%)" << endl;
+    return regressions > 0 ? 1 : 0;
+}
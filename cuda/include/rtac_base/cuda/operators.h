@@ -2,32 +2,17 @@
 #define _DEF_RTAC_BASE_CUDA_OPERATORS_H_
 
 #include <rtac_base/cuda/utils.h>
+#include <rtac_base/operators.h>
 
 namespace rtac { namespace cuda {
 
-template <typename T>
-struct Addition {
-    static constexpr T Neutral = 0;
-    RTAC_HOSTDEVICE static void apply(T& inout, const T& in)   { inout += in; }
-};
-
-template <typename T>
-struct Substraction {
-    static constexpr T Neutral = 0;
-    RTAC_HOSTDEVICE static void apply(T& inout, const T& in)   { inout -= in; }
-};
-
-template <typename T>
-struct Multiplication {
-    static constexpr T Neutral = 1;
-    RTAC_HOSTDEVICE static void apply(T& inout, const T& in)   { inout *= in; }
-};
-
-template <typename T>
-struct Division {
-    static constexpr T Neutral = 1;
-    RTAC_HOSTDEVICE static void apply(T& inout, const T& in)   { inout /= in; }
-};
+// Moved to rtac_base/operators.h (kept here for compatibility).
+using rtac::operators::Addition;
+using rtac::operators::Substraction;
+using rtac::operators::Multiplication;
+using rtac::operators::Division;
+using rtac::operators::Minimum;
+using rtac::operators::Maximum;
 
 }; //namespace cuda
 }; //namespace rtac
@@ -0,0 +1,287 @@
+#ifndef _DEF_RTAC_BASE_ALGORITHM_H_
+#define _DEF_RTAC_BASE_ALGORITHM_H_
+
+#include <vector>
+#include <any>
+#include <thread>
+#include <algorithm>
+
+#include <rtac_base/types/VectorView.h>
+#include <rtac_base/types/TaskPool.h>
+
+namespace rtac { namespace algorithm {
+
+namespace details {
+
+/**
+ * Splits the range [0,size[ in threadCount contiguous chunks and calls
+ * f(chunkIndex, begin, end) on each chunk. The chunks are run on the global
+ * TaskPool (the calling thread takes part), so nested calls do not
+ * oversubscribe the cpus.
+ */
+template <class F>
+inline void parallel_chunks(unsigned int threadCount, std::size_t size, F&& f)
+{
+    if(threadCount <= 1) {
+        f(0, 0, size);
+        return;
+    }
+    types::TaskPool::global().parallel_for(0, threadCount,
+        [&](std::size_t first, std::size_t last) {
+            for(auto t = first; t < last; t++) {
+                f(t, (size*t) / threadCount, (size*(t + 1)) / threadCount);
+            }
+        }, 1);
+}
+
+}; //namespace details
+
+/**
+ * Host side counterpart of rtac::cuda::Binning.
+ *
+ * The binning works by generating a key value for each data element with a
+ * user defined criterion. This key is the bin index. The input data is then
+ * reordered so elements of each bins are packed together in the input array,
+ * and the bins are sent back to the user as a list of VectorViews pointing
+ * into the reordered array. If the returned key is negative or greater than
+ * the bin count, the datum is discarded in the bin output (data with negative
+ * keys are placed at the beginning of the array, data with keys greater than
+ * the bin count at the end, like the sort performed in the CUDA version).
+ *
+ * The reordering is a two-pass parallel counting sort (per-thread histograms,
+ * prefix sum, scatter), which is O(N) instead of the O(N.log(N)) sort used on
+ * the GPU. The temporary buffers are kept between calls.
+ *
+ * In stable mode (the default), elements are scattered into a scratch buffer
+ * and the relative order of the elements of each bin is preserved. In
+ * unstable mode, the elements are permuted in place (no copy of the input
+ * data is made, which is useful for large elements) and the order within
+ * each bin is unspecified.
+ */
+class Binning
+{
+    public:
+
+    // Minimum number of elements handled by each thread.
+    static constexpr std::size_t MinChunkSize = 16384;
+
+    protected:
+
+    unsigned int threadCount_;
+    bool         stable_;
+
+    // these are temp data.
+    mutable std::vector<int>         keys_;
+    mutable std::vector<std::size_t> bucketStarts_;
+    mutable std::vector<std::size_t> offsets_;
+    mutable std::any                 scratch_;
+
+    static std::size_t bucket_index(int key, std::size_t bucketCount);
+    unsigned int thread_count(std::size_t size) const;
+    std::size_t  compute_offsets(std::size_t size, std::size_t bucketCount) const;
+
+    template <typename T>
+    std::vector<T>& scratch(std::size_t size) const;
+
+    public:
+
+    Binning(bool stable = true, unsigned int threadCount = 0);
+
+    void set_stable(bool stable)                 { stable_ = stable;           }
+    void set_thread_count(unsigned int count)    { threadCount_ = count;       }
+    bool is_stable()                       const { return stable_;             }
+
+    template <typename T, class Criterion>
+    void compute_keys(types::VectorView<const T> data, std::vector<int>& keys,
+                      const Criterion& criterion) const;
+
+    template <typename T, class Criterion>
+    void operator()(types::VectorView<T> data,
+                    std::size_t binCount,
+                    const Criterion& criterion,
+                    std::vector<types::VectorView<T>>& bins,
+                    int binOverlap = 0) const;
+
+    template <typename T, class Criterion>
+    void operator()(std::vector<T>& data,
+                    std::size_t binCount,
+                    const Criterion& criterion,
+                    std::vector<types::VectorView<T>>& bins,
+                    int binOverlap = 0) const
+    {
+        (*this)(types::make_view(data), binCount, criterion, bins, binOverlap);
+    }
+};
+
+/**
+ * Useful helper function for binning.
+ *
+ * Recreate temp data at each call. For better performances, use the Binning
+ * object and reuse it instead.
+ */
+template <typename T, class Criterion>
+inline std::vector<types::VectorView<T>> binning(std::vector<T>& data,
+                                                 std::size_t binCount,
+                                                 Criterion criterion,
+                                                 int binOverlap = 0)
+{
+    std::vector<types::VectorView<T>> bins;
+    Binning().operator()(data, binCount, criterion, bins, binOverlap);
+    return bins;
+}
+
+inline Binning::Binning(bool stable, unsigned int threadCount) :
+    threadCount_(threadCount),
+    stable_(stable)
+{}
+
+/**
+ * Bucket 0 holds negative keys, bucket bucketCount-1 the keys greater than the
+ * bin count. Bin i is stored in bucket i+1.
+ */
+inline std::size_t Binning::bucket_index(int key, std::size_t bucketCount)
+{
+    if(key < 0)
+        return 0;
+    return std::min<std::size_t>((std::size_t)key + 1, bucketCount - 1);
+}
+
+inline unsigned int Binning::thread_count(std::size_t size) const
+{
+    unsigned int count = threadCount_;
+    if(count == 0)
+        count = std::max(1u, std::thread::hardware_concurrency());
+    return std::max<std::size_t>(1, std::min<std::size_t>(count, size / MinChunkSize));
+}
+
+template <typename T>
+std::vector<T>& Binning::scratch(std::size_t size) const
+{
+    auto buffer = std::any_cast<std::vector<T>>(&scratch_);
+    if(!buffer) {
+        scratch_ = std::vector<T>();
+        buffer = std::any_cast<std::vector<T>>(&scratch_);
+    }
+    buffer->resize(size);
+    return *buffer;
+}
+
+template <typename T, class Criterion>
+void Binning::compute_keys(types::VectorView<const T> data,
+                           std::vector<int>& keys,
+                           const Criterion& criterion) const
+{
+    keys.resize(data.size());
+    details::parallel_chunks(this->thread_count(data.size()), data.size(),
+        [&](unsigned int, std::size_t begin, std::size_t end) {
+            for(auto i = begin; i < end; i++) {
+                keys[i] = criterion(data[i]);
+            }
+        });
+}
+
+/**
+ * Computes the destination offsets of the elements from keys_ (first pass of
+ * the counting sort). On output, offsets_[bucketCount*t + b] holds the
+ * position in the output array of the first element of bucket b handled by
+ * thread t, and bucketStarts_[b] holds the start of bucket b.
+ *
+ * @return the number of threads used.
+ */
+inline std::size_t Binning::compute_offsets(std::size_t size, std::size_t bucketCount) const
+{
+    unsigned int threadCount = this->thread_count(size);
+    offsets_.assign(bucketCount*threadCount, 0);
+    details::parallel_chunks(threadCount, size,
+        [&](unsigned int t, std::size_t begin, std::size_t end) {
+            auto histogram = offsets_.data() + bucketCount*t;
+            for(auto i = begin; i < end; i++) {
+                histogram[bucket_index(keys_[i], bucketCount)]++;
+            }
+        });
+
+    // Exclusive prefix sum, bucket-major then thread-major, so that threads
+    // write in contiguous and ordered sub-ranges of each bucket.
+    bucketStarts_.resize(bucketCount + 1);
+    std::size_t offset = 0;
+    for(std::size_t b = 0; b < bucketCount; b++) {
+        bucketStarts_[b] = offset;
+        for(unsigned int t = 0; t < threadCount; t++) {
+            auto count = offsets_[bucketCount*t + b];
+            offsets_[bucketCount*t + b] = offset;
+            offset += count;
+        }
+    }
+    bucketStarts_[bucketCount] = offset;
+
+    return threadCount;
+}
+
+template <typename T, class Criterion>
+void Binning::operator()(types::VectorView<T> data,
+                         std::size_t binCount,
+                         const Criterion& criterion,
+                         std::vector<types::VectorView<T>>& bins,
+                         int binOverlap) const
+{
+    // Generating key for each data element and sorting data according to this
+    // key.
+    this->compute_keys(types::VectorView<const T>(data.size(), data.data()),
+                       keys_, criterion);
+
+    std::size_t bucketCount = binCount + 2;
+    auto threadCount = this->compute_offsets(data.size(), bucketCount);
+
+    if(stable_) {
+        auto& sorted = this->scratch<T>(data.size());
+        details::parallel_chunks(threadCount, data.size(),
+            [&](unsigned int t, std::size_t begin, std::size_t end) {
+                auto offsets = offsets_.data() + bucketCount*t;
+                for(auto i = begin; i < end; i++) {
+                    sorted[offsets[bucket_index(keys_[i], bucketCount)]++] = std::move(data[i]);
+                }
+            });
+        details::parallel_chunks(threadCount, data.size(),
+            [&](unsigned int, std::size_t begin, std::size_t end) {
+                std::move(sorted.begin() + begin, sorted.begin() + end,
+                          data.begin() + begin);
+            });
+    }
+    else {
+        // In place permutation (American flag sort). Each element is swapped
+        // directly to the next free slot of its bucket.
+        offsets_.assign(bucketStarts_.begin(), bucketStarts_.end() - 1);
+        for(std::size_t b = 0; b < bucketCount; b++) {
+            while(offsets_[b] < bucketStarts_[b + 1]) {
+                auto i = offsets_[b];
+                auto target = bucket_index(keys_[i], bucketCount);
+                if(target == b) {
+                    offsets_[b]++;
+                    continue;
+                }
+                auto j = offsets_[target]++;
+                std::swap(data[i], data[j]);
+                std::swap(keys_[i], keys_[j]);
+            }
+        }
+    }
+
+    // Generating the bins (overlaps <= 0 are ignored, as in cuda::Binning).
+    int overlap = std::max(0, binOverlap);
+    bins.resize(binCount);
+    for(std::size_t i = 0; i < binCount; i++) {
+        long first = std::max<long>(0, (long)i - overlap);
+        long last  = std::min<long>(binCount - 1, (long)i + overlap);
+        std::size_t start = bucketStarts_[first + 1];
+        std::size_t end   = bucketStarts_[last  + 2];
+        if(end > start)
+            bins[i] = types::VectorView<T>(end - start, data.data() + start);
+        else
+            bins[i] = types::VectorView<T>();
+    }
+}
+
+}; //namespace algorithm
+}; //namespace rtac
+
+#endif //_DEF_RTAC_BASE_ALGORITHM_H_
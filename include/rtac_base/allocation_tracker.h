@@ -0,0 +1,100 @@
+#ifndef _DEF_RTAC_BASE_ALLOCATION_TRACKER_H_
+#define _DEF_RTAC_BASE_ALLOCATION_TRACKER_H_
+
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+
+namespace rtac { namespace memory {
+
+// Heap allocation tracking.
+//
+// Counting is done by replacements of the global operator new / delete which
+// are NOT part of rtac_base : an executable opts in by linking the
+// rtac_base_allocation_hooks CMake target. Without it, all counters stay at
+// zero and hooks_installed() returns false.
+//
+// The main use is to check that a steady-state loop does not allocate :
+//
+//     for(;;) {
+//         rtac::memory::NoAllocationScope scope("frame loop");
+//         process_frame();
+//     } // reports the allocations made by process_frame on stderr
+//
+// Allocations are attributed to the calling thread. Allocations made with
+// malloc directly (or by C libraries) are not seen.
+
+struct AllocationCounters
+{
+    uint64_t allocations    = 0;
+    uint64_t deallocations  = 0;
+    uint64_t allocatedBytes = 0;
+    uint64_t freedBytes     = 0;
+
+    AllocationCounters operator-(const AllocationCounters& other) const;
+    std::ostream& print(std::ostream& os) const;
+};
+
+namespace details {
+
+// Called by the hooks. Must not allocate.
+void on_allocation(std::size_t size) noexcept;
+void on_deallocation(std::size_t size) noexcept;
+void set_hooks_installed() noexcept;
+
+}; //namespace details
+
+class AllocationTracker
+{
+    public:
+
+    static bool hooks_installed();
+
+    // Counters of the calling thread since its start.
+    static AllocationCounters thread_counters();
+    // Counters of all threads since the program start.
+    static AllocationCounters global_counters();
+};
+
+enum class AllocationPolicy {
+    Count,  // only counts, see NoAllocationScope::violations()
+    Report, // counts and prints a summary on stderr when the scope ends
+    Abort,  // prints a message and aborts on the first allocation
+};
+
+/**
+ * Region of code of the calling thread which is not supposed to allocate.
+ * Scopes can be nested, an allocation is counted as a violation in all
+ * enclosing scopes (the strictest policy applies).
+ */
+class NoAllocationScope
+{
+    protected:
+
+    const char*        name_;
+    AllocationPolicy   policy_;
+    NoAllocationScope* parent_;
+    uint64_t           violations_;
+    uint64_t           bytes_;
+
+    friend void details::on_allocation(std::size_t) noexcept;
+
+    public:
+
+    NoAllocationScope(const char* name, AllocationPolicy policy = AllocationPolicy::Report);
+    ~NoAllocationScope();
+
+    NoAllocationScope(const NoAllocationScope&) = delete;
+    NoAllocationScope& operator=(const NoAllocationScope&) = delete;
+
+    const char* name()       const { return name_;       }
+    uint64_t    violations() const { return violations_; }
+    uint64_t    bytes()      const { return bytes_;      }
+};
+
+}; //namespace memory
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::memory::AllocationCounters& counters);
+
+#endif //_DEF_RTAC_BASE_ALLOCATION_TRACKER_H_
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <memory>
 #include <vector>
+#include <array>
 #include <set>
 #include <map>
 #include <unordered_map>
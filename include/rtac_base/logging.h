@@ -0,0 +1,349 @@
+#ifndef _DEF_RTAC_BASE_LOGGING_H_
+#define _DEF_RTAC_BASE_LOGGING_H_
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <cstdint>
+
+namespace rtac { namespace logging {
+
+// Leveled asynchronous logging.
+//
+// Messages are formatted by the calling thread directly into a fixed-size
+// slot of a ring buffer owned by this thread (no lock, no allocation), and
+// are written to the sink (stderr by default) by a background thread, ordered
+// by timestamp :
+//
+//     RTAC_LOG_WARNING("Unhandled token : '" << token << "'");
+//
+// Filtering :
+// - at compile time, the RTAC_LOG_* macros below RTAC_LOG_MIN_LEVEL expand
+//   to nothing (define it to one of the RTAC_LOG_LEVEL_* values, it only
+//   affects the code compiled with this definition).
+// - at runtime with Logger::set_level (Info by default, or the value of the
+//   RTAC_LOG_LEVEL environment variable : trace, debug, info, warning, error
+//   or off).
+// - each call site is rate limited (20 messages per second by default, see
+//   Logger::set_rate_limit). The number of suppressed messages is reported
+//   with the next message of the call site which gets through.
+//
+// When the buffer of a thread is full, messages are dropped and a warning
+// with the dropped count is emitted at the next flush. Error messages wake
+// the background thread immediately. Logger::flush() writes all pending
+// messages before returning.
+
+enum class LogLevel : int {
+    Trace   = 0,
+    Debug   = 1,
+    Info    = 2,
+    Warning = 3,
+    Error   = 4,
+    Off     = 5,
+};
+
+const char* to_string(LogLevel level);
+/**
+ * Parses a level name (case insensitive). Throws std::runtime_error on
+ * unknown names.
+ */
+LogLevel log_level_from_string(const std::string& name);
+
+/**
+ * Message as passed to the sinks. The message text and the file name are only
+ * valid during the sink call.
+ */
+struct LogRecord
+{
+    LogLevel         level;
+    uint64_t         timestamp;   // nanoseconds since epoch (system_clock)
+    unsigned int     threadIndex;
+    const char*      file;
+    unsigned int     line;
+    uint64_t         suppressed;  // messages of this call site dropped by the
+                                  // rate limiter since the previous one
+    std::string_view message;
+};
+
+namespace details {
+
+/**
+ * Single producer (the owning thread), single consumer (the flushing side,
+ * serialized by the Logger) ring buffer of fixed-size messages.
+ */
+class LogBuffer
+{
+    public:
+
+    static constexpr std::size_t MaxMessageSize = 232;
+
+    struct Slot {
+        LogLevel     level;
+        unsigned int line;
+        uint64_t     timestamp;
+        const char*  file;
+        uint64_t     suppressed;
+        std::size_t  length;
+        char         text[MaxMessageSize];
+    };
+
+    protected:
+
+    std::unique_ptr<Slot[]> slots_;
+    uint64_t                mask_;
+    unsigned int            threadIndex_;
+    std::atomic<bool>       inUse_;
+    alignas(64) std::atomic<uint64_t> head_;    // written by the producer
+    std::atomic<uint64_t>             dropped_; // written by the producer
+    alignas(64) std::atomic<uint64_t> tail_;    // written by the consumer
+    uint64_t                          reportedDrops_;
+
+    public:
+
+    LogBuffer(std::size_t capacity, unsigned int threadIndex);
+
+    std::size_t  capacity()     const { return mask_ + 1; }
+    unsigned int thread_index() const { return threadIndex_; }
+
+    // Ownership by a thread. A buffer released by an exiting thread is
+    // reused by the next registering thread.
+    bool acquire() {
+        bool expected = false;
+        return inUse_.compare_exchange_strong(expected, true, std::memory_order_acquire);
+    }
+    void release() { inUse_.store(false, std::memory_order_release); }
+
+    // Producer side
+    Slot* reserve() {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        if(head - tail_.load(std::memory_order_acquire) >= this->capacity()) {
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_relaxed);
+            return nullptr;
+        }
+        return &slots_[head & mask_];
+    }
+    // Returns true if the buffer is more than half full.
+    bool commit() {
+        uint64_t head = head_.load(std::memory_order_relaxed) + 1;
+        head_.store(head, std::memory_order_release);
+        return head - tail_.load(std::memory_order_relaxed) > this->capacity() / 2;
+    }
+
+    // Consumer side
+    uint64_t    tail()      const { return tail_.load(std::memory_order_relaxed); }
+    uint64_t    head()      const { return head_.load(std::memory_order_acquire); }
+    const Slot& slot(uint64_t index) const { return slots_[index & mask_]; }
+    void        pop_until(uint64_t index) { tail_.store(index, std::memory_order_release); }
+    uint64_t    dropped()   const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t    new_drops() {
+        uint64_t dropped = this->dropped();
+        uint64_t res     = dropped - reportedDrops_;
+        reportedDrops_   = dropped;
+        return res;
+    }
+};
+
+/**
+ * Per call site rate limiter (at most Logger::rate_limit() messages per
+ * window, shared by all threads).
+ */
+class RateLimiter
+{
+    protected:
+
+    std::atomic<uint64_t> windowStart_;
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> suppressed_;
+
+    public:
+
+    RateLimiter() : windowStart_(0), count_(0), suppressed_(0) {}
+
+    /**
+     * Returns true if a message can be emitted. suppressed is set to the
+     * number of messages rejected since the last accepted one.
+     */
+    bool acquire(uint64_t& suppressed);
+};
+
+/**
+ * Formats a message of the calling thread into its buffer. The message is
+ * committed on destruction.
+ */
+class LogMessage
+{
+    protected:
+
+    LogBuffer*       buffer_;
+    LogBuffer::Slot* slot_;
+
+    public:
+
+    LogMessage(LogLevel level, const char* file, unsigned int line, uint64_t suppressed);
+    ~LogMessage();
+
+    LogMessage(const LogMessage&) = delete;
+    LogMessage& operator=(const LogMessage&) = delete;
+
+    std::ostream& stream();
+};
+
+/**
+ * Runtime level, read by Logger::enabled without constructing the Logger.
+ * Negative until set by Logger::set_level or initialized from the
+ * RTAC_LOG_LEVEL environment variable on the first read.
+ */
+inline std::atomic<int> logLevel(-1);
+int init_log_level();
+
+}; //namespace details
+
+class Logger
+{
+    public:
+
+    using Sink = std::function<void(const LogRecord&)>;
+
+    static constexpr std::size_t DefaultBufferSize = 512;
+
+    protected:
+
+    std::atomic<uint64_t> rateLimit_;
+    std::atomic<uint64_t> rateWindow_; // nanoseconds
+
+    mutable std::mutex                               mutex_; // buffers registry
+    std::vector<std::unique_ptr<details::LogBuffer>> buffers_;
+    std::size_t                                      bufferSize_;
+
+    std::mutex                       flushMutex_; // single consumer
+    Sink                             sink_;
+    std::vector<details::LogBuffer*> snapshot_;
+    std::vector<uint64_t>            heads_;
+    std::vector<std::pair<const details::LogBuffer::Slot*, unsigned int>> pending_;
+
+    std::mutex              wakeMutex_;
+    std::condition_variable wakeCondition_;
+    std::atomic<bool>       wakeRequested_;
+    std::atomic<bool>       running_;
+    std::atomic<uint64_t>   flushInterval_; // nanoseconds
+    std::once_flag          started_;
+    std::thread             thread_;
+
+    Logger();
+    ~Logger() = default;
+
+    static int current_level() {
+        int level = details::logLevel.load(std::memory_order_relaxed);
+        return level >= 0 ? level : details::init_log_level();
+    }
+
+    void start();
+    void run();
+    void emit(const LogRecord& record, std::ostream& defaultSink);
+    static void shutdown();
+
+    friend class details::LogMessage;
+
+    public:
+
+    static Logger& instance();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    static bool enabled(LogLevel level) { return static_cast<int>(level) >= current_level(); }
+
+    void     set_level(LogLevel level) { details::logLevel.store(static_cast<int>(level)); }
+    LogLevel level() const { return static_cast<LogLevel>(current_level()); }
+
+    // messagesPerWindow = 0 disables rate limiting.
+    void     set_rate_limit(uint64_t messagesPerWindow, double window = 1.0);
+    uint64_t rate_limit()  const { return rateLimit_.load(std::memory_order_relaxed);  }
+    uint64_t rate_window() const { return rateWindow_.load(std::memory_order_relaxed); }
+
+    // Replaces the sink (a null sink restores the default stderr sink). The
+    // sink is called from the flushing thread and must neither throw nor log.
+    void set_sink(Sink sink);
+    // Maximum delay before non-error messages are written.
+    void set_flush_interval(double seconds);
+    // Number of messages of each thread buffer (rounded up to a power of two).
+    // Only applies to threads which did not log yet.
+    void set_buffer_size(std::size_t messageCount);
+
+    details::LogBuffer* register_thread();
+    void                notify();
+
+    /**
+     * Writes all pending messages to the sink before returning.
+     */
+    void flush();
+    // Total number of messages dropped because of full buffers.
+    uint64_t dropped() const;
+
+    static void format(std::ostream& os, const LogRecord& record);
+};
+
+}; //namespace logging
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, rtac::logging::LogLevel level);
+
+#define RTAC_LOG_LEVEL_TRACE   0
+#define RTAC_LOG_LEVEL_DEBUG   1
+#define RTAC_LOG_LEVEL_INFO    2
+#define RTAC_LOG_LEVEL_WARNING 3
+#define RTAC_LOG_LEVEL_ERROR   4
+
+#ifndef RTAC_LOG_MIN_LEVEL
+    #define RTAC_LOG_MIN_LEVEL RTAC_LOG_LEVEL_TRACE
+#endif
+
+// message is a stream expression : RTAC_LOG_INFO("value : " << value);
+#define RTAC_LOG(level, message)                                                  \
+    do {                                                                          \
+        if(::rtac::logging::Logger::enabled(level)) {                             \
+            static ::rtac::logging::details::RateLimiter rtacLogLimiter_;         \
+            uint64_t rtacLogSuppressed_;                                          \
+            if(rtacLogLimiter_.acquire(rtacLogSuppressed_)) {                     \
+                ::rtac::logging::details::LogMessage rtacLogMessage_(             \
+                    level, __FILE__, __LINE__, rtacLogSuppressed_);               \
+                rtacLogMessage_.stream() << message;                              \
+            }                                                                     \
+        }                                                                         \
+    } while(0)
+
+#if RTAC_LOG_MIN_LEVEL <= RTAC_LOG_LEVEL_TRACE
+    #define RTAC_LOG_TRACE(message) RTAC_LOG(::rtac::logging::LogLevel::Trace, message)
+#else
+    #define RTAC_LOG_TRACE(message) do {} while(0)
+#endif
+#if RTAC_LOG_MIN_LEVEL <= RTAC_LOG_LEVEL_DEBUG
+    #define RTAC_LOG_DEBUG(message) RTAC_LOG(::rtac::logging::LogLevel::Debug, message)
+#else
+    #define RTAC_LOG_DEBUG(message) do {} while(0)
+#endif
+#if RTAC_LOG_MIN_LEVEL <= RTAC_LOG_LEVEL_INFO
+    #define RTAC_LOG_INFO(message) RTAC_LOG(::rtac::logging::LogLevel::Info, message)
+#else
+    #define RTAC_LOG_INFO(message) do {} while(0)
+#endif
+#if RTAC_LOG_MIN_LEVEL <= RTAC_LOG_LEVEL_WARNING
+    #define RTAC_LOG_WARNING(message) RTAC_LOG(::rtac::logging::LogLevel::Warning, message)
+#else
+    #define RTAC_LOG_WARNING(message) do {} while(0)
+#endif
+#if RTAC_LOG_MIN_LEVEL <= RTAC_LOG_LEVEL_ERROR
+    #define RTAC_LOG_ERROR(message) RTAC_LOG(::rtac::logging::LogLevel::Error, message)
+#else
+    #define RTAC_LOG_ERROR(message) do {} while(0)
+#endif
+
+#endif //_DEF_RTAC_BASE_LOGGING_H_
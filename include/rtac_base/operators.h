@@ -0,0 +1,49 @@
+#ifndef _DEF_RTAC_BASE_OPERATORS_H_
+#define _DEF_RTAC_BASE_OPERATORS_H_
+
+#include <limits>
+
+#include <rtac_base/cuda_defines.h>
+
+namespace rtac { namespace operators {
+
+template <typename T>
+struct Addition {
+    static constexpr T Neutral = 0;
+    RTAC_HOSTDEVICE static void apply(T& inout, const T& in)   { inout += in; }
+};
+
+template <typename T>
+struct Substraction {
+    static constexpr T Neutral = 0;
+    RTAC_HOSTDEVICE static void apply(T& inout, const T& in)   { inout -= in; }
+};
+
+template <typename T>
+struct Multiplication {
+    static constexpr T Neutral = 1;
+    RTAC_HOSTDEVICE static void apply(T& inout, const T& in)   { inout *= in; }
+};
+
+template <typename T>
+struct Division {
+    static constexpr T Neutral = 1;
+    RTAC_HOSTDEVICE static void apply(T& inout, const T& in)   { inout /= in; }
+};
+
+template <typename T>
+struct Minimum {
+    static constexpr T Neutral = std::numeric_limits<T>::max();
+    RTAC_HOSTDEVICE static void apply(T& inout, const T& in)   { inout = in < inout ? in : inout; }
+};
+
+template <typename T>
+struct Maximum {
+    static constexpr T Neutral = std::numeric_limits<T>::lowest();
+    RTAC_HOSTDEVICE static void apply(T& inout, const T& in)   { inout = in > inout ? in : inout; }
+};
+
+}; //namespace operators
+}; //namespace rtac
+
+#endif //_DEF_RTAC_BASE_OPERATORS_H_
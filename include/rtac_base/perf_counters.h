@@ -0,0 +1,139 @@
+#ifndef _DEF_RTAC_BASE_PERF_COUNTERS_H_
+#define _DEF_RTAC_BASE_PERF_COUNTERS_H_
+
+#include <iostream>
+#include <string>
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+namespace rtac { namespace time {
+
+/**
+ * Values of the hardware counters over a code region.
+ *
+ * A counter may be unavailable (not supported by the CPU or the virtual
+ * machine, or not permitted by /proc/sys/kernel/perf_event_paranoid), in
+ * which case valid(counter) is false and its value is 0. The wall-clock time
+ * is always available.
+ */
+struct PerfCounterValues
+{
+    enum Counter : unsigned int {
+        Cycles = 0,
+        Instructions,
+        CacheMisses,
+        BranchMisses,
+        CounterCount
+    };
+
+    std::array<uint64_t, CounterCount> values = {0,0,0,0};
+    std::array<bool,     CounterCount> validity = {false,false,false,false};
+    double seconds = 0.0;
+
+    uint64_t operator[](Counter c) const { return values[c];   }
+    bool     valid(Counter c)      const { return validity[c]; }
+
+    uint64_t cycles()        const { return values[Cycles];       }
+    uint64_t instructions()  const { return values[Instructions]; }
+    uint64_t cache_misses()  const { return values[CacheMisses];  }
+    uint64_t branch_misses() const { return values[BranchMisses]; }
+
+    // Instructions per cycle (0 if not available).
+    double ipc() const;
+    // Counter value divided by a number of processed elements.
+    double per_element(Counter c, std::size_t elementCount) const;
+
+    PerfCounterValues& operator+=(const PerfCounterValues& other);
+
+    static const char* name(Counter c);
+    std::ostream& print(std::ostream& os, std::size_t elementCount = 0) const;
+};
+
+/**
+ * Group of hardware counters (cycles, instructions, cache misses, branch
+ * misses) attached to the calling thread with Linux perf_event_open.
+ *
+ * The counters are opened as a single group so they are scheduled together
+ * on the PMU and their ratios are consistent. Counters which cannot be
+ * opened are skipped. If none can be opened (non Linux system, no
+ * permission...), the group is not available but can still be used : only
+ * the wall-clock time is measured.
+ *
+ * Counters only count events of the thread which created the group, in user
+ * space. A group must be started and stopped from that thread.
+ */
+class PerfCounterGroup
+{
+    public:
+
+    using Counter = PerfCounterValues::Counter;
+    using Clock   = std::chrono::steady_clock;
+
+    protected:
+
+    std::array<int, PerfCounterValues::CounterCount>      fds_;
+    std::array<uint64_t, PerfCounterValues::CounterCount> ids_; // tag the values read
+    int               leader_;
+    std::string       error_;
+    Clock::time_point start_;
+
+    PerfCounterValues read_counters() const;
+
+    public:
+
+    PerfCounterGroup();
+    ~PerfCounterGroup();
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    bool available() const { return leader_ >= 0; }
+    bool available(Counter c) const { return fds_[c] >= 0; }
+    // Reason why counters are missing (empty if all are available).
+    const std::string& error() const { return error_; }
+
+    void start();
+    PerfCounterValues stop();
+
+    /**
+     * Measures the counters while calling f().
+     */
+    template <class F>
+    PerfCounterValues measure(F&& f) {
+        this->start();
+        f();
+        return this->stop();
+    }
+};
+
+/**
+ * Measures a code region : starts the group on construction, stops it on
+ * destruction and accumulates the result in output.
+ */
+class PerfRegion
+{
+    protected:
+
+    PerfCounterGroup&  group_;
+    PerfCounterValues& output_;
+
+    public:
+
+    PerfRegion(PerfCounterGroup& group, PerfCounterValues& output) :
+        group_(group), output_(output)
+    {
+        group_.start();
+    }
+    ~PerfRegion() { output_ += group_.stop(); }
+
+    PerfRegion(const PerfRegion&) = delete;
+    PerfRegion& operator=(const PerfRegion&) = delete;
+};
+
+}; //namespace time
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::time::PerfCounterValues& values);
+
+#endif //_DEF_RTAC_BASE_PERF_COUNTERS_H_
@@ -0,0 +1,148 @@
+#ifndef _DEF_RTAC_BASE_PERIODIC_EXECUTOR_H_
+#define _DEF_RTAC_BASE_PERIODIC_EXECUTOR_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include <rtac_base/types/Handle.h>
+#include <rtac_base/profiling.h>
+
+namespace rtac { namespace time {
+
+/**
+ * Timing statistics of a periodic task (in seconds).
+ */
+struct PeriodicTaskStats
+{
+    struct Timing {
+        double mean = 0.0;
+        double p50  = 0.0;
+        double p99  = 0.0;
+        double max  = 0.0;
+    };
+
+    std::string name;
+    double      period   = 0.0;
+    uint64_t    runs     = 0;
+    uint64_t    overruns = 0; // runs which ended after the next release time
+    uint64_t    skipped  = 0; // releases dropped because of overruns
+    uint64_t    errors   = 0; // runs which threw an exception
+    Timing      latency;      // start of the run minus its release time
+    Timing      execution;    // duration of the run
+};
+
+/**
+ * Worker threads configuration of a PeriodicExecutor.
+ */
+struct PeriodicExecutorOptions
+{
+    unsigned int     threadCount  = 1;
+    std::vector<int> cpus;              // worker i is pinned on cpus[i % cpus.size()]
+    int              fifoPriority = 0;  // SCHED_FIFO priority (1-99) if > 0
+    double           spinDuration = 100.0e-6;
+};
+
+/**
+ * Runs periodic tasks on a small set of worker threads.
+ *
+ * Each task is released on absolute deadlines (the first one at add time
+ * plus an optional phase, then every period) so the rate does not drift with
+ * the execution time. Workers sleep until shortly before the earliest release
+ * time and spin for the remaining time. A task never runs concurrently with
+ * itself.
+ *
+ * A run ending after the next release time of its task is an overrun : the
+ * releases which were missed are skipped (the task is re-aligned on its
+ * original schedule) and counted.
+ *
+ * The workers can optionally be pinned to CPUs and run with the SCHED_FIFO
+ * real-time policy. This usually requires privileges (CAP_SYS_NICE or an
+ * rtprio limit). Failures are not fatal and are reported by error().
+ */
+class PeriodicExecutor
+{
+    public:
+
+    using Ptr      = rtac::types::Handle<PeriodicExecutor>;
+    using ConstPtr = rtac::types::Handle<const PeriodicExecutor>;
+    using Task     = std::function<void()>;
+    using TaskId   = unsigned int;
+    using Clock    = std::chrono::steady_clock;
+
+    using Options  = PeriodicExecutorOptions;
+
+    protected:
+
+    struct Entry {
+        TaskId                   id;
+        std::string              name;
+        Task                     task;
+        Clock::duration          period;
+        bool                     removed = false;
+        bool                     running = false;
+        std::thread::id          runner;
+        uint64_t                 overruns = 0;
+        uint64_t                 skipped  = 0;
+        uint64_t                 errors   = 0;
+        details::ProfileCounters latency;   // nanoseconds
+        details::ProfileCounters execution; // nanoseconds
+    };
+    struct Release {
+        Clock::time_point     time;
+        types::Handle<Entry>  entry;
+        bool operator<(const Release& other) const { return time > other.time; }
+    };
+
+    Options options_;
+
+    mutable std::mutex                               mutex_;
+    std::condition_variable                          cv_;
+    std::condition_variable                          doneCv_;
+    std::vector<Release>                             releases_; // heap, earliest first
+    std::unordered_map<TaskId, types::Handle<Entry>> tasks_;
+    TaskId                                           nextId_;
+    bool                                             stop_;
+    std::string                                      error_;
+    std::vector<std::thread>                         threads_;
+
+    PeriodicExecutor(const Options& options);
+
+    void run(unsigned int workerIndex);
+    void configure_thread(unsigned int workerIndex);
+    static PeriodicTaskStats make_stats(const Entry& entry);
+
+    public:
+
+    static Ptr Create(const Options& options = Options());
+    ~PeriodicExecutor();
+
+    PeriodicExecutor(const PeriodicExecutor&) = delete;
+    PeriodicExecutor& operator=(const PeriodicExecutor&) = delete;
+
+    TaskId add_task(const std::string& name, double period, Task task, double phase = 0.0);
+    TaskId add_task(const std::string& name, double period, Task task,
+                    Clock::time_point firstRelease);
+    void   remove_task(TaskId id);
+
+    unsigned int thread_count() const { return threads_.size(); }
+    std::string  error() const;
+
+    PeriodicTaskStats              stats(TaskId id) const;
+    std::vector<PeriodicTaskStats> stats() const;
+    void reset_stats();
+    std::ostream& print(std::ostream& os) const;
+};
+
+}; //namespace time
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::time::PeriodicExecutor& executor);
+
+#endif //_DEF_RTAC_BASE_PERIODIC_EXECUTOR_H_
@@ -0,0 +1,320 @@
+#ifndef _DEF_RTAC_BASE_PROFILING_H_
+#define _DEF_RTAC_BASE_PROFILING_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+
+#include <rtac_base/time.h>
+
+namespace rtac { namespace time {
+
+// Scoped profiling timers.
+//
+// A profiling scope measures the time between its construction and its
+// destruction and accumulates it in statistics attached to its name. Scopes
+// can be nested : the time spent in a scope minus the time spent in its
+// child scopes (the self time) is reported as well.
+//
+//     void process() {
+//         RTAC_PROFILE_SCOPE("process");
+//         ...
+//         {
+//             RTAC_PROFILE_SCOPE("process/filter");
+//             ...
+//         }
+//     }
+//     ...
+//     std::cout << rtac::time::Profiler::instance();
+//
+// Each thread records into its own counters, so the hot path takes no lock.
+// Statistics of all threads are merged when they are read. Defining
+// RTAC_NO_PROFILING removes the scopes declared with the RTAC_PROFILE_*
+// macros at compile time.
+
+namespace details {
+
+// Durations are stored in TickClock ticks (converted to seconds only when the
+// statistics are read), in a log-linear histogram : each power of two is
+// split in ProfileSubBuckets buckets (12.5% resolution on percentiles).
+constexpr unsigned int ProfileSubBits     = 3;
+constexpr unsigned int ProfileSubBuckets  = 1u << ProfileSubBits;
+constexpr unsigned int ProfileBucketCount = 48*ProfileSubBuckets;
+
+inline unsigned int profile_bucket(uint64_t ticks)
+{
+    if(ticks < ProfileSubBuckets)
+        return ticks;
+    unsigned int exponent = 63 - __builtin_clzll(ticks);
+    unsigned int sub      = (ticks >> (exponent - ProfileSubBits)) & (ProfileSubBuckets - 1);
+    unsigned int bucket   = (exponent - ProfileSubBits + 1)*ProfileSubBuckets + sub;
+    return bucket < ProfileBucketCount ? bucket : ProfileBucketCount - 1;
+}
+
+/**
+ * Middle of the range of values stored in bucket.
+ */
+inline double profile_bucket_value(unsigned int bucket)
+{
+    if(bucket < ProfileSubBuckets)
+        return bucket;
+    unsigned int exponent = bucket / ProfileSubBuckets + ProfileSubBits - 1;
+    unsigned int sub      = bucket % ProfileSubBuckets;
+    double width = double(uint64_t(1) << (exponent - ProfileSubBits));
+    return (ProfileSubBuckets + sub)*width + 0.5*width;
+}
+
+inline uint64_t profile_now()
+{
+    return TickClock::now();
+}
+
+/**
+ * Statistics of a single scope name in a single thread. Only the owning
+ * thread writes (the fetch_adds are uncontended), other threads may read or
+ * reset concurrently.
+ */
+struct ProfileCounters
+{
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> self{0};
+    std::atomic<uint64_t> max{0};
+    std::atomic<uint64_t> buckets[ProfileBucketCount];
+
+    ProfileCounters() {
+        for(auto& b : buckets) b.store(0, std::memory_order_relaxed);
+    }
+
+    void add(uint64_t duration, uint64_t selfDuration) {
+        count.fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(duration, std::memory_order_relaxed);
+        self.fetch_add(selfDuration, std::memory_order_relaxed);
+        if(duration > max.load(std::memory_order_relaxed))
+            max.store(duration, std::memory_order_relaxed);
+        buckets[profile_bucket(duration)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void merge(const ProfileCounters& other) {
+        count.fetch_add(other.count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        total.fetch_add(other.total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        self.fetch_add(other.self.load(std::memory_order_relaxed),   std::memory_order_relaxed);
+        uint64_t otherMax = other.max.load(std::memory_order_relaxed);
+        if(otherMax > max.load(std::memory_order_relaxed))
+            max.store(otherMax, std::memory_order_relaxed);
+        for(unsigned int b = 0; b < ProfileBucketCount; b++) {
+            buckets[b].fetch_add(other.buckets[b].load(std::memory_order_relaxed),
+                                 std::memory_order_relaxed);
+        }
+    }
+
+    void clear() {
+        count.store(0, std::memory_order_relaxed);
+        total.store(0, std::memory_order_relaxed);
+        self.store(0,  std::memory_order_relaxed);
+        max.store(0,   std::memory_order_relaxed);
+        for(auto& b : buckets) b.store(0, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Counters of all the scope names for one thread. Counters are allocated by
+ * blocks on first use by the owning thread and never moved, so readers can
+ * access them without locking.
+ */
+class ThreadProfile
+{
+    public:
+
+    static constexpr unsigned int BlockSize = 64;
+    static constexpr unsigned int MaxBlocks = 64;
+    static constexpr unsigned int MaxSites  = BlockSize*MaxBlocks;
+
+    protected:
+
+    std::atomic<ProfileCounters*> blocks_[MaxBlocks];
+
+    public:
+
+    ThreadProfile() {
+        for(auto& b : blocks_) b.store(nullptr, std::memory_order_relaxed);
+    }
+    ~ThreadProfile() {
+        for(auto& b : blocks_) delete[] b.load();
+    }
+
+    ThreadProfile(const ThreadProfile&) = delete;
+    ThreadProfile& operator=(const ThreadProfile&) = delete;
+
+    // owning thread only
+    ProfileCounters& counters(unsigned int site) {
+        auto& block = blocks_[site / BlockSize];
+        auto counters = block.load(std::memory_order_relaxed);
+        if(!counters) {
+            counters = new ProfileCounters[BlockSize];
+            block.store(counters, std::memory_order_release);
+        }
+        return counters[site % BlockSize];
+    }
+
+    // any thread (nullptr if the site was never recorded in this thread).
+    ProfileCounters* find(unsigned int site) const {
+        auto counters = blocks_[site / BlockSize].load(std::memory_order_acquire);
+        return counters ? counters + (site % BlockSize) : nullptr;
+    }
+};
+
+}; //namespace details
+
+/**
+ * Aggregated statistics of a profiling scope name (durations in seconds).
+ */
+struct ProfileStats
+{
+    std::string name;
+    uint64_t    count = 0;
+    double      total = 0.0;
+    double      self  = 0.0; // total minus time spent in child scopes
+    double      mean  = 0.0;
+    double      p50   = 0.0;
+    double      p95   = 0.0;
+    double      p99   = 0.0;
+    double      max   = 0.0;
+};
+
+/**
+ * Registry of the profiling scope names and of the per-thread counters.
+ *
+ * The counters of a thread are merged into retired_ when the thread exits,
+ * and its ThreadProfile is reused by the next registered thread.
+ */
+class Profiler
+{
+    protected:
+
+    mutable std::mutex                                  mutex_;
+    std::vector<std::string>                            names_;
+    std::unordered_map<std::string, unsigned int>       ids_;
+    std::vector<std::unique_ptr<details::ThreadProfile>> threads_;
+    std::vector<std::unique_ptr<details::ThreadProfile>> freeProfiles_;
+    details::ThreadProfile                              retired_;
+
+    std::thread             dumpThread_;
+    std::mutex              dumpMutex_;
+    std::condition_variable dumpCv_;
+    bool                    dumpStop_;
+
+    Profiler();
+
+    public:
+
+    static Profiler& instance();
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    unsigned int site_id(const std::string& name);
+    details::ThreadProfile* register_thread();
+    void release_thread(details::ThreadProfile* profile);
+    // Number of ThreadProfile allocated (registered threads + free list).
+    std::size_t allocated_profiles() const;
+
+    std::vector<ProfileStats> stats() const;
+    void reset();
+    std::ostream& print(std::ostream& os) const;
+
+    void start_periodic_dump(double period, std::ostream& os = std::cout,
+                             bool resetAfterDump = true);
+    void stop_periodic_dump();
+};
+
+/**
+ * Identifies a profiling scope name. Sites are meant to be declared static
+ * (see RTAC_PROFILE_SCOPE) so the name lookup only happens once.
+ */
+class ProfileSite
+{
+    protected:
+
+    unsigned int id_;
+
+    public:
+
+    ProfileSite(const std::string& name) : id_(Profiler::instance().site_id(name)) {}
+    unsigned int id() const { return id_; }
+};
+
+namespace details {
+inline thread_local ThreadProfile* threadProfile = nullptr;
+}
+
+class ProfileScope
+{
+    protected:
+
+    unsigned int  site_;
+    uint64_t      start_;
+    uint64_t      children_;
+    ProfileScope* parent_;
+
+    public:
+
+    ProfileScope(const ProfileSite& site) :
+        site_(site.id()),
+        children_(0),
+        parent_(current())
+    {
+        current() = this;
+        start_ = details::profile_now();
+    }
+
+    ~ProfileScope()
+    {
+        uint64_t duration = details::profile_now() - start_;
+        if(!details::threadProfile)
+            details::threadProfile = Profiler::instance().register_thread();
+        details::threadProfile->counters(site_).add(duration, duration - children_);
+        if(parent_)
+            parent_->children_ += duration;
+        current() = parent_;
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    // innermost scope of the calling thread
+    static ProfileScope*& current() {
+        static thread_local ProfileScope* scope = nullptr;
+        return scope;
+    }
+};
+
+}; //namespace time
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::time::Profiler& profiler);
+
+#define RTAC_PROFILE_CONCAT_IMPL(a, b) a##b
+#define RTAC_PROFILE_CONCAT(a, b) RTAC_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef RTAC_NO_PROFILING
+    #define RTAC_PROFILE_SCOPE(name)
+    #define RTAC_PROFILE_FUNCTION()
+#else
+    #define RTAC_PROFILE_SCOPE(name)                                                   \
+        static ::rtac::time::ProfileSite RTAC_PROFILE_CONCAT(rtacProfileSite_, __LINE__)(name); \
+        ::rtac::time::ProfileScope RTAC_PROFILE_CONCAT(rtacProfileScope_, __LINE__)(    \
+            RTAC_PROFILE_CONCAT(rtacProfileSite_, __LINE__))
+    #define RTAC_PROFILE_FUNCTION() RTAC_PROFILE_SCOPE(__PRETTY_FUNCTION__)
+#endif
+
+#endif //_DEF_RTAC_BASE_PROFILING_H_
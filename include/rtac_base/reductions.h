@@ -0,0 +1,311 @@
+#ifndef _DEF_RTAC_BASE_REDUCTIONS_H_
+#define _DEF_RTAC_BASE_REDUCTIONS_H_
+
+#include <array>
+#include <vector>
+#include <thread>
+#include <utility>
+#include <type_traits>
+
+#include <rtac_base/operators.h>
+#include <rtac_base/algorithm.h>
+
+namespace rtac { namespace algorithm {
+
+/**
+ * Accumulation strategy for host reductions.
+ *
+ * - Direct   : each thread accumulates its input range linearly (fastest).
+ * - Pairwise : the input range is recursively split in halves which are
+ *              reduced separately then combined. For floating point
+ *              additions, the error grows in O(log(N)) instead of O(N).
+ * - Kahan    : compensated summation. Only applies to Addition operators
+ *              (other operators fall back to Pairwise).
+ */
+enum class Accumulation {
+    Direct,
+    Pairwise,
+    Kahan
+};
+
+namespace details {
+
+// Number of independent accumulators used in the inner loops. The
+// accumulators do not depend on each other so the compiler can map them on
+// SIMD registers (a single accumulator would create a dependency chain
+// between successive iterations and prevent vectorization of floating point
+// reductions).
+constexpr unsigned int ReductionLanes = 16;
+// Below this size, pairwise reductions are performed directly.
+constexpr std::size_t PairwiseBlockSize = 1024;
+// Minimum number of elements handled by each thread.
+constexpr std::size_t ReductionChunkSize = 65536;
+
+template <typename T, template<typename> class... OperatorsT>
+using ReductionResult = std::array<T, sizeof...(OperatorsT)>;
+
+template <typename T, template<typename> class... OperatorsT, std::size_t... Is>
+inline void reduction_combine(ReductionResult<T, OperatorsT...>& inout,
+                              const ReductionResult<T, OperatorsT...>& in,
+                              std::index_sequence<Is...>)
+{
+    (OperatorsT<T>::apply(inout[Is], in[Is]), ...);
+}
+
+template <typename T, template<typename> class... OperatorsT>
+inline void reduction_combine(ReductionResult<T, OperatorsT...>& inout,
+                              const ReductionResult<T, OperatorsT...>& in)
+{
+    reduction_combine<T, OperatorsT...>(inout, in,
+        std::make_index_sequence<sizeof...(OperatorsT)>());
+}
+
+template <typename T, template<typename> class OperatorT>
+inline void reduce_lanes(T* acc, const T* in)
+{
+    for(unsigned int k = 0; k < ReductionLanes; k++) {
+        OperatorT<T>::apply(acc[k], in[k]);
+    }
+}
+
+template <typename T, template<typename> class OperatorT>
+inline T reduce_lanes_tail(const T* acc, const T* in, std::size_t N)
+{
+    T res = acc[0];
+    for(unsigned int k = 1; k < ReductionLanes; k++) {
+        OperatorT<T>::apply(res, acc[k]);
+    }
+    for(std::size_t i = 0; i < N; i++) {
+        OperatorT<T>::apply(res, in[i]);
+    }
+    return res;
+}
+
+template <typename T, template<typename> class... OperatorsT, std::size_t... Is>
+inline ReductionResult<T, OperatorsT...> reduce_direct(const T* in, std::size_t N,
+                                                       std::index_sequence<Is...>)
+{
+    T acc[sizeof...(OperatorsT)][ReductionLanes];
+    (std::fill(acc[Is], acc[Is] + ReductionLanes, OperatorsT<T>::Neutral), ...);
+
+    std::size_t i = 0;
+    for(; i + ReductionLanes <= N; i += ReductionLanes) {
+        (reduce_lanes<T, OperatorsT>(acc[Is], in + i), ...);
+    }
+    return ReductionResult<T, OperatorsT...>(
+        {reduce_lanes_tail<T, OperatorsT>(acc[Is], in + i, N - i)...});
+}
+
+/**
+ * Reduces [in, in + N[ for all operators in a single pass over the data.
+ */
+template <typename T, template<typename> class... OperatorsT>
+inline ReductionResult<T, OperatorsT...> reduce_direct(const T* in, std::size_t N)
+{
+    return reduce_direct<T, OperatorsT...>(in, N,
+        std::make_index_sequence<sizeof...(OperatorsT)>());
+}
+
+template <typename T, template<typename> class... OperatorsT>
+inline ReductionResult<T, OperatorsT...> reduce_pairwise(const T* in, std::size_t N)
+{
+    if(N <= PairwiseBlockSize) {
+        return reduce_direct<T, OperatorsT...>(in, N);
+    }
+    // Splitting on a multiple of the block size keeps the leaves aligned.
+    std::size_t half = ((N / 2 + PairwiseBlockSize - 1) / PairwiseBlockSize)
+                     * PairwiseBlockSize;
+    auto res = reduce_pairwise<T, OperatorsT...>(in, half);
+    reduction_combine<T, OperatorsT...>(res,
+        reduce_pairwise<T, OperatorsT...>(in + half, N - half));
+    return res;
+}
+
+/**
+ * Kahan compensated summation, with one compensation term per lane so that
+ * the lanes can be vectorized. (This must not be compiled with -ffast-math,
+ * which would optimize the compensation away).
+ */
+template <typename T>
+inline T reduce_kahan(const T* in, std::size_t N)
+{
+    T sum[ReductionLanes], c[ReductionLanes];
+    for(unsigned int k = 0; k < ReductionLanes; k++) {
+        sum[k] = 0;
+        c[k]   = 0;
+    }
+
+    std::size_t i = 0;
+    for(; i + ReductionLanes <= N; i += ReductionLanes) {
+        for(unsigned int k = 0; k < ReductionLanes; k++) {
+            T y = in[i + k] - c[k];
+            T t = sum[k] + y;
+            c[k]   = (t - sum[k]) - y;
+            sum[k] = t;
+        }
+    }
+
+    T res = 0, comp = 0;
+    auto accumulate = [&](T value) {
+        T y = value - comp;
+        T t = res + y;
+        comp = (t - res) - y;
+        res  = t;
+    };
+    for(; i < N; i++) {
+        accumulate(in[i]);
+    }
+    for(unsigned int k = 0; k < ReductionLanes; k++) {
+        accumulate(sum[k]);
+        accumulate(-c[k]);
+    }
+    return res;
+}
+
+template <typename T, template<typename> class... OperatorsT>
+inline ReductionResult<T, OperatorsT...> reduce_range(const T* in, std::size_t N,
+                                                      Accumulation mode)
+{
+    if constexpr(sizeof...(OperatorsT) == 1) {
+        constexpr bool isAddition = (std::is_same<OperatorsT<T>,
+                                     operators::Addition<T>>::value && ...);
+        if constexpr(isAddition && std::is_floating_point<T>::value) {
+            if(mode == Accumulation::Kahan)
+                return ReductionResult<T, OperatorsT...>({reduce_kahan(in, N)});
+        }
+    }
+    if(mode == Accumulation::Direct)
+        return reduce_direct<T, OperatorsT...>(in, N);
+    return reduce_pairwise<T, OperatorsT...>(in, N);
+}
+
+inline unsigned int reduction_thread_count(std::size_t size, unsigned int threadCount)
+{
+    if(threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    return std::max<std::size_t>(1, std::min<std::size_t>(threadCount,
+                                                         size / ReductionChunkSize));
+}
+
+}; //namespace details
+
+/**
+ * Performs several reductions over the same input in a single pass over
+ * memory (for example fused_reduce<float, Minimum, Maximum, Addition> gives
+ * the min, the max and the sum of the input array).
+ *
+ * The input is split in contiguous chunks reduced on separate threads, then
+ * the partial results are combined in chunk order.
+ *
+ * @param in          input array.
+ * @param N           input size.
+ * @param mode        accumulation strategy (see Accumulation).
+ * @param threadCount number of chunks, run on the global TaskPool (0 to use all
+ *                    hardware threads).
+ *
+ * @return an array holding the result for each operator, in order.
+ */
+template <typename T, template<typename> class... OperatorsT>
+std::array<T, sizeof...(OperatorsT)> fused_reduce(const T* in, std::size_t N,
+    Accumulation mode = Accumulation::Direct, unsigned int threadCount = 0)
+{
+    threadCount = details::reduction_thread_count(N, threadCount);
+    std::vector<details::ReductionResult<T,OperatorsT...>> partials(threadCount);
+    details::parallel_chunks(threadCount, N,
+        [&](unsigned int t, std::size_t begin, std::size_t end) {
+            partials[t] = details::reduce_range<T,OperatorsT...>(in + begin,
+                                                                 end - begin, mode);
+        });
+
+    auto res = partials[0];
+    for(unsigned int t = 1; t < threadCount; t++) {
+        details::reduction_combine<T, OperatorsT...>(res, partials[t]);
+    }
+    return res;
+}
+
+/**
+ * Host counterpart of rtac::cuda::device::reduce. Reduces the N elements of
+ * in with OperatorT.
+ */
+template <typename T, template<typename> class OperatorT = operators::Addition>
+T reduce(const T* in, std::size_t N, Accumulation mode = Accumulation::Direct,
+         unsigned int threadCount = 0)
+{
+    return fused_reduce<T, OperatorT>(in, N, mode, threadCount)[0];
+}
+
+/**
+ * Performs several reductions on each line of a 2D array in a single pass
+ * (see fused_reduce). Lines are distributed over threads.
+ *
+ * The result for the line h and the i-th operator is written at
+ * out[i][outputStride*h].
+ */
+template <typename T, template<typename> class... OperatorsT>
+void fused_reduce_lines(const T* in, const std::array<T*, sizeof...(OperatorsT)>& out,
+                        unsigned int width, unsigned int height,
+                        unsigned int inputStride  = 0,
+                        unsigned int outputStride = 1,
+                        Accumulation mode = Accumulation::Direct,
+                        unsigned int threadCount  = 0)
+{
+    if(!inputStride) {
+        inputStride = width;
+    }
+
+    // Offsets computed in size_t : large strided buffers overflow 32 bits.
+    auto store = [&](std::size_t h, const details::ReductionResult<T,OperatorsT...>& res) {
+        for(std::size_t i = 0; i < out.size(); i++) {
+            out[i][(std::size_t)outputStride*h] = res[i];
+        }
+    };
+
+    // Not enough lines to keep all threads busy : lines are reduced one after
+    // the other, each with all threads.
+    auto lineThreads = details::reduction_thread_count(width, threadCount);
+    if(height < lineThreads) {
+        for(std::size_t h = 0; h < height; h++) {
+            store(h, fused_reduce<T, OperatorsT...>(in + (std::size_t)inputStride*h, width,
+                                                    mode, threadCount));
+        }
+        return;
+    }
+
+    details::parallel_chunks(
+        details::reduction_thread_count((std::size_t)width*height, threadCount),
+        height, [&](unsigned int, std::size_t begin, std::size_t end) {
+            for(auto h = begin; h < end; h++) {
+                store(h, details::reduce_range<T, OperatorsT...>(
+                    in + (std::size_t)inputStride*h, width, mode));
+            }
+        });
+}
+
+/**
+ * Host counterpart of rtac::cuda::device::reduce_lines. Reduces each line of
+ * a 2D array with OperatorT.
+ *
+ * @param in           input array.
+ * @param out          output array (one element per line).
+ * @param width        number of elements to reduce in each line.
+ * @param height       number of lines.
+ * @param inputStride  distance between two lines in the input array (defaults
+ *                     to width if 0).
+ * @param outputStride distance between two results in the output array.
+ */
+template <typename T, template<typename> class OperatorT = operators::Addition>
+void reduce_lines(const T* in, T* out, unsigned int width, unsigned int height,
+                  unsigned int inputStride  = 0,
+                  unsigned int outputStride = 1,
+                  Accumulation mode = Accumulation::Direct,
+                  unsigned int threadCount  = 0)
+{
+    fused_reduce_lines<T, OperatorT>(in, {out}, width, height,
+                                     inputStride, outputStride, mode, threadCount);
+}
+
+}; //namespace algorithm
+}; //namespace rtac
+
+#endif //_DEF_RTAC_BASE_REDUCTIONS_H_
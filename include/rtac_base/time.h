@@ -4,9 +4,72 @@
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <cstdint>
+#include <ctime>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define RTAC_HAS_TSC
+#endif
 
 namespace rtac { namespace time {
 
+namespace details {
+
+inline uint64_t monotonic_ns()
+{
+    timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return uint64_t(t.tv_sec)*1000000000 + t.tv_nsec;
+}
+
+bool   tsc_usable();
+double tsc_calibrate();
+
+}; //namespace details
+
+/**
+ * Low overhead timestamp source for profiling.
+ *
+ * On x86 CPUs with an invariant TSC (constant rate, synchronized across
+ * cores) which is also used by the kernel as its clock source, now() reads
+ * the TSC directly (a few nanoseconds). Otherwise it falls back to
+ * CLOCK_MONOTONIC and ticks are nanoseconds.
+ *
+ * Ticks are meant to be stored raw and converted to time units later (off
+ * the hot path). The TSC rate is calibrated against CLOCK_MONOTONIC on the
+ * first conversion (this may block for a few milliseconds if done right
+ * after the program start).
+ */
+class TickClock
+{
+    public:
+
+    using Ticks = uint64_t;
+
+    static bool uses_tsc() {
+        static const bool tsc = details::tsc_usable();
+        return tsc;
+    }
+
+    static Ticks now() {
+        #ifdef RTAC_HAS_TSC
+        if(uses_tsc())
+            return __rdtsc();
+        #endif
+        return details::monotonic_ns();
+    }
+
+    static double nanoseconds_per_tick() {
+        static const double factor = uses_tsc() ? details::tsc_calibrate() : 1.0;
+        return factor;
+    }
+
+    static double to_nanoseconds(Ticks ticks) { return ticks*nanoseconds_per_tick(); }
+    static double to_seconds(Ticks ticks) { return 1.0e-9*to_nanoseconds(ticks); }
+};
+
 /** 
  * Simple type to measure time less verbose than std::chrono.
  */
@@ -51,12 +114,41 @@ class Clock
 
 /** 
  * Simple type to count a frequency (in Hz or FramePerSecond).
+ *
+ * When the frame rate is limited, get() waits for the next frame deadline.
+ * With precise pacing enabled, deadlines are absolute (each deadline is the
+ * previous one plus the period) so that the frame rate does not drift with
+ * the time spent in the caller. The wait sleeps until shortly before the
+ * deadline and spins for the remaining time to absorb the scheduler wake-up
+ * latency. A frame arriving after its deadline is counted as missed. If it is
+ * late by more than a full period, the schedule is restarted from the current
+ * time instead of releasing a burst of frames to catch up.
+ *
+ * Frame periods (time between two calls to get()) of the last frames are
+ * kept to compute statistics over a rolling window (see stats()).
  */
 class FrameCounter
 {
     public:
 
-    using Duration = std::chrono::duration<double, std::ratio<1,1>>;
+    using Duration    = std::chrono::duration<double, std::ratio<1,1>>;
+    using SteadyClock = std::chrono::steady_clock;
+
+    /**
+     * Statistics over the last frames (periods in seconds). jitter is the
+     * standard deviation of the frame period.
+     */
+    struct Stats
+    {
+        unsigned int count      = 0;
+        double       minPeriod  = 0.0;
+        double       maxPeriod  = 0.0;
+        double       meanPeriod = 0.0;
+        double       jitter     = 0.0;
+        unsigned int missed     = 0;
+
+        double frame_rate() const { return meanPeriod > 0.0 ? 1.0 / meanPeriod : 0.0; }
+    };
 
     protected:
     
@@ -65,12 +157,35 @@ class FrameCounter
     mutable std::chrono::time_point<std::chrono::high_resolution_clock> t0_;
     Duration period_;
 
+    bool     precisePacing_;
+    Duration spinDuration_;
+    mutable SteadyClock::time_point deadline_;
+    mutable SteadyClock::time_point lastFrame_;
+
+    // Rolling window of frame periods and missed deadline flags.
+    mutable std::vector<double> periods_;
+    mutable std::vector<bool>   missed_;
+    mutable std::size_t         windowIndex_;
+    mutable std::size_t         windowCount_;
+    mutable bool                lastMissed_;
+
+    void wait_deadline() const;
+    void record_frame() const;
+
     public:
     
-    FrameCounter(int resetCount = 1);
+    FrameCounter(int resetCount = 1, unsigned int statsWindow = 128);
 
     void limit_frame_rate(float fps);
     void free_frame_rate();
+
+    void set_precise_pacing(bool enable, double spinDuration = 100.0e-6);
+    bool precise_pacing() const { return precisePacing_; }
+
+    void set_stats_window(unsigned int frameCount);
+    unsigned int stats_window() const { return periods_.size(); }
+    Stats stats() const;
+    void reset_stats();
     
     float get() const;
     std::ostream& print(std::ostream& os) const;
@@ -81,5 +196,6 @@ class FrameCounter
 
 std::ostream& operator<<(std::ostream& os, const rtac::time::Clock& clock);
 std::ostream& operator<<(std::ostream& os, const rtac::time::FrameCounter& counter);
+std::ostream& operator<<(std::ostream& os, const rtac::time::FrameCounter::Stats& stats);
 
 #endif //_DEF_RTAC_BASE_MISC_H_
@@ -0,0 +1,218 @@
+#ifndef _DEF_RTAC_BASE_TRACING_H_
+#define _DEF_RTAC_BASE_TRACING_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+#include <rtac_base/profiling.h>
+
+namespace rtac { namespace time {
+
+// Timeline tracing.
+//
+// Trace events (scope begin/end, instants and counter values) are recorded
+// with a TickClock timestamp in a fixed-size ring buffer owned by the
+// recording thread. When a buffer is full the oldest events are overwritten,
+// so tracing can stay enabled indefinitely and the last moments before a problem can be exported
+// at any time. The export follows the Chrome trace event format and can be
+// opened in https://ui.perfetto.dev or chrome://tracing.
+//
+//     void process_frame() {
+//         RTAC_TRACE_SCOPE("process_frame");
+//         ...
+//         RTAC_TRACE_COUNTER("queue_size", queue.size());
+//     }
+//     ...
+//     rtac::time::Tracer::instance().write_chrome_trace("trace.json");
+//
+// Event names are not copied : they must be string literals (or have static
+// storage duration). Defining RTAC_NO_TRACING removes the RTAC_TRACE_* macros
+// at compile time.
+
+namespace details {
+
+/**
+ * Ring buffer of trace events of a single thread. Only the owning thread
+ * writes. Readers copy the events then check (with the write counter) which
+ * events may have been overwritten during the copy. The event fields are
+ * relaxed atomics, which compile to plain loads and stores.
+ */
+class TraceBuffer
+{
+    public:
+
+    struct Event {
+        std::atomic<uint64_t>    timestamp;
+        std::atomic<const char*> name;
+        std::atomic<double>      value;
+        std::atomic<char>        phase; // 'B', 'E', 'i' or 'C' (Chrome format)
+    };
+
+    struct EventCopy {
+        uint64_t    timestamp;
+        const char* name;
+        double      value;
+        char        phase;
+    };
+
+    protected:
+
+    std::unique_ptr<Event[]> events_;
+    uint64_t                 mask_;
+    std::atomic<uint64_t>    head_;       // number of events ever written
+    std::atomic<uint64_t>    clearedAt_;  // events before this index were cleared
+    std::atomic<uint64_t>    exportedAt_; // events before this index were exported
+    std::atomic<bool>        inUse_;
+    std::string              threadName_;
+    unsigned int             threadIndex_;
+
+    public:
+
+    TraceBuffer(std::size_t capacity, unsigned int threadIndex);
+
+    std::size_t capacity() const { return mask_ + 1; }
+    unsigned int thread_index() const { return threadIndex_; }
+    const std::string& thread_name() const { return threadName_; }
+    void set_thread_name(const std::string& name) { threadName_ = name; }
+
+    uint64_t head() const { return head_.load(std::memory_order_acquire); }
+    void set_exported(uint64_t head) { exportedAt_.store(head, std::memory_order_relaxed); }
+
+    // Ownership by a thread. A buffer released by an exiting thread is
+    // reused by the next registering thread once its events were exported
+    // (or cleared).
+    bool acquire();
+    void release() { inUse_.store(false, std::memory_order_release); }
+
+    /**
+     * The release fence keeps the field stores from becoming visible before
+     * the previous head_ store (seqlock writer). A reader copying a field
+     * written here then sees, after its acquire fence, a head_ value telling
+     * that this slot is being overwritten.
+     */
+    void record(char phase, const char* name, double value = 0.0) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        Event& event = events_[head & mask_];
+        event.timestamp.store(profile_now(), std::memory_order_relaxed);
+        event.name.store(name,               std::memory_order_relaxed);
+        event.value.store(value,             std::memory_order_relaxed);
+        event.phase.store(phase,             std::memory_order_relaxed);
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    std::vector<EventCopy> events() const;
+    void clear();
+};
+
+inline thread_local TraceBuffer* traceBuffer = nullptr;
+
+}; //namespace details
+
+/**
+ * Registry of the per-thread trace buffers. The buffers of exited threads are
+ * kept in the registry and reused by new threads after the next export.
+ */
+class Tracer
+{
+    protected:
+
+    mutable std::mutex                                 mutex_;
+    std::vector<std::unique_ptr<details::TraceBuffer>> buffers_;
+    std::size_t                                        bufferSize_;
+    std::atomic<bool>                                  enabled_;
+
+    Tracer();
+
+    static details::TraceBuffer& buffer() {
+        if(!details::traceBuffer)
+            details::traceBuffer = instance().register_thread();
+        return *details::traceBuffer;
+    }
+
+    public:
+
+    static constexpr std::size_t DefaultBufferSize = 16384;
+
+    static Tracer& instance();
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    details::TraceBuffer* register_thread();
+    // Number of allocated buffers (threads recording or exited).
+    std::size_t buffer_count() const;
+
+    // runtime switch (tracing is enabled by default).
+    void set_enabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // Number of events of each thread buffer (rounded up to a power of two,
+    // the last capacity - 1 events are exported).
+    // Only applies to threads which did not record any event yet.
+    void set_buffer_size(std::size_t eventCount);
+
+    static void set_thread_name(const std::string& name) {
+        auto& threadBuffer = buffer();
+        std::lock_guard<std::mutex> lock(instance().mutex_);
+        threadBuffer.set_thread_name(name);
+    }
+
+    static void begin(const char* name) {
+        if(instance_enabled()) buffer().record('B', name);
+    }
+    static void end(const char* name) {
+        if(instance_enabled()) buffer().record('E', name);
+    }
+    static void instant(const char* name) {
+        if(instance_enabled()) buffer().record('i', name);
+    }
+    static void counter(const char* name, double value) {
+        if(instance_enabled()) buffer().record('C', name, value);
+    }
+    static bool instance_enabled() { return instance().enabled(); }
+
+    // Drops the events recorded so far (threads may keep recording).
+    void clear();
+    void write_chrome_trace(std::ostream& os) const;
+    void write_chrome_trace(const std::string& path) const;
+};
+
+/**
+ * Records a begin event on construction and an end event on destruction.
+ */
+class TraceScope
+{
+    protected:
+
+    const char* name_;
+
+    public:
+
+    TraceScope(const char* name) : name_(name) { Tracer::begin(name_); }
+    ~TraceScope() { Tracer::end(name_); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+}; //namespace time
+}; //namespace rtac
+
+#ifdef RTAC_NO_TRACING
+    #define RTAC_TRACE_SCOPE(name)
+    #define RTAC_TRACE_INSTANT(name)
+    #define RTAC_TRACE_COUNTER(name, value)
+#else
+    #define RTAC_TRACE_SCOPE(name) \
+        ::rtac::time::TraceScope RTAC_PROFILE_CONCAT(rtacTraceScope_, __LINE__)(name)
+    #define RTAC_TRACE_INSTANT(name) ::rtac::time::Tracer::instant(name)
+    #define RTAC_TRACE_COUNTER(name, value) ::rtac::time::Tracer::counter(name, value)
+#endif
+
+#endif //_DEF_RTAC_BASE_TRACING_H_
@@ -0,0 +1,235 @@
+#ifndef _DEF_RTAC_BASE_TYPES_BUFFER_POOL_H_
+#define _DEF_RTAC_BASE_TYPES_BUFFER_POOL_H_
+
+#include <iostream>
+#include <vector>
+#include <unordered_map>
+#include <typeindex>
+#include <mutex>
+#include <limits>
+#include <cstdint>
+
+#include <rtac_base/types/Handle.h>
+#include <rtac_base/types/Shape.h>
+#include <rtac_base/types/SharedVector.h>
+#include <rtac_base/types/Image.h>
+#include <rtac_base/types/PointCloudBase.h>
+#include <rtac_base/types/PointCloud.h>
+
+namespace rtac { namespace types {
+
+struct BufferPoolStats
+{
+    uint64_t    hits        = 0; // acquisitions served from the pool
+    uint64_t    misses      = 0; // acquisitions which allocated
+    uint64_t    evictions   = 0; // released buffers freed to respect the cap
+    std::size_t outstanding = 0; // buffers currently handed out
+    std::size_t cachedCount = 0; // buffers waiting in the pool
+    std::size_t cachedBytes = 0;
+
+    std::ostream& print(std::ostream& os) const;
+};
+
+struct BufferPoolOptions
+{
+    // Maximum memory kept by idle buffers. The least recently released
+    // buffers are freed first.
+    std::size_t maxCachedBytes = std::numeric_limits<std::size_t>::max();
+};
+
+namespace details {
+
+// Size (number of elements) and memory footprint of the pooled types.
+template <typename T>
+std::size_t pooled_size(const std::vector<T>& v) { return v.size(); }
+template <typename T>
+std::size_t pooled_bytes(const std::vector<T>& v) { return v.capacity()*sizeof(T); }
+template <typename P>
+std::size_t pooled_size(const PointCloudBase<P>& pc) { return pc.points.size(); }
+template <typename P>
+std::size_t pooled_bytes(const PointCloudBase<P>& pc) { return pc.points.capacity()*sizeof(P); }
+
+template <typename T>
+void pooled_delete(void* object) { delete static_cast<T*>(object); }
+
+}; //namespace details
+
+/**
+ * Pool of recycled buffers, to avoid allocating (and page faulting) new
+ * storage for each frame at high frame rates.
+ *
+ * Buffers are std::vectors (the storage of SharedVector and of Images with a
+ * SharedVector container) and PointCloudBase objects, keyed by type and
+ * number of elements. They are handed out as Handles whose deleter gives the
+ * buffer back to the pool (or frees it if the pool was destroyed meanwhile),
+ * so pooled buffers are used as any other Handle :
+ *
+ *     auto pool = rtac::types::BufferPool::Create();
+ *     while(running) {
+ *         PointCloud<> cloud = pool->point_cloud(width, height);
+ *         fill(cloud);
+ *         publish(cloud); // storage goes back to the pool when released
+ *     }
+ *
+ * The content of a recycled buffer is unspecified (it holds the data of its
+ * previous user). Buffers resized by their user are put back under their new
+ * size. Newly allocated buffers are value-initialized, so the preallocate_*
+ * methods also fault their pages in ahead of time.
+ */
+class BufferPool : public std::enable_shared_from_this<BufferPool>
+{
+    public:
+
+    using Ptr      = Handle<BufferPool>;
+    using ConstPtr = Handle<const BufferPool>;
+    using Options  = BufferPoolOptions;
+    using Stats    = BufferPoolStats;
+
+    protected:
+
+    struct Key {
+        std::type_index type;
+        std::size_t     size;
+        bool operator==(const Key& other) const {
+            return type == other.type && size == other.size;
+        }
+    };
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            return key.type.hash_code() ^ (std::hash<std::size_t>()(key.size) << 1);
+        }
+    };
+    struct Entry {
+        void*       object;
+        std::size_t bytes;
+        void        (*destroy)(void*);
+        uint64_t    releaseTick; // for least recently released eviction
+    };
+
+    Options                                              options_;
+    mutable std::mutex                                   mutex_;
+    std::unordered_map<Key, std::vector<Entry>, KeyHash> free_;
+    uint64_t                                             tick_;
+    Stats                                                stats_;
+
+    BufferPool(const Options& options);
+
+    void* take(const Key& key);
+    void  give(const Key& key, void* object, std::size_t bytes, void (*destroy)(void*),
+               bool handedOut = true);
+    void  evict(std::size_t maxBytes);
+
+    template <typename T, class CreateF>
+    Handle<T> acquire(std::size_t size, CreateF&& create);
+
+    public:
+
+    static Ptr Create(const Options& options = Options());
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    template <typename T>
+    Handle<std::vector<T>> vector(std::size_t size);
+    template <typename PointT = Point3<float>>
+    typename PointCloudBase<PointT>::Ptr point_cloud_base(uint32_t width, uint32_t height = 1);
+
+    // Pooled versions of the rtac containers.
+    template <typename T>
+    SharedVector<T> shared_vector(std::size_t size) {
+        return SharedVector<T>(this->vector<T>(size));
+    }
+    template <typename PointT = Point3<float>>
+    PointCloud<PointCloudBase<PointT>> point_cloud(uint32_t width, uint32_t height = 1) {
+        return PointCloud<PointCloudBase<PointT>>(this->point_cloud_base<PointT>(width, height));
+    }
+    template <typename T>
+    Image<T, SharedVector> image(const Shape<uint32_t>& shape) {
+        return Image<T, SharedVector>(shape, this->shared_vector<T>(shape.area()));
+    }
+
+    /**
+     * Adds count newly allocated buffers of the given size to the pool (within
+     * the memory cap).
+     */
+    template <typename T>
+    void preallocate_vectors(std::size_t size, std::size_t count);
+    template <typename PointT = Point3<float>>
+    void preallocate_point_clouds(uint32_t width, uint32_t height, std::size_t count);
+
+    void        set_max_cached_bytes(std::size_t maxBytes);
+    std::size_t max_cached_bytes() const;
+    // Frees all idle buffers.
+    void  clear();
+    Stats stats() const;
+};
+
+template <typename T, class CreateF>
+Handle<T> BufferPool::acquire(std::size_t size, CreateF&& create)
+{
+    T* object = static_cast<T*>(this->take(Key({typeid(T), size})));
+    if(!object)
+        object = create();
+
+    WeakHandle<BufferPool> pool = this->shared_from_this();
+    return Handle<T>(object, [pool](T* object) {
+        if(auto p = pool.lock()) {
+            p->give(Key({typeid(T), details::pooled_size(*object)}), object,
+                    details::pooled_bytes(*object), &details::pooled_delete<T>);
+        }
+        else {
+            delete object;
+        }
+    });
+}
+
+template <typename T>
+Handle<std::vector<T>> BufferPool::vector(std::size_t size)
+{
+    return this->acquire<std::vector<T>>(size, [size]() {
+        return new std::vector<T>(size);
+    });
+}
+
+template <typename PointT>
+typename PointCloudBase<PointT>::Ptr BufferPool::point_cloud_base(uint32_t width, uint32_t height)
+{
+    auto res = this->acquire<PointCloudBase<PointT>>((std::size_t)width*height,
+        [width, height]() { return new PointCloudBase<PointT>(width, height); });
+    // Restoring the state of a new point cloud.
+    res->width               = width;
+    res->height              = height;
+    res->sensor_origin_      = Vector4<float>(0,0,0,0);
+    res->sensor_orientation_ = Quaternion<float>(1,0,0,0);
+    return res;
+}
+
+template <typename T>
+void BufferPool::preallocate_vectors(std::size_t size, std::size_t count)
+{
+    for(std::size_t i = 0; i < count; i++) {
+        auto object = new std::vector<T>(size);
+        this->give(Key({typeid(std::vector<T>), size}), object,
+                   details::pooled_bytes(*object), &details::pooled_delete<std::vector<T>>,
+                   false);
+    }
+}
+
+template <typename PointT>
+void BufferPool::preallocate_point_clouds(uint32_t width, uint32_t height, std::size_t count)
+{
+    using CloudT = PointCloudBase<PointT>;
+    for(std::size_t i = 0; i < count; i++) {
+        auto object = new CloudT(width, height);
+        this->give(Key({typeid(CloudT), object->points.size()}), object,
+                   details::pooled_bytes(*object), &details::pooled_delete<CloudT>, false);
+    }
+}
+
+}; //namespace types
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::types::BufferPoolStats& stats);
+
+#endif //_DEF_RTAC_BASE_TYPES_BUFFER_POOL_H_
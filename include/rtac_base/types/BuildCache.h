@@ -0,0 +1,170 @@
+#ifndef _DEF_RTAC_BASE_TYPES_BUILD_CACHE_H_
+#define _DEF_RTAC_BASE_TYPES_BUILD_CACHE_H_
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include <rtac_base/types/Handle.h>
+#include <rtac_base/types/BuildTarget.h>
+
+namespace rtac { namespace types {
+
+/**
+ * Read-only memory mapping of a file (unmapped when destroyed).
+ */
+class MappedFile
+{
+    public:
+
+    using Ptr      = Handle<MappedFile>;
+    using ConstPtr = Handle<const MappedFile>;
+
+    protected:
+
+    void*       mapping_;
+    std::size_t mappingSize_;
+    std::size_t offset_;
+
+    MappedFile(void* mapping, std::size_t mappingSize, std::size_t offset);
+
+    public:
+
+    // Returns nullptr if the file cannot be opened or mapped, or is smaller
+    // than offset.
+    static Ptr Create(const std::string& path, std::size_t offset = 0);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // whole file
+    const uint8_t* mapping()      const { return (const uint8_t*)mapping_; }
+    std::size_t    mapping_size() const { return mappingSize_;             }
+    // file data after offset
+    const uint8_t* data() const { return (const uint8_t*)mapping_ + offset_; }
+    std::size_t    size() const { return mappingSize_ - offset_;            }
+};
+
+/**
+ * On-disk cache of build outputs, keyed by a 64 bits hash.
+ *
+ * Each entry is stored in a separate file of the cache directory. Entries are
+ * written to a temporary file then renamed, so concurrent processes sharing
+ * the cache never see a partially written entry. Cached data is read through
+ * a read-only memory mapping (no copy is made unless the reader makes one).
+ *
+ * When the total size of the entries exceeds the size budget, the least
+ * recently used entries are removed (file modification time is updated on
+ * each hit). The directory is only scanned when a running total of the
+ * entries stored since the last scan goes over budget, so entries written by
+ * other processes are accounted for at the next scan.
+ *
+ * Filesystem errors (e.g. the cache directory was removed) are not reported
+ * as exceptions : a failed store returns false and a missing entry is a miss.
+ */
+class BuildCache
+{
+    public:
+
+    using Ptr      = Handle<BuildCache>;
+    using ConstPtr = Handle<const BuildCache>;
+
+    static constexpr uint64_t    Magic      = 0x3130434243415452; // "RTACBC01"
+    static constexpr std::size_t HeaderSize = 32;
+
+    protected:
+
+    std::string directory_;
+    std::size_t sizeBudget_;
+    std::size_t sizeEstimate_; // size at last scan + size stored since then
+    std::mutex  mutex_; // serializes evictions
+
+    mutable std::atomic<uint64_t> hits_;
+    mutable std::atomic<uint64_t> misses_;
+
+    BuildCache(const std::string& directory, std::size_t sizeBudget);
+
+    std::string entry_path(uint64_t key) const;
+    void        evict_locked();
+
+    public:
+
+    static Ptr Create(const std::string& directory,
+                      std::size_t sizeBudget = std::size_t(1) << 30);
+
+    const std::string& directory()   const { return directory_;  }
+    std::size_t        size_budget() const { return sizeBudget_; }
+    void set_size_budget(std::size_t budget);
+
+    MappedFile::ConstPtr load(uint64_t key) const;
+    bool store(uint64_t key, const void* data, std::size_t size);
+    void remove(uint64_t key);
+    void clear();
+    void evict();
+
+    std::size_t size() const;
+    uint64_t hits()   const { return hits_;   }
+    uint64_t misses() const { return misses_; }
+    void reset_counters() { hits_ = 0; misses_ = 0; }
+
+    // FNV-1a hash, to help build targets hashing their parameters.
+    static uint64_t hash(const void* data, std::size_t size,
+                         uint64_t seed = 0xcbf29ce484222325);
+    template <typename T>
+    static uint64_t hash(const T& value, uint64_t seed = 0xcbf29ce484222325) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "Only trivially copyable types can be hashed this way");
+        return hash(&value, sizeof(T), seed);
+    }
+    static uint64_t hash(const std::string& str, uint64_t seed = 0xcbf29ce484222325) {
+        return hash(str.data(), str.size(), seed);
+    }
+};
+
+/**
+ * BuildTarget whose output can be stored in a BuildCache.
+ *
+ * Subclasses implement parameters_hash, which must change whenever the build
+ * output would change, and the serialize / deserialize hooks. When a cache is
+ * set, build() first looks for an entry matching the parameters hash (and the
+ * target name, see cache_key). On a hit, deserialize is called instead of do_build. On a
+ * miss, do_build is called and its output serialized into the cache.
+ *
+ * deserialize receives the memory mapped cache entry. The target may keep
+ * the handle to use the mapped data directly instead of copying it. It
+ * returns false if the entry cannot be used, in which case do_build is
+ * called.
+ */
+class CachedBuildTarget : public BuildTarget
+{
+    public:
+
+    using Ptr      = Handle<CachedBuildTarget>;
+    using ConstPtr = Handle<const CachedBuildTarget>;
+
+    protected:
+
+    BuildCache::Ptr cache_;
+
+    CachedBuildTarget(const Dependencies& deps = Dependencies(0)) : BuildTarget(deps) {}
+
+    virtual uint64_t parameters_hash() const = 0;
+    virtual void serialize(std::vector<uint8_t>& data) const = 0;
+    virtual bool deserialize(const MappedFile::ConstPtr& data) const = 0;
+
+    void build_output() const override;
+
+    public:
+
+    void set_cache(const BuildCache::Ptr& cache) { cache_ = cache; }
+    const BuildCache::Ptr& cache() const { return cache_; }
+    uint64_t cache_key() const;
+};
+
+}; //namespace types
+}; //namespace rtac
+
+#endif //_DEF_RTAC_BASE_TYPES_BUILD_CACHE_H_
@@ -0,0 +1,98 @@
+#ifndef _DEF_RTAC_BASE_TYPES_BUILD_PROFILER_H_
+#define _DEF_RTAC_BASE_TYPES_BUILD_PROFILER_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <rtac_base/types/Handle.h>
+
+namespace rtac { namespace types {
+
+class BuildTarget;
+
+/**
+ * Records the do_build calls of BuildTarget objects (duration, thread, and
+ * the target which caused the rebuild).
+ *
+ * Profiling is opt-in : events are recorded only while a profiler is started,
+ * and at most one profiler is active at a time. When no profiler is active,
+ * the cost per build is a single atomic load.
+ *
+ * The rebuild cause of a target is the dependency whose version change
+ * invalidated it, or the target itself if its build parameters were changed
+ * (see BuildTarget::bump_version).
+ *
+ * Events can be exported in the Chrome trace event format (viewable in
+ * chrome://tracing or https://ui.perfetto.dev) or summarized per target.
+ */
+class BuildProfiler
+{
+    public:
+
+    using Ptr      = Handle<BuildProfiler>;
+    using ConstPtr = Handle<const BuildProfiler>;
+    using Clock    = std::chrono::steady_clock;
+
+    struct Event {
+        std::string  target;
+        std::string  cause;
+        unsigned int thread;
+        double       start;    // seconds since profiler start
+        double       duration; // seconds
+    };
+
+    struct Stats {
+        std::string  target;
+        unsigned int count = 0;
+        double       total = 0.0;
+        double       mean  = 0.0;
+        double       max   = 0.0;
+        std::map<std::string, unsigned int> causes;
+    };
+
+    protected:
+
+    static std::atomic<BuildProfiler*> active_;
+
+    Clock::time_point  t0_;
+    std::vector<Event> events_;
+    std::map<std::thread::id, unsigned int> threads_;
+    mutable std::mutex mutex_;
+
+    BuildProfiler();
+
+    public:
+
+    static Ptr Create();
+    ~BuildProfiler();
+
+    static BuildProfiler* active() {
+        return active_.load(std::memory_order_acquire);
+    }
+
+    void start();
+    void stop();
+    void clear();
+
+    void record(const BuildTarget& target, const BuildTarget* cause,
+                Clock::time_point start, Clock::time_point end);
+
+    std::vector<Event> events() const;
+    std::vector<Stats> stats()  const;
+
+    void write_chrome_trace(std::ostream& os) const;
+    std::ostream& print(std::ostream& os) const;
+};
+
+}; //namespace types
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::types::BuildProfiler& profiler);
+
+#endif //_DEF_RTAC_BASE_TYPES_BUILD_PROFILER_H_
@@ -0,0 +1,75 @@
+#ifndef _DEF_RTAC_BASE_TYPES_BUILD_SCHEDULER_H_
+#define _DEF_RTAC_BASE_TYPES_BUILD_SCHEDULER_H_
+
+#include <vector>
+#include <exception>
+
+#include <rtac_base/types/Handle.h>
+#include <rtac_base/types/Executor.h>
+#include <rtac_base/types/BuildTarget.h>
+
+namespace rtac { namespace types {
+
+/**
+ * Builds a BuildTarget and its dependencies concurrently.
+ *
+ * BuildTarget::build walks the dependency tree recursively and builds the
+ * dependencies one after the other. The scheduler first collects the targets
+ * needing a build (the dirty subgraph) and sorts them topologically. A target
+ * is then built on the executor threads as soon as all of its dirty
+ * dependencies are built, so independent targets are built concurrently.
+ * Each target is built exactly once, even if it is shared by several
+ * dependents.
+ *
+ * Targets are built with the same steps as BuildTarget::build (clean,
+ * dependencies acknowledgement, do_build). A subclass overriding build() will
+ * have its override ignored by the scheduler.
+ *
+ * If some do_build calls throw, the targets coming before the earliest known
+ * failure in the serial build order are still built, no target coming after
+ * it is started, and the exception of the earliest failed target in the
+ * serial build order is rethrown. If do_build fails deterministically, this
+ * is the exception a serial build would have thrown, regardless of thread
+ * timing. Failed targets and the targets depending on them still need a
+ * build.
+ *
+ * The calling thread waits for the build to complete, so build must not be
+ * called from a task running on the scheduler executor.
+ */
+class BuildScheduler
+{
+    public:
+
+    using Ptr      = Handle<BuildScheduler>;
+    using ConstPtr = Handle<const BuildScheduler>;
+
+    protected:
+
+    struct Node {
+        const BuildTarget*        target;
+        std::vector<unsigned int> dependents;
+        unsigned int              pending; // dirty dependencies not yet built
+        std::exception_ptr        error;
+    };
+
+    Executor::Ptr executor_;
+
+    BuildScheduler(const Executor::Ptr& executor);
+
+    static void collect_dirty(const BuildTarget& target, std::vector<Node>& nodes);
+
+    public:
+
+    static Ptr Create(unsigned int threadCount = 0);
+    static Ptr Create(const Executor::Ptr& executor);
+
+    const Executor::Ptr& executor() const { return executor_; }
+
+    void build(const BuildTarget& target) const;
+    void build(const BuildTarget::ConstPtr& target) const { this->build(*target); }
+};
+
+}; //namespace types
+}; //namespace rtac
+
+#endif //_DEF_RTAC_BASE_TYPES_BUILD_SCHEDULER_H_
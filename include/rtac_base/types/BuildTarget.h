@@ -2,7 +2,10 @@
 #define _DEF_RTAC_BASE_TYPES_BUILD_TARGET_H_
 
 #include <iostream>
+#include <string>
 #include <vector>
+#include <atomic>
+#include <cstdint>
 
 #include <rtac_base/types/Handle.h>
 
@@ -31,6 +34,7 @@ namespace rtac { namespace types {
 // behavior should be transparent for the child targets.
 
 class BuildTarget;
+class BuildScheduler;
 
 class BuildTargetHandle
 {
@@ -76,12 +80,44 @@ class BuildTarget
     mutable unsigned int version_;
     mutable Dependencies dependencies_;
 
+    // Reverse edges of the dependency graph. Invalidation is pushed to the
+    // dependents when the version of a target is bumped, so needs_build does
+    // not have to walk the dependency tree. The dependencies must therefore
+    // only be added with add_dependency (or at construction).
+    mutable std::vector<const BuildTarget*> dependents_;
+    // Graph traversal marker (see next_generation).
+    mutable uint64_t                        visited_;
+    // Target whose change made this target dirty (this if its own build
+    // parameters changed, nullptr before the first build). Only used for
+    // profiling (see BuildProfiler).
+    mutable const BuildTarget*              cause_;
+
     // to_build and clean methods are to be reimplemented in subclasses.
     virtual void do_build() const = 0;
 
     BuildTarget(const Dependencies& deps = Dependencies(0));
+    BuildTarget(const BuildTarget& other);
+    BuildTarget& operator=(const BuildTarget& other);
+
+    void register_dependency(const BuildTargetHandle& dep) const;
+    void unregister_dependencies() const;
+    void invalidate_dependents() const;
+    static uint64_t next_generation();
+
+    // Produces the build output. Calls do_build by default (can be
+    // reimplemented to get the output from somewhere else, see
+    // CachedBuildTarget).
+    virtual void build_output() const { this->do_build(); }
+    // Calls build_output, recording it if a BuildProfiler is active.
+    void profiled_build() const;
+
+    // Builds this target only, assuming its dependencies are up to date.
+    friend class BuildScheduler;
+    void build_node() const;
 
     public:
+
+    virtual ~BuildTarget();
     
     bool needs_build() const;
     unsigned int version() const;
@@ -96,6 +132,9 @@ class BuildTarget
 
     virtual void build() const;
     virtual void clean() const {} // no cleanup by default;
+
+    // Name used in BuildProfiler reports (demangled type name by default).
+    virtual std::string target_name() const;
 };
 
 }; //namespace types
@@ -5,9 +5,23 @@
 #include <unordered_map>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <tuple>
+#include <future>
+#include <optional>
+#include <chrono>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
 
 #include <thread>
 
+#include <rtac_base/types/Handle.h>
+#include <rtac_base/types/Executor.h>
+
 namespace rtac { namespace types {
 
 template <class ...ArgTypes>
@@ -16,57 +30,396 @@ class CallbackQueue
     // Thread safe callback handler
     // /!\ call order not guarantied !
 
+    // The registered callbacks are published as immutable snapshots (RCU
+    // style). add_callback and remove_callback build a new snapshot and
+    // publish it atomically, while call() only reads the current snapshot.
+    // This way, call() never allocates and never locks.
+    //
+    // Snapshots are stored in a fixed set of slots. The state_ word holds the
+    // index of the current slot in its high bits and the number of readers
+    // which entered this slot in its low bits. A reader enters the current
+    // slot with a single fetch_add on state_, and leaves it by incrementing
+    // the slot exit counter (both are wait-free). When a snapshot is replaced,
+    // the writer records how many readers entered the old slot. The slot can
+    // be reused once as many readers exited it. Slots are only reclaimed by
+    // writers, so readers never free anything.
+    //
+    // Asynchronous callbacks (see add_async_callback) are registered as
+    // regular callbacks which only push the call arguments into a bounded
+    // queue owned by the subscriber. The queue is drained by an Executor, so
+    // a slow subscriber does not delay call() nor the other subscribers.
+
     public:
 
     using CallbackId    = unsigned int;
     using CallbackT     = std::function<void(ArgTypes...)>;
     using CallbackDict  = std::unordered_map<CallbackId, CallbackT>;
+    using ArgsTuple     = std::tuple<std::decay_t<ArgTypes>...>;
+
+    /**
+     * Behavior of call() when the queue of an asynchronous subscriber is full.
+     *
+     * - Block      : call() waits until the subscriber pops an element.
+     * - DropOldest : the oldest pending call is discarded.
+     * - KeepLatest : all pending calls are discarded, only the latest one is
+     *                kept (the queue capacity is ignored).
+     */
+    enum class AsyncPolicy {
+        Block,
+        DropOldest,
+        KeepLatest
+    };
+
+    struct AsyncOptions {
+        AsyncPolicy   policy   = AsyncPolicy::Block;
+        std::size_t   capacity = 16;
+        // Executor draining the queue. A dedicated thread is created for the
+        // subscriber if null. Calls of a single subscriber are never run
+        // concurrently, even on a multi-threaded executor.
+        Executor::Ptr executor = nullptr;
+    };
+
+    // Latencies are measured between the call() and the moment the
+    // subscriber callback is started.
+    struct AsyncStats {
+        std::size_t depth     = 0; // number of pending calls
+        std::size_t maxDepth  = 0;
+        uint64_t    processed = 0;
+        uint64_t    dropped   = 0;
+        uint64_t    errors    = 0; // number of exceptions thrown by the callback
+        double      meanLatency = 0.0; // seconds
+        double      maxLatency  = 0.0; // seconds
+    };
 
     // deleted functions to prevent copy
     CallbackQueue(const CallbackQueue&) = delete;
     CallbackQueue& operator=(const CallbackQueue&) = delete;
 
+    static constexpr unsigned int SlotCount = 16;
+
     protected:
-    
-    CallbackDict       callbacks_;
-    mutable std::mutex mutex_;
+
+    static constexpr unsigned int SlotShift = 56;
+    static constexpr uint64_t     CountMask = (uint64_t(1) << SlotShift) - 1;
+
+    struct Snapshot {
+        CallbackDict                  callbacks;
+        mutable std::atomic<uint64_t> exits{0};
+        uint64_t                      enters  = 0;
+        bool                          retired = false;
+    };
+
+    // Exits a snapshot when going out of scope (even if a callback throws).
+    struct SnapshotReader {
+        const CallbackQueue& queue;
+        const Snapshot&      snapshot;
+
+        SnapshotReader(const CallbackQueue& q) : queue(q), snapshot(q.enter_snapshot()) {}
+        ~SnapshotReader() { queue.exit_snapshot(snapshot); }
+    };
+
+    mutable Snapshot              snapshots_[SlotCount];
+    mutable std::atomic<uint64_t> state_;
+    mutable std::mutex            mutex_; // serializes writers
 
     CallbackDict            singleShots_;
     std::mutex              sShotsMutex_;
     std::condition_variable sShotsCv_;
     bool                    sShotsCalled_;
+    std::atomic<unsigned int> sShotsCount_;
+    // Promises of next_call() waiters, by id. Guarded by sShotsMutex_.
+    std::vector<std::pair<uint64_t, std::promise<ArgsTuple>>> sShotsPromises_;
+    uint64_t                                                  sShotsNextId_;
+
+    class AsyncSubscriber;
+    std::unordered_map<CallbackId, Handle<AsyncSubscriber>> asyncSubscribers_; // guarded by mutex_
+
+    const Snapshot& enter_snapshot() const;
+    void exit_snapshot(const Snapshot& snapshot) const;
+    unsigned int free_slot();
+    void publish(unsigned int slot);
+    std::future<ArgsTuple> add_promise(uint64_t& id);
 
     public:
 
-    CallbackQueue() {}
+    CallbackQueue();
+    ~CallbackQueue();
 
     unsigned int callback_count() const;
 
     CallbackId add_callback(const CallbackT& callback);
     bool remove_callback(CallbackId index);
-    
+
+    CallbackId add_async_callback(const CallbackT& callback,
+                                  const AsyncOptions& options = AsyncOptions());
+    AsyncStats async_stats(CallbackId index) const;
+
     bool add_single_shot(const CallbackT& callback);
+    std::future<ArgsTuple> next_call();
+    template <class Rep, class Period>
+    std::optional<ArgsTuple> wait_next_call(const std::chrono::duration<Rep,Period>& timeout);
 
     void call(ArgTypes... args);
 };
 
+/**
+ * Bounded queue of pending calls for an asynchronous callback.
+ *
+ * At most one drain task is posted on the executor at any time. The drain
+ * task pops and runs the pending calls until the queue is empty. This
+ * serializes the calls of the subscriber and preserves their order.
+ *
+ * The call arguments are stored by value. They are moved into the queue and
+ * moved again into the callback (by-value arguments are not copied).
+ */
+template <class ...ArgTypes>
+class CallbackQueue<ArgTypes...>::AsyncSubscriber
+    : public std::enable_shared_from_this<AsyncSubscriber>
+{
+    public:
+
+    using Clock      = std::chrono::steady_clock;
+
+    protected:
+
+    struct Item {
+        ArgsTuple         args;
+        Clock::time_point stamp;
+    };
+
+    CallbackT    callback_;
+    AsyncOptions options_;
+
+    mutable std::mutex      mutex_;
+    std::condition_variable notFull_;
+    std::deque<Item>        items_;
+    bool                    draining_;
+    bool                    closed_;
+    AsyncStats              stats_;
+
+    template <std::size_t... Is>
+    void invoke(ArgsTuple& args, std::index_sequence<Is...>) {
+        // forward restores the declared argument types : by-value arguments
+        // are moved, references bind to the stored values.
+        callback_(std::forward<ArgTypes>(std::get<Is>(args))...);
+    }
+
+    void drain();
+
+    public:
+
+    AsyncSubscriber(const CallbackT& callback, const AsyncOptions& options);
+
+    void push(ArgsTuple&& args);
+    void close();
+
+    AsyncStats stats() const;
+};
+
+template <class ...ArgTypes>
+CallbackQueue<ArgTypes...>::AsyncSubscriber::AsyncSubscriber(
+        const CallbackT& callback, const AsyncOptions& options) :
+    callback_(callback),
+    options_(options),
+    draining_(false),
+    closed_(false)
+{
+    if(options_.capacity == 0)
+        options_.capacity = 1;
+    if(!options_.executor)
+        options_.executor = ThreadExecutor::Create(1);
+}
+
+template <class ...ArgTypes>
+void CallbackQueue<ArgTypes...>::AsyncSubscriber::push(ArgsTuple&& args)
+{
+    bool schedule = false;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        switch(options_.policy) {
+            case AsyncPolicy::Block:
+                notFull_.wait(lock, [&]{
+                    return closed_ || items_.size() < options_.capacity; });
+                break;
+            case AsyncPolicy::DropOldest:
+                for(; items_.size() >= options_.capacity; stats_.dropped++) {
+                    items_.pop_front();
+                }
+                break;
+            case AsyncPolicy::KeepLatest:
+                stats_.dropped += items_.size();
+                items_.clear();
+                break;
+        }
+        if(closed_)
+            return;
+
+        items_.push_back(Item({std::move(args), Clock::now()}));
+        stats_.depth    = items_.size();
+        stats_.maxDepth = std::max(stats_.maxDepth, stats_.depth);
+        if(!draining_) {
+            draining_ = true;
+            schedule  = true;
+        }
+    }
+    if(schedule) {
+        auto self = this->shared_from_this();
+        options_.executor->post([self]() { self->drain(); });
+    }
+}
+
+template <class ...ArgTypes>
+void CallbackQueue<ArgTypes...>::AsyncSubscriber::drain()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(!closed_ && !items_.empty()) {
+        Item item = std::move(items_.front());
+        items_.pop_front();
+        stats_.depth = items_.size();
+        lock.unlock();
+        notFull_.notify_one();
+
+        double latency = std::chrono::duration<double>(Clock::now() - item.stamp).count();
+        bool failed = false;
+        try {
+            this->invoke(item.args, std::index_sequence_for<ArgTypes...>());
+        }
+        catch(...) {
+            failed = true;
+        }
+
+        lock.lock();
+        stats_.processed++;
+        if(failed) stats_.errors++;
+        stats_.meanLatency += (latency - stats_.meanLatency) / stats_.processed;
+        stats_.maxLatency   = std::max(stats_.maxLatency, latency);
+    }
+    draining_ = false;
+}
+
+/**
+ * Discards pending calls and unblocks waiting publishers. No new call is
+ * started after close() returns, but a call already running is not waited
+ * for (the callback may be closing its own subscription).
+ */
+template <class ...ArgTypes>
+void CallbackQueue<ArgTypes...>::AsyncSubscriber::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        stats_.dropped += items_.size();
+        items_.clear();
+        stats_.depth = 0;
+    }
+    notFull_.notify_all();
+}
+
+template <class ...ArgTypes>
+typename CallbackQueue<ArgTypes...>::AsyncStats
+CallbackQueue<ArgTypes...>::AsyncSubscriber::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+template <class ...ArgTypes>
+CallbackQueue<ArgTypes...>::CallbackQueue() :
+    state_(0),
+    sShotsCalled_(false),
+    sShotsCount_(0),
+    sShotsNextId_(0)
+{}
+
+template <class ...ArgTypes>
+CallbackQueue<ArgTypes...>::~CallbackQueue()
+{
+    for(auto& item : asyncSubscribers_) {
+        item.second->close();
+    }
+}
+
+/**
+ * Registers the caller as a reader of the current snapshot. Wait-free.
+ */
+template <class ...ArgTypes>
+const typename CallbackQueue<ArgTypes...>::Snapshot&
+CallbackQueue<ArgTypes...>::enter_snapshot() const
+{
+    uint64_t state = state_.fetch_add(1, std::memory_order_acquire);
+    return snapshots_[state >> SlotShift];
+}
+
+template <class ...ArgTypes>
+void CallbackQueue<ArgTypes...>::exit_snapshot(const Snapshot& snapshot) const
+{
+    snapshot.exits.fetch_add(1, std::memory_order_release);
+}
+
+/**
+ * Finds a slot which is neither current nor still used by a reader. Must be
+ * called with mutex_ locked.
+ *
+ * If all slots are in use (readers blocked in callbacks for SlotCount
+ * successive snapshot updates), this waits for a reader to exit.
+ */
+template <class ...ArgTypes>
+unsigned int CallbackQueue<ArgTypes...>::free_slot()
+{
+    unsigned int current = state_.load(std::memory_order_relaxed) >> SlotShift;
+    while(true) {
+        for(unsigned int i = 1; i < SlotCount; i++) {
+            auto& slot = snapshots_[(current + i) % SlotCount];
+            if(!slot.retired
+               || slot.exits.load(std::memory_order_acquire) == slot.enters) {
+                return (current + i) % SlotCount;
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+/**
+ * Makes the slot the current snapshot and retires the previous one. Must be
+ * called with mutex_ locked.
+ */
+template <class ...ArgTypes>
+void CallbackQueue<ArgTypes...>::publish(unsigned int slot)
+{
+    snapshots_[slot].exits.store(0, std::memory_order_relaxed);
+    snapshots_[slot].retired = false;
+
+    uint64_t previous = state_.exchange(uint64_t(slot) << SlotShift,
+                                        std::memory_order_acq_rel);
+    auto& old  = snapshots_[previous >> SlotShift];
+    old.enters  = previous & CountMask;
+    old.retired = true;
+}
+
 template <class ...ArgTypes>
 unsigned int CallbackQueue<ArgTypes...>::callback_count() const
 {
-    return callbacks_.size() + singleShots_.size();
+    SnapshotReader reader(*this);
+    return reader.snapshot.callbacks.size() + sShotsCount_.load();
 }
 
 template <class ...ArgTypes>
-typename CallbackQueue<ArgTypes...>::CallbackId 
+typename CallbackQueue<ArgTypes...>::CallbackId
 CallbackQueue<ArgTypes...>::add_callback(const CallbackT& callback)
 {
     const std::lock_guard<std::mutex> lock(mutex_); // will release mutex when out of scope
 
+    const auto& current = snapshots_[state_.load(std::memory_order_relaxed) >> SlotShift];
+    unsigned int slot = this->free_slot();
+    snapshots_[slot].callbacks = current.callbacks;
+    auto& callbacks = snapshots_[slot].callbacks;
+
     // finding index value not already used
-    CallbackId newId = callbacks_.size();
-    for(; callbacks_.find(newId) != callbacks_.end(); newId++);
+    CallbackId newId = callbacks.size();
+    for(; callbacks.find(newId) != callbacks.end(); newId++);
 
-    callbacks_[newId] = callback;
+    callbacks[newId] = callback;
+    this->publish(slot);
     return newId;
 }
 
@@ -74,7 +427,68 @@ template <class ...ArgTypes>
 bool CallbackQueue<ArgTypes...>::remove_callback(CallbackId index)
 {
     const std::lock_guard<std::mutex> lock(mutex_); // will release mutex when out of scope
-    return callbacks_.erase(index) > 0;
+
+    const auto& current = snapshots_[state_.load(std::memory_order_relaxed) >> SlotShift];
+    if(current.callbacks.find(index) == current.callbacks.end())
+        return false;
+
+    unsigned int slot = this->free_slot();
+    snapshots_[slot].callbacks = current.callbacks;
+    snapshots_[slot].callbacks.erase(index);
+    this->publish(slot);
+
+    auto subscriber = asyncSubscribers_.find(index);
+    if(subscriber != asyncSubscribers_.end()) {
+        subscriber->second->close();
+        asyncSubscribers_.erase(subscriber);
+    }
+    return true;
+}
+
+/**
+ * Registers a callback which is run asynchronously on an Executor instead of
+ * in the thread calling call(). The call arguments are queued in a bounded
+ * per-subscriber queue (see AsyncOptions and AsyncPolicy).
+ *
+ * The returned id can be used with remove_callback and async_stats.
+ */
+template <class ...ArgTypes>
+typename CallbackQueue<ArgTypes...>::CallbackId
+CallbackQueue<ArgTypes...>::add_async_callback(const CallbackT& callback,
+                                               const AsyncOptions& options)
+{
+    auto subscriber = std::make_shared<AsyncSubscriber>(callback, options);
+
+    // The subscriber is registered before the callback is published so that
+    // async_stats is valid as soon as the id is returned.
+    const std::lock_guard<std::mutex> lock(mutex_);
+
+    const auto& current = snapshots_[state_.load(std::memory_order_relaxed) >> SlotShift];
+    unsigned int slot = this->free_slot();
+    snapshots_[slot].callbacks = current.callbacks;
+    auto& callbacks = snapshots_[slot].callbacks;
+
+    CallbackId newId = callbacks.size();
+    for(; callbacks.find(newId) != callbacks.end(); newId++);
+
+    callbacks[newId] = [subscriber](ArgTypes... args) {
+        subscriber->push(ArgsTuple(std::forward<ArgTypes>(args)...));
+    };
+    asyncSubscribers_[newId] = subscriber;
+    this->publish(slot);
+    return newId;
+}
+
+/**
+ * Queue depth, drop count and latency statistics of an asynchronous callback.
+ * Throws std::out_of_range if index is not an asynchronous callback.
+ */
+template <class ...ArgTypes>
+typename CallbackQueue<ArgTypes...>::AsyncStats
+CallbackQueue<ArgTypes...>::async_stats(CallbackId index) const
+{
+    const std::lock_guard<std::mutex> lock(mutex_);
+    return asyncSubscribers_.at(index)->stats();
 }
 
 template <class ...ArgTypes>
@@ -91,41 +505,99 @@ bool CallbackQueue<ArgTypes...>::add_single_shot(const CallbackT& callback)
     CallbackId callbackId = singleShots_.size();
     for(; singleShots_.find(callbackId) != singleShots_.end(); callbackId++);
     singleShots_[callbackId] = callback;
+    sShotsCount_++;
 
     sShotsCv_.wait(lock, [&]{return sShotsCalled_; });
-    
+
     return sShotsCalled_;
 }
 
+/**
+ * Non-blocking counterpart of add_single_shot. The returned future becomes
+ * ready at the next call() and holds a copy of the call arguments.
+ *
+ * Each waiter gets its own promise, so call() only wakes up the threads
+ * actually waiting on a future, and a single thread can poll many futures
+ * (with future::wait_for(0)) instead of blocking one thread per waiter.
+ */
+template <class ...ArgTypes>
+std::future<typename CallbackQueue<ArgTypes...>::ArgsTuple>
+CallbackQueue<ArgTypes...>::next_call()
+{
+    uint64_t id;
+    return this->add_promise(id);
+}
+
+template <class ...ArgTypes>
+std::future<typename CallbackQueue<ArgTypes...>::ArgsTuple>
+CallbackQueue<ArgTypes...>::add_promise(uint64_t& id)
+{
+    std::lock_guard<std::mutex> lock(sShotsMutex_);
+    id = sShotsNextId_++;
+    sShotsPromises_.emplace_back(id, std::promise<ArgsTuple>());
+    sShotsCount_++;
+    return sShotsPromises_.back().second.get_future();
+}
+
+/**
+ * Waits for the next call() for at most timeout. Returns the call arguments,
+ * or an empty optional if the timeout expired (the expired promise is
+ * removed, unless a call() already took it, in which case its arguments are
+ * returned).
+ */
+template <class ...ArgTypes> template <class Rep, class Period>
+std::optional<typename CallbackQueue<ArgTypes...>::ArgsTuple>
+CallbackQueue<ArgTypes...>::wait_next_call(const std::chrono::duration<Rep,Period>& timeout)
+{
+    uint64_t id;
+    auto future = this->add_promise(id);
+    if(future.wait_for(timeout) != std::future_status::ready) {
+        std::lock_guard<std::mutex> lock(sShotsMutex_);
+        auto it = std::find_if(sShotsPromises_.begin(), sShotsPromises_.end(),
+                               [id](const auto& item) { return item.first == id; });
+        if(it != sShotsPromises_.end()) {
+            sShotsPromises_.erase(it);
+            sShotsCount_--;
+            return std::nullopt;
+        }
+    }
+    return future.get();
+}
+
 template <class ...ArgTypes>
 void CallbackQueue<ArgTypes...>::call(ArgTypes... args)
 {
-    CallbackDict callbacks;
-    
+    // The snapshot is immutable while we are registered as a reader, so the
+    // callbacks can be called directly. This allows callbacks to modify this
+    // object (adding/removing callbacks...) without creating deadlocks.
     {
-        // Copying callbacks first allows to release the mutex while callbacks
-        // are called. This allows callbacks to modify this object (
-        // adding/removing callbacks...)  without creating deadlocks.
-        const std::lock_guard<std::mutex> lock(mutex_); // will release mutex when out of scope
-        callbacks = callbacks_;
-    }
-    
-    // calling regular callbacks
-    for(auto& item : callbacks) {
-        item.second(args...);
+        SnapshotReader reader(*this);
+        for(auto& item : reader.snapshot.callbacks) {
+            item.second(args...);
+        }
     }
 
-    // calling single shots
+    // calling single shots (the lock is only taken if some were registered).
+    if(sShotsCount_.load() == 0)
+        return;
+    std::vector<std::pair<uint64_t, std::promise<ArgsTuple>>> promises;
     {
         std::unique_lock<std::mutex> lock(sShotsMutex_);
         for(auto& item : singleShots_) {
             item.second(args...);
         }
         singleShots_.clear();
+        promises.swap(sShotsPromises_);
+        sShotsCount_ = 0;
         sShotsCalled_ = true;
     }
 
     sShotsCv_.notify_all();
+    // Fulfilled outside of the lock : a waiter woken up here may register
+    // again right away.
+    for(auto& promise : promises) {
+        promise.second.set_value(ArgsTuple(args...));
+    }
 }
 
 }; //namespace types
@@ -0,0 +1,88 @@
+#ifndef _DEF_RTAC_BASE_TYPES_EXECUTOR_H_
+#define _DEF_RTAC_BASE_TYPES_EXECUTOR_H_
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include <rtac_base/types/Handle.h>
+
+namespace rtac { namespace types {
+
+/**
+ * Minimal interface of an object running tasks asynchronously.
+ *
+ * Tasks are posted from any thread and are run at some later point on a
+ * thread owned by the executor. No ordering is guarantied between tasks by
+ * this interface (implementations may give stronger guaranties).
+ */
+class Executor
+{
+    public:
+
+    using Ptr      = Handle<Executor>;
+    using ConstPtr = Handle<const Executor>;
+    using Task     = std::function<void()>;
+
+    virtual ~Executor() = default;
+
+    virtual void post(Task&& task) = 0;
+};
+
+/**
+ * Executor running tasks on a fixed set of dedicated threads, in FIFO order.
+ *
+ * With a single thread, tasks are run one after the other in the order they
+ * were posted. Exceptions thrown by the tasks are caught and ignored so they
+ * cannot kill the worker threads.
+ *
+ * Tasks still pending when the executor is destroyed are discarded (tasks
+ * already running are waited for).
+ */
+class ThreadExecutor : public Executor
+{
+    public:
+
+    using Ptr      = Handle<ThreadExecutor>;
+    using ConstPtr = Handle<const ThreadExecutor>;
+
+    protected:
+
+    // The queue is shared with the workers so that a worker detached by the
+    // destructor (see ~ThreadExecutor) never accesses a destroyed object.
+    struct State {
+        std::deque<Task>        tasks;
+        std::mutex              mutex;
+        std::condition_variable cv;
+        bool                    stop = false;
+    };
+
+    Handle<State>            state_;
+    std::vector<std::thread> threads_;
+
+    ThreadExecutor(unsigned int threadCount);
+
+    static void run(Handle<State> state);
+
+    public:
+
+    static Ptr Create(unsigned int threadCount = 1);
+    ~ThreadExecutor();
+
+    // deleted functions to prevent copy
+    ThreadExecutor(const ThreadExecutor&) = delete;
+    ThreadExecutor& operator=(const ThreadExecutor&) = delete;
+
+    void post(Task&& task) override;
+
+    unsigned int thread_count() const { return threads_.size(); }
+    std::size_t  pending()      const;
+};
+
+}; //namespace types
+}; //namespace rtac
+
+#endif //_DEF_RTAC_BASE_TYPES_EXECUTOR_H_
@@ -0,0 +1,184 @@
+#ifndef _DEF_RTAC_BASE_TYPES_HOST_MAPPING_H_
+#define _DEF_RTAC_BASE_TYPES_HOST_MAPPING_H_
+
+#include <type_traits>
+
+#include <rtac_base/types/Handle.h>
+#include <rtac_base/types/Point.h>
+#include <rtac_base/types/TextureSampler2D.h>
+#include <rtac_base/FunctorCompound.h>
+#include <rtac_base/functors.h>
+
+namespace rtac { namespace types {
+
+/**
+ * Host side counterpart of rtac::cuda::DeviceMapping2D. The output value is
+ * fetched from a TextureSampler2D instead of a CUDA texture, which allows to
+ * evaluate mappings on machines without a GPU.
+ *
+ * Like their device counterparts, host mappings are regular functors and can
+ * be combined with other functors in a functors::FunctorCompound.
+ */
+template <typename T>
+struct HostMapping2D
+{
+    // Declaring input and output types to be compatible with other functors.
+    using InputT  = Point2<float>;
+    using OutputT = T;
+
+    TextureSampler2D<T> data;
+
+    T operator()(const Point2<float>& uv) const {
+        return data(uv.x, uv.y);
+    }
+};
+
+template <typename T>
+struct HostMapping1D
+{
+    // Declaring input and output types to be compatible with other functors.
+    using InputT  = float;
+    using OutputT = T;
+
+    TextureSampler2D<T> data;
+
+    T operator()(float u) const {
+        return data(u, 0.0f);
+    }
+};
+
+/**
+ * Deduces the full host map type depending on the given FunctorT (same as
+ * rtac::cuda::device_map_type).
+ */
+template <typename T, class FunctorT>
+struct host_map_type {
+    using FoutT = typename FunctorT::OutputT;
+
+    static_assert(std::is_same<float, FoutT>::value || std::is_same<Point2<float>, FoutT>::value,
+                  "For a HostMapping type, the output type of the optional functor must be either float or Point2<float>");
+
+    using BaseHostMapT = typename std::conditional<std::is_same<float, FoutT>::value,
+                                                   HostMapping1D<T>,
+                                                   HostMapping2D<T>>::type;
+
+    using type = functors::FunctorCompound<BaseHostMapT, FunctorT>;
+};
+
+/**
+ * Host side equivalent of rtac::cuda::Mapping. Holds a TextureSampler2D and an
+ * additional functor performing an operation on the input coordinates before
+ * the texture fetch.
+ */
+template <typename T, class FunctorT = functors::IdentityFunctor<Point2<float>>>
+class HostMapping
+{
+    public:
+
+    using Ptr          = Handle<HostMapping>;
+    using ConstPtr     = Handle<const HostMapping>;
+    using Sampler      = TextureSampler2D<T>;
+    using InputT       = typename FunctorT::InputT;
+    using BaseHostMapT = typename host_map_type<T, FunctorT>::BaseHostMapT;
+    using HostMap      = typename host_map_type<T, FunctorT>::type;
+
+    protected:
+
+    Sampler  data_;
+    FunctorT f_;
+
+    HostMapping() {}
+    HostMapping(const Sampler& data) : data_(data) {}
+    HostMapping(const Sampler& data, const FunctorT& f) : data_(data), f_(f) {}
+
+    public:
+
+    static Ptr Create(const Sampler& data);
+    static Ptr Create(const Sampler& data, const FunctorT& f);
+
+    void set_sampler(const Sampler& sampler);
+    void set_functor(const FunctorT& f);
+
+    const Sampler&  sampler() const;
+    const FunctorT& functor() const;
+
+    HostMap host_map() const;
+
+    void map(const InputT* input, T* output, std::size_t count) const;
+};
+
+template <typename T, class FunctorT>
+typename HostMapping<T,FunctorT>::Ptr
+HostMapping<T,FunctorT>::Create(const Sampler& data)
+{
+    return Ptr(new HostMapping<T,FunctorT>(data));
+}
+
+template <typename T, class FunctorT>
+typename HostMapping<T,FunctorT>::Ptr
+HostMapping<T,FunctorT>::Create(const Sampler& data, const FunctorT& f)
+{
+    return Ptr(new HostMapping<T,FunctorT>(data, f));
+}
+
+template <typename T, class FunctorT>
+void HostMapping<T,FunctorT>::set_sampler(const Sampler& sampler)
+{
+    data_ = sampler;
+}
+
+template <typename T, class FunctorT>
+void HostMapping<T,FunctorT>::set_functor(const FunctorT& f)
+{
+    f_ = f;
+}
+
+template <typename T, class FunctorT>
+const TextureSampler2D<T>& HostMapping<T,FunctorT>::sampler() const
+{
+    return data_;
+}
+
+template <typename T, class FunctorT>
+const FunctorT& HostMapping<T,FunctorT>::functor() const
+{
+    return f_;
+}
+
+template <typename T, class FunctorT>
+typename HostMapping<T,FunctorT>::HostMap HostMapping<T,FunctorT>::host_map() const
+{
+    return HostMap(BaseHostMapT({data_}), f_);
+}
+
+/**
+ * Batched evaluation of the mapping. Texture coordinates are computed by the
+ * functor, then fetched using TextureSampler2D::fetch.
+ */
+template <typename T, class FunctorT>
+void HostMapping<T,FunctorT>::map(const InputT* input, T* output,
+                                  std::size_t count) const
+{
+    constexpr unsigned int BatchSize = Sampler::BatchSize;
+    float u[BatchSize], v[BatchSize];
+    for(std::size_t i = 0; i < count; i += BatchSize) {
+        unsigned int blockSize = std::min<std::size_t>(BatchSize, count - i);
+        for(unsigned int k = 0; k < blockSize; k++) {
+            if constexpr(std::is_same<float, typename FunctorT::OutputT>::value) {
+                u[k] = f_(input[i + k]);
+                v[k] = 0.0f;
+            }
+            else {
+                Point2<float> uv = f_(input[i + k]);
+                u[k] = uv.x;
+                v[k] = uv.y;
+            }
+        }
+        data_.fetch(u, v, output + i, blockSize);
+    }
+}
+
+}; //namespace types
+}; //namespace rtac
+
+#endif //_DEF_RTAC_BASE_TYPES_HOST_MAPPING_H_
@@ -0,0 +1,545 @@
+#ifndef _DEF_RTAC_BASE_TYPES_RING_BUFFER_H_
+#define _DEF_RTAC_BASE_TYPES_RING_BUFFER_H_
+
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <new>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace rtac { namespace types {
+
+// Bounded lock-free queues to hand items (typically Handles to Images or
+// PointClouds, or small POD records) from one thread to another without
+// locking or allocating :
+//
+// - SpscRingBuffer : one producer thread and one consumer thread.
+// - MpmcRingBuffer : any number of producers and consumers.
+// - BlockingRingBuffer<QueueT> : adds blocking push / pop to one of the above
+//   for threads which want to sleep when there is nothing to do.
+//
+// Capacities are rounded up to a power of two. Items are moved in and out of
+// preallocated storage. Producer and consumer indices are on separate cache
+// lines.
+
+namespace details {
+
+constexpr std::size_t CacheLineSize = 64;
+
+inline std::size_t ring_capacity(std::size_t requested)
+{
+    std::size_t res = 2;
+    while(res < requested) res <<= 1;
+    return res;
+}
+
+template <typename T>
+struct alignas(T) RingStorage
+{
+    unsigned char bytes[sizeof(T)];
+
+    T*       get()       { return std::launder(reinterpret_cast<T*>(bytes));       }
+    const T* get() const { return std::launder(reinterpret_cast<const T*>(bytes)); }
+};
+
+}; //namespace details
+
+/**
+ * Single producer, single consumer bounded queue (wait-free).
+ *
+ * The try_push* methods must only be called from the producer thread and the
+ * try_pop* methods from the consumer thread. Each side caches the last seen
+ * index of the other side, so the shared indices are only read when the
+ * queue looks full (producer) or empty (consumer).
+ */
+template <typename T>
+class SpscRingBuffer
+{
+    public:
+
+    using value_type = T;
+
+    protected:
+
+    std::unique_ptr<details::RingStorage<T>[]> items_;
+    std::size_t                                mask_;
+
+    alignas(details::CacheLineSize) std::atomic<std::size_t> head_; // next write
+    std::size_t cachedTail_;
+    alignas(details::CacheLineSize) std::atomic<std::size_t> tail_; // next read
+    std::size_t cachedHead_;
+
+    public:
+
+    SpscRingBuffer(std::size_t capacity);
+    ~SpscRingBuffer();
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    std::size_t capacity() const { return mask_ + 1; }
+    // Approximate when called while the other side is active. tail_ is
+    // loaded first so that the loaded head_ is not behind it.
+    std::size_t size() const {
+        std::size_t tail = tail_.load(std::memory_order_acquire);
+        return head_.load(std::memory_order_acquire) - tail;
+    }
+    bool empty() const { return this->size() == 0; }
+
+    // Producer side
+    template <class... Args>
+    bool try_emplace(Args&&... args);
+    bool try_push(const T& item) { return this->try_emplace(item);            }
+    bool try_push(T&& item)      { return this->try_emplace(std::move(item)); }
+    /**
+     * Pushes up to count items read from first (use std::make_move_iterator
+     * to move them) and publishes them at once. Returns the number of items
+     * pushed.
+     */
+    template <class InputIt>
+    std::size_t try_push_batch(InputIt first, std::size_t count);
+
+    // Consumer side
+    bool try_pop(T& item);
+    /**
+     * Pops up to maxCount items into out. Returns the number of items popped.
+     */
+    template <class OutputIt>
+    std::size_t try_pop_batch(OutputIt out, std::size_t maxCount);
+};
+
+/**
+ * Multiple producers, multiple consumers bounded queue (lock-free, after
+ * D. Vyukov's bounded MPMC queue).
+ *
+ * Each slot holds a sequence number telling whether it is ready to be
+ * written or read for the current lap, so producers (consumers) only contend
+ * on a single compare-and-swap of the write (read) index.
+ *
+ * Batch operations are sequences of single operations : they are not atomic
+ * as a whole. T must not throw when constructed from the pushed values
+ * (Handles and POD types don't).
+ */
+template <typename T>
+class MpmcRingBuffer
+{
+    public:
+
+    using value_type = T;
+
+    protected:
+
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        details::RingStorage<T>  storage;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t             mask_;
+
+    alignas(details::CacheLineSize) std::atomic<std::size_t> head_; // next write
+    alignas(details::CacheLineSize) std::atomic<std::size_t> tail_; // next read
+
+    public:
+
+    MpmcRingBuffer(std::size_t capacity);
+    ~MpmcRingBuffer();
+
+    MpmcRingBuffer(const MpmcRingBuffer&) = delete;
+    MpmcRingBuffer& operator=(const MpmcRingBuffer&) = delete;
+
+    std::size_t capacity() const { return mask_ + 1; }
+    // Approximate when called while other threads are active.
+    std::size_t size() const {
+        std::size_t head = head_.load(std::memory_order_acquire);
+        std::size_t tail = tail_.load(std::memory_order_acquire);
+        return head > tail ? head - tail : 0;
+    }
+    bool empty() const { return this->size() == 0; }
+
+    template <class... Args>
+    bool try_emplace(Args&&... args);
+    bool try_push(const T& item) { return this->try_emplace(item);            }
+    bool try_push(T&& item)      { return this->try_emplace(std::move(item)); }
+    template <class InputIt>
+    std::size_t try_push_batch(InputIt first, std::size_t count);
+
+    bool try_pop(T& item);
+    template <class OutputIt>
+    std::size_t try_pop_batch(OutputIt out, std::size_t maxCount);
+};
+
+/**
+ * Blocking interface over SpscRingBuffer or MpmcRingBuffer.
+ *
+ * The lock-free path is unchanged : the mutex and the condition variables are
+ * only used when a thread actually has to wait, and notifications are only
+ * sent when a thread is waiting. close() wakes up all waiting threads : push
+ * then fails, and pop fails once the queue is empty.
+ *
+ * The threading restrictions of QueueT apply (for SpscRingBuffer, push and
+ * pop must each be called from a single thread).
+ */
+template <class QueueT>
+class BlockingRingBuffer
+{
+    public:
+
+    using value_type = typename QueueT::value_type;
+    using Clock      = std::chrono::steady_clock;
+
+    protected:
+
+    QueueT                  queue_;
+    std::mutex              mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+    std::atomic<int>        waitingConsumers_;
+    std::atomic<int>        waitingProducers_;
+    std::atomic<bool>       closed_;
+
+    void notify(std::condition_variable& condition, const std::atomic<int>& waiting) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(waiting.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            condition.notify_one();
+        }
+    }
+
+    template <class Predicate>
+    bool wait_until(std::condition_variable& condition, std::atomic<int>& waiting,
+                    Clock::time_point deadline, Predicate&& predicate);
+
+    // Item is either const value_type& or value_type&&. It is only moved
+    // from on success.
+    template <class Item>
+    bool try_push_item(Item&& item);
+    template <class Item>
+    bool push_item(Item&& item, Clock::time_point deadline);
+
+    template <class Rep, class Period>
+    static Clock::time_point deadline_after(const std::chrono::duration<Rep,Period>& timeout) {
+        auto now = Clock::now();
+        return timeout >= Clock::time_point::max() - now ? Clock::time_point::max()
+             : now + std::chrono::duration_cast<Clock::duration>(timeout);
+    }
+
+    public:
+
+    BlockingRingBuffer(std::size_t capacity) :
+        queue_(capacity),
+        waitingConsumers_(0),
+        waitingProducers_(0),
+        closed_(false)
+    {}
+
+    std::size_t   capacity() const { return queue_.capacity(); }
+    std::size_t   size()     const { return queue_.size();     }
+    bool          empty()    const { return queue_.empty();    }
+    bool          closed()   const { return closed_.load();    }
+    QueueT&       queue()          { return queue_; }
+    const QueueT& queue()    const { return queue_; }
+
+    // An rvalue item is left untouched when these methods return false.
+    bool try_push(const value_type& item) { return this->try_push_item(item);            }
+    bool try_push(value_type&& item)      { return this->try_push_item(std::move(item)); }
+    /**
+     * Waits for a free slot. Returns false if the queue was closed.
+     */
+    bool push(const value_type& item) { return this->push_item(item, Clock::time_point::max()); }
+    bool push(value_type&& item) {
+        return this->push_item(std::move(item), Clock::time_point::max());
+    }
+    template <class Rep, class Period>
+    bool push_for(const value_type& item, const std::chrono::duration<Rep,Period>& timeout) {
+        return this->push_item(item, deadline_after(timeout));
+    }
+    template <class Rep, class Period>
+    bool push_for(value_type&& item, const std::chrono::duration<Rep,Period>& timeout) {
+        return this->push_item(std::move(item), deadline_after(timeout));
+    }
+
+    bool try_pop(value_type& item);
+    /**
+     * Waits for an item. Returns false if the queue was closed and is empty.
+     */
+    bool pop(value_type& item);
+    template <class Rep, class Period>
+    bool pop_for(value_type& item, const std::chrono::duration<Rep,Period>& timeout);
+
+    void close();
+};
+
+// SpscRingBuffer implementation
+template <typename T>
+SpscRingBuffer<T>::SpscRingBuffer(std::size_t capacity) :
+    head_(0), cachedTail_(0),
+    tail_(0), cachedHead_(0)
+{
+    capacity = details::ring_capacity(capacity);
+    items_   = std::unique_ptr<details::RingStorage<T>[]>(new details::RingStorage<T>[capacity]);
+    mask_    = capacity - 1;
+}
+
+template <typename T>
+SpscRingBuffer<T>::~SpscRingBuffer()
+{
+    std::size_t head = head_.load(std::memory_order_acquire);
+    for(std::size_t i = tail_.load(std::memory_order_relaxed); i < head; i++) {
+        items_[i & mask_].get()->~T();
+    }
+}
+
+template <typename T> template <class... Args>
+bool SpscRingBuffer<T>::try_emplace(Args&&... args)
+{
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    if(head - cachedTail_ >= this->capacity()) {
+        cachedTail_ = tail_.load(std::memory_order_acquire);
+        if(head - cachedTail_ >= this->capacity())
+            return false;
+    }
+    new (items_[head & mask_].bytes) T(std::forward<Args>(args)...);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T> template <class InputIt>
+std::size_t SpscRingBuffer<T>::try_push_batch(InputIt first, std::size_t count)
+{
+    std::size_t head = head_.load(std::memory_order_relaxed);
+    if(this->capacity() - (head - cachedTail_) < count)
+        cachedTail_ = tail_.load(std::memory_order_acquire);
+    count = std::min(count, this->capacity() - (head - cachedTail_));
+    for(std::size_t i = 0; i < count; i++, ++first) {
+        new (items_[(head + i) & mask_].bytes) T(*first);
+    }
+    head_.store(head + count, std::memory_order_release);
+    return count;
+}
+
+template <typename T>
+bool SpscRingBuffer<T>::try_pop(T& item)
+{
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if(tail == cachedHead_) {
+        cachedHead_ = head_.load(std::memory_order_acquire);
+        if(tail == cachedHead_)
+            return false;
+    }
+    T* stored = items_[tail & mask_].get();
+    item = std::move(*stored);
+    stored->~T();
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T> template <class OutputIt>
+std::size_t SpscRingBuffer<T>::try_pop_batch(OutputIt out, std::size_t maxCount)
+{
+    std::size_t tail = tail_.load(std::memory_order_relaxed);
+    if(cachedHead_ - tail < maxCount)
+        cachedHead_ = head_.load(std::memory_order_acquire);
+    std::size_t count = std::min(maxCount, cachedHead_ - tail);
+    for(std::size_t i = 0; i < count; i++, ++out) {
+        T* stored = items_[(tail + i) & mask_].get();
+        *out = std::move(*stored);
+        stored->~T();
+    }
+    tail_.store(tail + count, std::memory_order_release);
+    return count;
+}
+
+// MpmcRingBuffer implementation
+template <typename T>
+MpmcRingBuffer<T>::MpmcRingBuffer(std::size_t capacity) :
+    head_(0),
+    tail_(0)
+{
+    capacity = details::ring_capacity(capacity);
+    cells_   = std::unique_ptr<Cell[]>(new Cell[capacity]);
+    mask_    = capacity - 1;
+    for(std::size_t i = 0; i < capacity; i++) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+MpmcRingBuffer<T>::~MpmcRingBuffer()
+{
+    std::size_t head = head_.load(std::memory_order_acquire);
+    for(std::size_t i = tail_.load(std::memory_order_relaxed); i != head; i++) {
+        Cell& cell = cells_[i & mask_];
+        if(cell.sequence.load(std::memory_order_acquire) == i + 1)
+            cell.storage.get()->~T();
+    }
+}
+
+template <typename T> template <class... Args>
+bool MpmcRingBuffer<T>::try_emplace(Args&&... args)
+{
+    Cell* cell;
+    std::size_t position = head_.load(std::memory_order_relaxed);
+    while(true) {
+        cell = &cells_[position & mask_];
+        std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+        if(diff == 0) {
+            if(head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if(diff < 0) {
+            return false; // full
+        }
+        else {
+            position = head_.load(std::memory_order_relaxed);
+        }
+    }
+    new (cell->storage.bytes) T(std::forward<Args>(args)...);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T> template <class InputIt>
+std::size_t MpmcRingBuffer<T>::try_push_batch(InputIt first, std::size_t count)
+{
+    std::size_t res = 0;
+    for(; res < count && this->try_emplace(*first); res++, ++first);
+    return res;
+}
+
+template <typename T>
+bool MpmcRingBuffer<T>::try_pop(T& item)
+{
+    Cell* cell;
+    std::size_t position = tail_.load(std::memory_order_relaxed);
+    while(true) {
+        cell = &cells_[position & mask_];
+        std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::intptr_t>(sequence)
+                  - static_cast<std::intptr_t>(position + 1);
+        if(diff == 0) {
+            if(tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if(diff < 0) {
+            return false; // empty
+        }
+        else {
+            position = tail_.load(std::memory_order_relaxed);
+        }
+    }
+    T* stored = cell->storage.get();
+    item = std::move(*stored);
+    stored->~T();
+    cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T> template <class OutputIt>
+std::size_t MpmcRingBuffer<T>::try_pop_batch(OutputIt out, std::size_t maxCount)
+{
+    std::size_t res = 0;
+    T item;
+    for(; res < maxCount && this->try_pop(item); res++, ++out) {
+        *out = std::move(item);
+    }
+    return res;
+}
+
+// BlockingRingBuffer implementation
+template <class QueueT> template <class Predicate>
+bool BlockingRingBuffer<QueueT>::wait_until(std::condition_variable& condition,
+                                            std::atomic<int>& waiting,
+                                            Clock::time_point deadline,
+                                            Predicate&& predicate)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiting++;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool res = condition.wait_until(lock, deadline, [&]() {
+        return predicate() || closed_.load();
+    });
+    waiting--;
+    return res;
+}
+
+template <class QueueT> template <class Item>
+bool BlockingRingBuffer<QueueT>::try_push_item(Item&& item)
+{
+    if(closed_.load() || !queue_.try_push(std::forward<Item>(item)))
+        return false;
+    this->notify(notEmpty_, waitingConsumers_);
+    return true;
+}
+
+template <class QueueT> template <class Item>
+bool BlockingRingBuffer<QueueT>::push_item(Item&& item, Clock::time_point deadline)
+{
+    if(closed_.load())
+        return false;
+    if(!queue_.try_push(std::forward<Item>(item))) {
+        bool pushed = false;
+        this->wait_until(notFull_, waitingProducers_, deadline, [&]() {
+            // The item is only moved from on success.
+            return pushed = queue_.try_push(std::forward<Item>(item));
+        });
+        if(!pushed)
+            return false;
+    }
+    this->notify(notEmpty_, waitingConsumers_);
+    return true;
+}
+
+template <class QueueT>
+bool BlockingRingBuffer<QueueT>::try_pop(value_type& item)
+{
+    if(!queue_.try_pop(item))
+        return false;
+    this->notify(notFull_, waitingProducers_);
+    return true;
+}
+
+template <class QueueT>
+bool BlockingRingBuffer<QueueT>::pop(value_type& item)
+{
+    return this->pop_for(item, Clock::duration::max());
+}
+
+template <class QueueT> template <class Rep, class Period>
+bool BlockingRingBuffer<QueueT>::pop_for(value_type& item,
+                                         const std::chrono::duration<Rep,Period>& timeout)
+{
+    if(!queue_.try_pop(item)) {
+        bool popped = false;
+        this->wait_until(notEmpty_, waitingConsumers_, deadline_after(timeout), [&]() {
+            return popped = queue_.try_pop(item);
+        });
+        // Items pushed before close() are still delivered.
+        if(!popped && !(popped = queue_.try_pop(item)))
+            return false;
+    }
+    this->notify(notFull_, waitingProducers_);
+    return true;
+}
+
+template <class QueueT>
+void BlockingRingBuffer<QueueT>::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    notEmpty_.notify_all();
+    notFull_.notify_all();
+}
+
+}; //namespace types
+}; //namespace rtac
+
+#endif //_DEF_RTAC_BASE_TYPES_RING_BUFFER_H_
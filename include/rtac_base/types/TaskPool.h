@@ -0,0 +1,267 @@
+#ifndef _DEF_RTAC_BASE_TYPES_TASK_POOL_H_
+#define _DEF_RTAC_BASE_TYPES_TASK_POOL_H_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+#include <rtac_base/types/Handle.h>
+#include <rtac_base/types/Executor.h>
+
+namespace rtac { namespace types {
+
+struct TaskPoolOptions
+{
+    // Number of worker threads. 0 uses one less than the number of cpus
+    // available (of the NUMA node if numaNode is set), since the threads
+    // waiting for parallel work take part in it.
+    unsigned int threadCount = 0;
+    // Restricts the workers to the cpus of this NUMA node (-1 : no
+    // restriction).
+    int          numaNode    = -1;
+    // Pins each worker to a single cpu (round robin over the allowed cpus).
+    bool         pinThreads  = false;
+};
+
+class TaskPool;
+
+/**
+ * Set of tasks run on a TaskPool which can be waited for together.
+ *
+ * wait() does not block the calling thread : it runs pending tasks of the
+ * pool until all the tasks of the group are done, so groups can be nested
+ * (a task can create a group and wait for it) without deadlocking or
+ * oversubscribing the cpus. The first exception thrown by a task of the
+ * group is rethrown by wait(), and the tasks of the group which did not start
+ * yet are skipped.
+ */
+class TaskGroup
+{
+    protected:
+
+    TaskPool&            pool_;
+    std::atomic<int64_t> pending_;
+    std::atomic<bool>    cancelled_;
+    std::mutex           exceptionMutex_;
+    std::exception_ptr   exception_;
+
+    friend class TaskPool;
+    void execute(const std::function<void()>& task);
+
+    public:
+
+    TaskGroup(TaskPool& pool);
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void run(std::function<void()> task);
+    void wait();
+
+    bool cancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+};
+
+/**
+ * Work-stealing pool of worker threads.
+ *
+ * Each worker owns a task deque : tasks spawned by a worker are pushed to its
+ * own deque and popped back in LIFO order (cache locality, depth-first
+ * execution of recursive splits), idle workers steal from the front of the
+ * other deques (oldest and largest tasks first). Tasks submitted from
+ * threads outside of the pool go through a shared queue.
+ *
+ *     auto& pool = rtac::types::TaskPool::global();
+ *     pool.parallel_for(0, data.size(), [&](std::size_t begin, std::size_t end) {
+ *         for(auto i = begin; i < end; i++) data[i] = f(data[i]);
+ *     });
+ *
+ * TaskPool is also an Executor : post() runs fire-and-forget tasks, whose
+ * exceptions are ignored.
+ *
+ * Thread configuration failures (affinity) are not fatal and are reported by
+ * error().
+ */
+class TaskPool : public Executor
+{
+    public:
+
+    using Ptr      = Handle<TaskPool>;
+    using ConstPtr = Handle<const TaskPool>;
+    using Options  = TaskPoolOptions;
+
+    protected:
+
+    struct Job {
+        std::function<void()> task;
+        TaskGroup*            group;
+    };
+
+    struct alignas(64) WorkerQueue {
+        std::mutex      mutex;
+        std::deque<Job> jobs;
+    };
+
+    Options                                   options_;
+    std::vector<int>                          cpus_;
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    WorkerQueue                               injected_; // from outside threads
+    std::vector<std::thread>                  threads_;
+
+    std::mutex              sleepMutex_;
+    std::condition_variable sleepCondition_;
+    std::atomic<uint64_t>   epoch_;    // incremented on each submission
+    std::atomic<int>        sleepers_;
+    std::atomic<bool>       stop_;
+    std::atomic<uint64_t>   steals_;
+
+    mutable std::mutex errorMutex_;
+    std::string        error_;
+
+    TaskPool(const Options& options);
+
+    void run(unsigned int workerIndex);
+    void configure_thread(unsigned int workerIndex);
+    void push(Job&& job);
+    bool pop(Job& job);
+    void execute(Job& job);
+
+    friend class TaskGroup;
+
+    public:
+
+    static Ptr Create(const Options& options = Options());
+    static Ptr Create(unsigned int threadCount);
+    ~TaskPool();
+
+    /**
+     * Pool shared by the library (created on first use with the default
+     * options).
+     */
+    static TaskPool& global();
+
+    // deleted functions to prevent copy
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    void post(Task&& task) override;
+
+    /**
+     * Runs one pending task if there is any, from the calling thread.
+     * Returns false if no task was found.
+     */
+    bool try_run_one();
+
+    unsigned int thread_count() const { return threads_.size(); }
+    // Index of the calling thread in this pool, -1 if not a worker of it.
+    int          worker_index() const;
+    uint64_t     steals()       const { return steals_.load(std::memory_order_relaxed); }
+    std::string  error()        const;
+    const std::vector<int>& cpus() const { return cpus_; }
+
+    /**
+     * Default grain size for a range of size elements : enough chunks to
+     * balance the load (about 8 per thread) without too much overhead.
+     */
+    std::size_t default_grain(std::size_t size) const {
+        return std::max<std::size_t>(1, size / (8*(this->thread_count() + 1)));
+    }
+
+    /**
+     * Calls f(chunkBegin, chunkEnd) on sub-ranges of [begin,end[ of at most
+     * grain elements (0 : default_grain). The range is split recursively, so
+     * that large sub-ranges are stolen first. Returns when all the chunks are
+     * done, and rethrows the first exception thrown by f.
+     */
+    template <class F>
+    void parallel_for(std::size_t begin, std::size_t end, F&& f, std::size_t grain = 0);
+
+    /**
+     * Reduces [begin,end[ : map(chunkBegin, chunkEnd) reduces a chunk to a
+     * value of type T, chunk values are combined with combine(lhs, rhs)
+     * starting from identity.
+     *
+     * Chunks boundaries depend only on the range and the grain, and partial
+     * results are combined in chunk order, so the result does not depend on
+     * the scheduling (e.g. floating point sums are reproducible).
+     */
+    template <typename T, class MapF, class CombineF>
+    T parallel_reduce(std::size_t begin, std::size_t end, const T& identity,
+                      MapF&& map, CombineF&& combine, std::size_t grain = 0);
+
+    /**
+     * CPUs of each NUMA node (read from sysfs). Returns a single node with
+     * all online cpus when the information is not available.
+     */
+    static std::vector<std::vector<int>> numa_nodes();
+};
+
+namespace details {
+
+template <class F>
+void parallel_split(TaskGroup& group, std::size_t begin, std::size_t end,
+                    std::size_t grain, F& f)
+{
+    while(end - begin > grain && !group.cancelled()) {
+        std::size_t middle = begin + (end - begin) / 2;
+        group.run([&group, middle, end, grain, &f]() {
+            parallel_split(group, middle, end, grain, f);
+        });
+        end = middle;
+    }
+    if(!group.cancelled())
+        f(begin, end);
+}
+
+}; //namespace details
+
+template <class F>
+void TaskPool::parallel_for(std::size_t begin, std::size_t end, F&& f, std::size_t grain)
+{
+    if(end <= begin) return;
+    if(grain == 0)
+        grain = this->default_grain(end - begin);
+    if(end - begin <= grain) {
+        f(begin, end);
+        return;
+    }
+    TaskGroup group(*this);
+    details::parallel_split(group, begin, end, grain, f);
+    group.wait();
+}
+
+template <typename T, class MapF, class CombineF>
+T TaskPool::parallel_reduce(std::size_t begin, std::size_t end, const T& identity,
+                            MapF&& map, CombineF&& combine, std::size_t grain)
+{
+    if(end <= begin) return identity;
+    if(grain == 0)
+        grain = this->default_grain(end - begin);
+
+    std::size_t chunkCount = (end - begin + grain - 1) / grain;
+    std::vector<T> partials(chunkCount, identity);
+    this->parallel_for(0, chunkCount, [&](std::size_t first, std::size_t last) {
+        for(auto c = first; c < last; c++) {
+            partials[c] = map(begin + c*grain, std::min(begin + (c + 1)*grain, end));
+        }
+    }, 1);
+
+    T res = identity;
+    for(const auto& partial : partials) {
+        res = combine(res, partial);
+    }
+    return res;
+}
+
+}; //namespace types
+}; //namespace rtac
+
+#endif //_DEF_RTAC_BASE_TYPES_TASK_POOL_H_
@@ -0,0 +1,513 @@
+#ifndef _DEF_RTAC_BASE_TYPES_TEXTURE_SAMPLER_2D_H_
+#define _DEF_RTAC_BASE_TYPES_TEXTURE_SAMPLER_2D_H_
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include <rtac_base/type_utils.h>
+#include <rtac_base/types/Point.h>
+#include <rtac_base/types/SharedVector.h>
+#include <rtac_base/types/Image.h>
+
+namespace rtac { namespace types {
+
+// Checks at compile time if texels of type T can be linearly interpolated.
+// This mirrors the CUDA restriction that linear filtering is only available
+// for floating point texels (integer texels must be read with
+// FilterNearest).
+template <typename T, class = void>
+struct is_texture_filterable : std::false_type {};
+template <typename T>
+struct is_texture_filterable<T, typename voider<decltype(
+    std::declval<T&>() = std::declval<T>()*1.0f + std::declval<T>()*1.0f)>::type> :
+    std::integral_constant<bool, std::is_floating_point<T>::value
+                             || !std::is_arithmetic<T>::value>
+{};
+
+/**
+ * Host side emulation of a CUDA 2D texture fetch (see rtac::cuda::Texture2D).
+ *
+ * This samples a types::Image buffer with the same filter mode, per-axis wrap
+ * mode, normalized coordinates and border color semantics than the CUDA
+ * texture units. It allows code relying on texture fetches to run on machines
+ * without a GPU, and to be used as a reference for GPU results.
+ *
+ * As on the GPU, linear interpolation weights are quantized to WeightBits
+ * fractional bits, and the WrapRepeat and WrapMirror modes are only available
+ * with normalized coordinates (they fall back to WrapClamp otherwise).
+ *
+ * The image data is held in a SharedVector : copying a TextureSampler2D does
+ * not copy the texels. Empty images are rejected, and a sampler without an
+ * image returns the border color.
+ */
+template <typename T>
+class TextureSampler2D
+{
+    public:
+
+    using value_type = T;
+    using ImageType  = Image<T, SharedVector>;
+
+    enum FilterMode {
+        FilterNearest,
+        FilterLinear
+    };
+
+    enum WrapMode {
+        WrapRepeat,
+        WrapClamp,
+        WrapMirror,
+        WrapBorder
+    };
+
+    // Number of fractional bits of the interpolation weights in CUDA texture
+    // units.
+    static constexpr unsigned int WeightBits = 8;
+    // Number of texels processed together in batched fetches.
+    static constexpr unsigned int BatchSize  = 16;
+
+    protected:
+
+    ImageType  data_;
+    FilterMode filterMode_;
+    WrapMode   wrapMode_[2];
+    bool       normalizedCoords_;
+    T          borderColor_;
+
+    static int address(int i, int size, WrapMode mode);
+    static void address(int* indexes, unsigned int count, int size, WrapMode mode);
+    static int   to_texel(float x);
+    static float quantize(float weight);
+
+    WrapMode effective_wrap_mode(unsigned int axis) const;
+    T texel(int j, int i) const;
+    T texel(int index) const { return index < 0 ? borderColor_ : data_.data()[index]; }
+
+    void fetch_block(const float* u, const float* v, T* output,
+                     unsigned int count) const;
+
+    public:
+
+    TextureSampler2D();
+    TextureSampler2D(const ImageType& image);
+
+    void set_image(uint32_t width, uint32_t height, const T* data);
+    void set_image(const ImageType& image);
+
+    const ImageType& image() const { return data_; }
+    uint32_t width()  const { return data_.width();  }
+    uint32_t height() const { return data_.height(); }
+    size_t   size()   const { return (size_t)this->width()*this->height(); }
+
+    // Fetch configuration (same semantics as rtac::cuda::Texture2D setters).
+    void set_filter_mode(FilterMode mode);
+    void set_wrap_mode(WrapMode xyWrap);
+    void set_wrap_mode(WrapMode xWrap, WrapMode yWrap);
+    void use_normalized_coordinates(bool use);
+    void set_border_color(const T& color);
+
+    FilterMode filter_mode()            const { return filterMode_;       }
+    WrapMode   wrap_mode(unsigned int axis) const { return wrapMode_[axis]; }
+    bool       normalized_coordinates() const { return normalizedCoords_; }
+    const T&   border_color()           const { return borderColor_;      }
+
+    T operator()(float u, float v) const;
+    T operator()(const Point2<float>& uv) const { return (*this)(uv.x, uv.y); }
+
+    void fetch(const float* u, const float* v, T* output, std::size_t count) const;
+    void fetch(const Point2<float>* uv, T* output, std::size_t count) const;
+};
+
+// Implementation (static methods)
+/**
+ * Applies the wrap mode to an integer texel coordinate.
+ *
+ * @return the wrapped coordinate in [0,size[, or -1 if the texel lies
+ *         outside of the texture in WrapBorder mode.
+ */
+template <typename T>
+int TextureSampler2D<T>::address(int i, int size, WrapMode mode)
+{
+    switch(mode) {
+        default:
+        case WrapRepeat: {
+            int r = i % size;
+            return r < 0 ? r + size : r;
+        }
+        case WrapMirror: {
+            int r = i % (2*size);
+            if(r < 0)     r += 2*size;
+            if(r >= size) r  = 2*size - 1 - r;
+            return r;
+        }
+        case WrapClamp:
+            return std::min(std::max(i, 0), size - 1);
+        case WrapBorder:
+            return (i < 0 || i >= size) ? -1 : i;
+    }
+}
+
+/**
+ * Block version of address. The wrap mode is dispatched once per block so
+ * that the inner loops are branch free and can be vectorized.
+ */
+template <typename T>
+void TextureSampler2D<T>::address(int* indexes, unsigned int count,
+                                  int size, WrapMode mode)
+{
+    switch(mode) {
+        default:
+        case WrapRepeat:
+            for(unsigned int k = 0; k < count; k++) {
+                int r = indexes[k] % size;
+                indexes[k] = r < 0 ? r + size : r;
+            }
+            break;
+        case WrapMirror:
+            for(unsigned int k = 0; k < count; k++) {
+                int r = indexes[k] % (2*size);
+                r = r < 0 ? r + 2*size : r;
+                indexes[k] = r >= size ? 2*size - 1 - r : r;
+            }
+            break;
+        case WrapClamp:
+            for(unsigned int k = 0; k < count; k++) {
+                indexes[k] = std::min(std::max(indexes[k], 0), size - 1);
+            }
+            break;
+        case WrapBorder:
+            for(unsigned int k = 0; k < count; k++) {
+                indexes[k] = (indexes[k] < 0 || indexes[k] >= size) ? -1 : indexes[k];
+            }
+            break;
+    }
+}
+
+/**
+ * Floor to integer texel coordinate, saturating to avoid overflows on very
+ * large inputs. NaN is mapped to texel 0 (converting it to int is undefined).
+ */
+template <typename T>
+int TextureSampler2D<T>::to_texel(float x)
+{
+    constexpr float limit = 1 << 30;
+    x = std::isnan(x) ? 0.0f : x;
+    return (int)std::floor(std::min(std::max(x, -limit), limit));
+}
+
+template <typename T>
+float TextureSampler2D<T>::quantize(float weight)
+{
+    constexpr float scale = 1 << WeightBits;
+    return std::round(weight * scale) / scale;
+}
+
+// Implementation (non-static methods)
+/**
+ * Default configuration is the same as
+ * rtac::cuda::Texture2D::default_texture_description().
+ */
+template <typename T>
+TextureSampler2D<T>::TextureSampler2D() :
+    filterMode_(FilterNearest),
+    wrapMode_{WrapRepeat, WrapRepeat},
+    normalizedCoords_(true),
+    borderColor_(zero<T>())
+{}
+
+template <typename T>
+TextureSampler2D<T>::TextureSampler2D(const ImageType& image) :
+    TextureSampler2D()
+{
+    this->set_image(image);
+}
+
+template <typename T>
+void TextureSampler2D<T>::set_image(uint32_t width, uint32_t height, const T* data)
+{
+    if(width == 0 || height == 0)
+        throw std::runtime_error("TextureSampler2D : empty image");
+    ImageType image({width, height});
+    std::copy(data, data + image.size(), image.data());
+    data_ = image;
+}
+
+/**
+ * Image data is shared, not copied.
+ */
+template <typename T>
+void TextureSampler2D<T>::set_image(const ImageType& image)
+{
+    if(image.width() == 0 || image.height() == 0)
+        throw std::runtime_error("TextureSampler2D : empty image");
+    data_ = image;
+}
+
+template <typename T>
+void TextureSampler2D<T>::set_filter_mode(FilterMode mode)
+{
+    if(mode == FilterLinear && !is_texture_filterable<T>::value) {
+        throw std::runtime_error(
+            "TextureSampler2D : linear filtering not available for this texel type");
+    }
+    filterMode_ = mode;
+}
+
+template <typename T>
+void TextureSampler2D<T>::set_wrap_mode(WrapMode xyWrap)
+{
+    this->set_wrap_mode(xyWrap, xyWrap);
+}
+
+template <typename T>
+void TextureSampler2D<T>::set_wrap_mode(WrapMode xWrap, WrapMode yWrap)
+{
+    wrapMode_[0] = xWrap;
+    wrapMode_[1] = yWrap;
+}
+
+template <typename T>
+void TextureSampler2D<T>::use_normalized_coordinates(bool use)
+{
+    normalizedCoords_ = use;
+}
+
+template <typename T>
+void TextureSampler2D<T>::set_border_color(const T& color)
+{
+    borderColor_ = color;
+}
+
+template <typename T>
+typename TextureSampler2D<T>::WrapMode
+TextureSampler2D<T>::effective_wrap_mode(unsigned int axis) const
+{
+    // Same as CUDA : repeat and mirror are only supported with normalized
+    // coordinates.
+    if(!normalizedCoords_ && (wrapMode_[axis] == WrapRepeat
+                           || wrapMode_[axis] == WrapMirror))
+        return WrapClamp;
+    return wrapMode_[axis];
+}
+
+template <typename T>
+T TextureSampler2D<T>::texel(int j, int i) const
+{
+    j = address(j, this->width(),  this->effective_wrap_mode(0));
+    i = address(i, this->height(), this->effective_wrap_mode(1));
+    if(j < 0 || i < 0)
+        return borderColor_;
+    return data_.data()[this->width()*i + j];
+}
+
+/**
+ * Single texel fetch. Equivalent of tex2D<T>(texture, u, v) on the device.
+ */
+template <typename T>
+T TextureSampler2D<T>::operator()(float u, float v) const
+{
+    if(this->size() == 0)
+        return borderColor_;
+
+    float x = u, y = v;
+    if(normalizedCoords_) {
+        x *= this->width();
+        y *= this->height();
+    }
+
+    if(filterMode_ == FilterNearest) {
+        return this->texel(to_texel(x), to_texel(y));
+    }
+
+    if constexpr(is_texture_filterable<T>::value) {
+        // Texel centers are at half-integer coordinates.
+        x -= 0.5f;
+        y -= 0.5f;
+        int j = to_texel(x), i = to_texel(y);
+        float a = quantize(x - j), b = quantize(y - i);
+
+        return (1.0f - a)*(1.0f - b)*this->texel(j,     i)
+             +         a *(1.0f - b)*this->texel(j + 1, i)
+             + (1.0f - a)*        b *this->texel(j,     i + 1)
+             +         a *        b *this->texel(j + 1, i + 1);
+    }
+    return T();
+}
+
+namespace details {
+
+template <typename T>
+inline void blend_texels(const T* texels, int* const* indexes,
+                         const float* a, const float* b, const T& border,
+                         T* output, unsigned int count)
+{
+    for(unsigned int k = 0; k < count; k++) {
+        T t00 = indexes[0][k] < 0 ? border : texels[indexes[0][k]];
+        T t10 = indexes[1][k] < 0 ? border : texels[indexes[1][k]];
+        T t01 = indexes[2][k] < 0 ? border : texels[indexes[2][k]];
+        T t11 = indexes[3][k] < 0 ? border : texels[indexes[3][k]];
+        output[k] = (1.0f - a[k])*(1.0f - b[k])*t00 + a[k]*(1.0f - b[k])*t10
+                  + (1.0f - a[k])*b[k]*t01 + a[k]*b[k]*t11;
+    }
+}
+
+#ifdef __AVX2__
+// Gathering texels 8 by 8. Negative indexes (border texels) are masked out of
+// the gather and replaced by the border color.
+inline __m256 gather_texels(const float* texels, const int* indexes, __m256 border)
+{
+    __m256i idx  = _mm256_loadu_si256((const __m256i*)indexes);
+    __m256  mask = _mm256_castsi256_ps(_mm256_cmpgt_epi32(idx, _mm256_set1_epi32(-1)));
+    return _mm256_mask_i32gather_ps(border, texels, idx, mask, sizeof(float));
+}
+
+template <>
+inline void blend_texels<float>(const float* texels, int* const* indexes,
+                                const float* a, const float* b, const float& border,
+                                float* output, unsigned int count)
+{
+    __m256 vborder = _mm256_set1_ps(border);
+    __m256 one     = _mm256_set1_ps(1.0f);
+    unsigned int k = 0;
+    for(; k + 8 <= count; k += 8) {
+        __m256 va  = _mm256_loadu_ps(a + k);
+        __m256 vb  = _mm256_loadu_ps(b + k);
+        __m256 t00 = gather_texels(texels, indexes[0] + k, vborder);
+        __m256 t10 = gather_texels(texels, indexes[1] + k, vborder);
+        __m256 t01 = gather_texels(texels, indexes[2] + k, vborder);
+        __m256 t11 = gather_texels(texels, indexes[3] + k, vborder);
+        __m256 top    = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(one, va), t00),
+                                      _mm256_mul_ps(va, t10));
+        __m256 bottom = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(one, va), t01),
+                                      _mm256_mul_ps(va, t11));
+        _mm256_storeu_ps(output + k,
+            _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(one, vb), top),
+                          _mm256_mul_ps(vb, bottom)));
+    }
+    for(; k < count; k++) {
+        float t00 = indexes[0][k] < 0 ? border : texels[indexes[0][k]];
+        float t10 = indexes[1][k] < 0 ? border : texels[indexes[1][k]];
+        float t01 = indexes[2][k] < 0 ? border : texels[indexes[2][k]];
+        float t11 = indexes[3][k] < 0 ? border : texels[indexes[3][k]];
+        output[k] = (1.0f - b[k])*((1.0f - a[k])*t00 + a[k]*t10)
+                  +         b[k] *((1.0f - a[k])*t01 + a[k]*t11);
+    }
+}
+#endif //__AVX2__
+
+}; //namespace details
+
+/**
+ * Fetches a block of at most BatchSize texels. Coordinates, texel indexes and
+ * weights are computed in separate passes on local arrays so that each pass
+ * can be vectorized.
+ */
+template <typename T>
+void TextureSampler2D<T>::fetch_block(const float* u, const float* v, T* output,
+                                      unsigned int count) const
+{
+    if(this->size() == 0) {
+        std::fill(output, output + count, borderColor_);
+        return;
+    }
+
+    float x[BatchSize], y[BatchSize];
+    int   j0[BatchSize], i0[BatchSize], j1[BatchSize], i1[BatchSize];
+
+    float xScale = normalizedCoords_ ? this->width()  : 1.0f;
+    float yScale = normalizedCoords_ ? this->height() : 1.0f;
+    float shift  = filterMode_ == FilterLinear ? 0.5f : 0.0f;
+    for(unsigned int k = 0; k < count; k++) {
+        x[k] = xScale*u[k] - shift;
+        y[k] = yScale*v[k] - shift;
+    }
+    for(unsigned int k = 0; k < count; k++) {
+        j0[k] = to_texel(x[k]);
+        i0[k] = to_texel(y[k]);
+    }
+
+    if(filterMode_ == FilterNearest) {
+        address(j0, count, this->width(),  this->effective_wrap_mode(0));
+        address(i0, count, this->height(), this->effective_wrap_mode(1));
+        for(unsigned int k = 0; k < count; k++) {
+            output[k] = this->texel((j0[k] < 0 || i0[k] < 0) ?
+                                    -1 : this->width()*i0[k] + j0[k]);
+        }
+        return;
+    }
+
+    if constexpr(is_texture_filterable<T>::value) {
+        float a[BatchSize], b[BatchSize];
+        for(unsigned int k = 0; k < count; k++) {
+            a[k] = quantize(x[k] - j0[k]);
+            b[k] = quantize(y[k] - i0[k]);
+            j1[k] = j0[k] + 1;
+            i1[k] = i0[k] + 1;
+        }
+        address(j0, count, this->width(),  this->effective_wrap_mode(0));
+        address(j1, count, this->width(),  this->effective_wrap_mode(0));
+        address(i0, count, this->height(), this->effective_wrap_mode(1));
+        address(i1, count, this->height(), this->effective_wrap_mode(1));
+
+        int idx00[BatchSize], idx10[BatchSize], idx01[BatchSize], idx11[BatchSize];
+        int W = this->width();
+        for(unsigned int k = 0; k < count; k++) {
+            idx00[k] = (j0[k] < 0 || i0[k] < 0) ? -1 : W*i0[k] + j0[k];
+            idx10[k] = (j1[k] < 0 || i0[k] < 0) ? -1 : W*i0[k] + j1[k];
+            idx01[k] = (j0[k] < 0 || i1[k] < 0) ? -1 : W*i1[k] + j0[k];
+            idx11[k] = (j1[k] < 0 || i1[k] < 0) ? -1 : W*i1[k] + j1[k];
+        }
+
+        int* indexes[4] = {idx00, idx10, idx01, idx11};
+        details::blend_texels(data_.data(), indexes, a, b, borderColor_,
+                              output, count);
+    }
+}
+
+/**
+ * Batched texel fetch. Equivalent to calling operator() for each (u[i],v[i])
+ * pair, but processes texels by blocks of BatchSize for better performances.
+ */
+template <typename T>
+void TextureSampler2D<T>::fetch(const float* u, const float* v, T* output,
+                                std::size_t count) const
+{
+    for(std::size_t i = 0; i < count; i += BatchSize) {
+        this->fetch_block(u + i, v + i, output + i,
+                          std::min<std::size_t>(BatchSize, count - i));
+    }
+}
+
+template <typename T>
+void TextureSampler2D<T>::fetch(const Point2<float>* uv, T* output,
+                                std::size_t count) const
+{
+    float u[BatchSize], v[BatchSize];
+    for(std::size_t i = 0; i < count; i += BatchSize) {
+        unsigned int blockSize = std::min<std::size_t>(BatchSize, count - i);
+        for(unsigned int k = 0; k < blockSize; k++) {
+            u[k] = uv[i + k].x;
+            v[k] = uv[i + k].y;
+        }
+        this->fetch_block(u, v, output + i, blockSize);
+    }
+}
+
+}; //namespace types
+}; //namespace rtac
+
+template <typename T>
+inline std::ostream& operator<<(std::ostream& os, const rtac::types::TextureSampler2D<T>& tex)
+{
+    os << "TextureSampler2D (" << tex.width() << 'x' << tex.height() << ')';
+    return os;
+}
+
+#endif //_DEF_RTAC_BASE_TYPES_TEXTURE_SAMPLER_2D_H_
@@ -0,0 +1,116 @@
+#ifndef _DEF_RTAC_BASE_TYPES_TRIPLE_BUFFER_H_
+#define _DEF_RTAC_BASE_TYPES_TRIPLE_BUFFER_H_
+
+#include <atomic>
+#include <utility>
+#include <cstdint>
+
+namespace rtac { namespace types {
+
+/**
+ * "Latest value" mailbox between a producer thread and a consumer thread.
+ *
+ * Three buffers are allocated once : the producer writes in the back buffer
+ * and publishes it, the consumer reads the front buffer in place. Publishing
+ * swaps the back buffer with the middle one, and the consumer takes the
+ * middle one as its new front buffer if it holds a newer value. Both sides
+ * are wait-free (a single atomic exchange), never copy the data and never
+ * block each other. Frames published faster than they are consumed are
+ * overwritten, the consumer always sees the latest complete one.
+ *
+ *     // preallocated for 640x480 frames
+ *     TripleBuffer<Image<float, std::vector>> mailbox(Shape<uint32_t>({640,480}));
+ *
+ *     // producer                          // consumer
+ *     auto& frame = mailbox.back();        if(mailbox.update())
+ *     fill(frame);                             display(mailbox.front());
+ *     mailbox.publish();
+ *
+ * Each buffer is constructed from the constructor arguments, so they must not
+ * share their storage (pass a shape, not a PointCloud which would be shallow
+ * copied).
+ */
+template <typename T>
+class TripleBuffer
+{
+    public:
+
+    using value_type = T;
+
+    protected:
+
+    static constexpr uint8_t IndexMask = 0x3;
+    static constexpr uint8_t FreshBit  = 0x4; // middle buffer not read yet
+
+    T buffers_[3];
+
+    alignas(64) std::atomic<uint8_t> middle_;
+    // Producer side
+    alignas(64) uint8_t back_;
+    std::atomic<uint64_t> published_;
+    // Consumer side
+    alignas(64) uint8_t front_;
+    uint64_t consumed_;
+
+    public:
+
+    template <class... Args>
+    TripleBuffer(const Args&... args) :
+        buffers_{T(args...), T(args...), T(args...)},
+        middle_(1),
+        back_(2),
+        published_(0),
+        front_(0),
+        consumed_(0)
+    {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Producer side
+    T& back() { return buffers_[back_]; }
+    /**
+     * Makes the back buffer available to the consumer. The producer gets a
+     * new back buffer, which holds an older value.
+     */
+    void publish() {
+        back_ = middle_.exchange(back_ | FreshBit, std::memory_order_acq_rel) & IndexMask;
+        published_.store(published_.load(std::memory_order_relaxed) + 1,
+                         std::memory_order_relaxed);
+    }
+    /**
+     * Convenience function moving value into the back buffer then publishing
+     * it (prefer writing into back() to avoid reallocations).
+     */
+    void publish(T&& value) {
+        this->back() = std::move(value);
+        this->publish();
+    }
+
+    // Consumer side
+    bool has_update() const {
+        return middle_.load(std::memory_order_relaxed) & FreshBit;
+    }
+    /**
+     * Takes the latest published buffer as the front buffer if there is one
+     * the consumer did not see yet. Returns true if front() changed.
+     */
+    bool update() {
+        if(!this->has_update())
+            return false;
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & IndexMask;
+        consumed_++;
+        return true;
+    }
+    const T& front() const { return buffers_[front_]; }
+          T& front()       { return buffers_[front_]; }
+
+    // Statistics (published() - consumed() frames were never read)
+    uint64_t published() const { return published_.load(std::memory_order_relaxed); }
+    uint64_t consumed()  const { return consumed_; }
+};
+
+}; //namespace types
+}; //namespace rtac
+
+#endif //_DEF_RTAC_BASE_TYPES_TRIPLE_BUFFER_H_
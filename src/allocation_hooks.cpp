@@ -0,0 +1,86 @@
+#include <rtac_base/allocation_tracker.h>
+
+#include <new>
+#include <cstdlib>
+#include <algorithm>
+
+#include <malloc.h>
+
+// Replacements of the global allocation functions reporting to
+// rtac::memory::AllocationTracker. This file is built in the
+// rtac_base_allocation_hooks object library : it is only linked in the
+// executables opting in to allocation tracking.
+//
+// Sizes are the usable sizes of the blocks (malloc_usable_size), so that
+// allocations and deallocations are measured consistently.
+
+namespace {
+
+const bool registered = (rtac::memory::details::set_hooks_installed(), true);
+
+inline void* tracked_malloc(std::size_t size) noexcept
+{
+    void* ptr = std::malloc(size ? size : 1);
+    if(ptr)
+        rtac::memory::details::on_allocation(malloc_usable_size(ptr));
+    return ptr;
+}
+
+inline void* tracked_aligned_alloc(std::size_t size, std::align_val_t alignment) noexcept
+{
+    void* ptr = nullptr;
+    std::size_t align = std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+    if(posix_memalign(&ptr, align, size ? size : 1) != 0)
+        return nullptr;
+    rtac::memory::details::on_allocation(malloc_usable_size(ptr));
+    return ptr;
+}
+
+inline void tracked_free(void* ptr) noexcept
+{
+    if(!ptr)
+        return;
+    rtac::memory::details::on_deallocation(malloc_usable_size(ptr));
+    std::free(ptr);
+}
+
+inline void* throwing(void* ptr)
+{
+    if(!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+} //namespace
+
+void* operator new(std::size_t size)   { return throwing(tracked_malloc(size)); }
+void* operator new[](std::size_t size) { return throwing(tracked_malloc(size)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept   { return tracked_malloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return tracked_malloc(size); }
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return throwing(tracked_aligned_alloc(size, alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return throwing(tracked_aligned_alloc(size, alignment));
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return tracked_aligned_alloc(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return tracked_aligned_alloc(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept   { tracked_free(ptr); }
+void operator delete[](void* ptr) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept   { tracked_free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept   { tracked_free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { tracked_free(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept   { tracked_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept   { tracked_free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { tracked_free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept   { tracked_free(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { tracked_free(ptr); }
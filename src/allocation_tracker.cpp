@@ -0,0 +1,136 @@
+#include <rtac_base/allocation_tracker.h>
+
+#include <atomic>
+#include <cstring>
+#include <cstdlib>
+
+#include <unistd.h>
+
+namespace rtac { namespace memory {
+
+namespace details {
+
+// Constant initialized : usable from the hooks before main and during the
+// thread exit.
+thread_local AllocationCounters threadCounters;
+thread_local NoAllocationScope* currentScope = nullptr;
+
+std::atomic<uint64_t> globalAllocations(0);
+std::atomic<uint64_t> globalDeallocations(0);
+std::atomic<uint64_t> globalAllocatedBytes(0);
+std::atomic<uint64_t> globalFreedBytes(0);
+std::atomic<bool>     hooksInstalled(false);
+
+static void write_stderr(const char* message)
+{
+    if(::write(2, message, std::strlen(message)) < 0) {
+        // nothing more can be done
+    }
+}
+
+void on_allocation(std::size_t size) noexcept
+{
+    threadCounters.allocations++;
+    threadCounters.allocatedBytes += size;
+    globalAllocations.fetch_add(1, std::memory_order_relaxed);
+    globalAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    bool abort = false;
+    const char* name = nullptr;
+    for(auto scope = currentScope; scope; scope = scope->parent_) {
+        scope->violations_++;
+        scope->bytes_ += size;
+        if(scope->policy_ == AllocationPolicy::Abort) {
+            abort = true;
+            name  = scope->name_;
+        }
+    }
+    if(abort) {
+        // No allocation is possible here (this is called from operator new).
+        write_stderr("rtac::memory : heap allocation in no-allocation scope '");
+        write_stderr(name ? name : "");
+        write_stderr("', aborting.\n");
+        std::abort();
+    }
+}
+
+void on_deallocation(std::size_t size) noexcept
+{
+    threadCounters.deallocations++;
+    threadCounters.freedBytes += size;
+    globalDeallocations.fetch_add(1, std::memory_order_relaxed);
+    globalFreedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void set_hooks_installed() noexcept
+{
+    hooksInstalled.store(true);
+}
+
+}; //namespace details
+
+AllocationCounters AllocationCounters::operator-(const AllocationCounters& other) const
+{
+    AllocationCounters res;
+    res.allocations    = allocations    - other.allocations;
+    res.deallocations  = deallocations  - other.deallocations;
+    res.allocatedBytes = allocatedBytes - other.allocatedBytes;
+    res.freedBytes     = freedBytes     - other.freedBytes;
+    return res;
+}
+
+std::ostream& AllocationCounters::print(std::ostream& os) const
+{
+    os << "allocations : "    << allocations << " (" << allocatedBytes << " bytes)"
+       << ", deallocations : " << deallocations << " (" << freedBytes << " bytes)";
+    return os;
+}
+
+bool AllocationTracker::hooks_installed()
+{
+    return details::hooksInstalled.load();
+}
+
+AllocationCounters AllocationTracker::thread_counters()
+{
+    return details::threadCounters;
+}
+
+AllocationCounters AllocationTracker::global_counters()
+{
+    AllocationCounters res;
+    res.allocations    = details::globalAllocations.load(std::memory_order_relaxed);
+    res.deallocations  = details::globalDeallocations.load(std::memory_order_relaxed);
+    res.allocatedBytes = details::globalAllocatedBytes.load(std::memory_order_relaxed);
+    res.freedBytes     = details::globalFreedBytes.load(std::memory_order_relaxed);
+    return res;
+}
+
+NoAllocationScope::NoAllocationScope(const char* name, AllocationPolicy policy) :
+    name_(name),
+    policy_(policy),
+    parent_(details::currentScope),
+    violations_(0),
+    bytes_(0)
+{
+    details::currentScope = this;
+}
+
+NoAllocationScope::~NoAllocationScope()
+{
+    // Removing the scope first so that the report itself is not counted.
+    details::currentScope = parent_;
+    if(policy_ == AllocationPolicy::Report && violations_ > 0) {
+        std::cerr << "rtac::memory : " << violations_ << " heap allocation(s) ("
+                  << bytes_ << " bytes) in no-allocation scope '" << name_ << "'"
+                  << std::endl;
+    }
+}
+
+}; //namespace memory
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::memory::AllocationCounters& counters)
+{
+    return counters.print(os);
+}
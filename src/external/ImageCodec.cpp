@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <sstream>
 
+#include <rtac_base/logging.h>
+
 #ifdef RTAC_PNG
 #include <rtac_base/external/png_codec.h>
 #endif
@@ -46,7 +48,7 @@ ImageCodec::ImageEncoding ImageCodec::find_encoding(const std::string& path)
 ImageCodecBase::Ptr ImageCodec::create_codec(ImageEncoding encoding)
 {
     if(encoding == UNKNOWN_ENCODING) {
-        std::cerr << "Unknown image encoding. Cannot create codec." << std::endl;
+        RTAC_LOG_ERROR("Unknown image encoding. Cannot create codec.");
         return nullptr;
     }
 
@@ -79,7 +81,7 @@ ImageCodecBase::ConstPtr ImageCodec::read_image(const std::string& path, bool in
 {
     auto encoding = ImageCodec::find_encoding(path);
     if(encoding == UNKNOWN_ENCODING) {
-        std::cerr << "Could not find encoding for file : " << path << std::endl;
+        RTAC_LOG_WARNING("Could not find encoding for file : " << path);
         return nullptr;
     }
 
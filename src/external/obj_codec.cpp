@@ -1,11 +1,12 @@
 #include <rtac_base/external/obj_codec.h>
+#include <rtac_base/logging.h>
 
 namespace rtac { namespace external {
 
 ObjLoader::ObjLoader(const std::string& datasetPath) :
     datasetPath_(datasetPath)
 {
-    std::cout << "Opening .obj dataset from :\n- " << datasetPath << std::endl;
+    RTAC_LOG_DEBUG("Opening .obj dataset from " << datasetPath);
 
     objPath_ = rtac::files::find_one(".*\\obj", datasetPath);
     if(objPath_ == rtac::files::NotFound) {
@@ -13,7 +14,7 @@ ObjLoader::ObjLoader(const std::string& datasetPath) :
         oss << "Could not find .obj file in given dataset path " << datasetPath;
         throw std::runtime_error(oss.str());
     }
-    std::cout << "Found .obj file :\n- " << objPath_ << std::endl;
+    RTAC_LOG_DEBUG("Found .obj file " << objPath_);
 
     //mtlPath_ = rtac::files::find_one(".*\\mtl", datasetPath);
     //if(mtlPath_ == rtac::files::NotFound) {
@@ -178,7 +179,7 @@ void ObjLoader::load_geometry(unsigned int chunkSize)
             rtac::files::getline(iss, mtlPath_);
         }
         else {
-            std::cerr << "Unhandled token : '" << token << "'\n";
+            RTAC_LOG_WARNING("Unhandled token in " << objPath_ << " : '" << token << "'");
         }
     } // end of file
 
@@ -203,12 +204,12 @@ void ObjLoader::parse_mtl()
 
     auto path = rtac::files::find_one(std::string(".*") + mtlPath_, datasetPath_);
     if(path == rtac::files::NotFound) {
-        std::cerr << "OBJ file " << objPath_ << " indicates a mtl file "
-                  << mtlPath_ << " but none was found." << std::endl;
+        RTAC_LOG_WARNING("OBJ file " << objPath_ << " indicates a mtl file "
+                         << mtlPath_ << " but none was found.");
         mtlPath_ = "";
     }
     else {
-        std::cout << "Found .mtl file :\n- " << mtlPath_ << std::endl;
+        RTAC_LOG_DEBUG("Found .mtl file " << mtlPath_);
         mtlPath_ = path;
     }
 
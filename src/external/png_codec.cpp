@@ -1,4 +1,5 @@
 #include <rtac_base/external/png_codec.h>
+#include <rtac_base/logging.h>
 
 #include <sstream>
 
@@ -92,21 +93,14 @@ void PNGCodec::png_error_callback(png_struct* handle, png_const_charp msg)
 void PNGCodec::png_warning_callback(png_struct* handle, png_const_charp msg)
 {
     auto codec = reinterpret_cast<PNGCodec*>(png_get_error_ptr(handle));
-    std::cerr << "PNG warning : " << msg << std::endl;
+    RTAC_LOG_WARNING("PNG warning : " << msg);
 }
 
 int PNGCodec::read_chunk_callback(const png_unknown_chunk* chunk)
 {
-    std::ostringstream oss;
-    oss << chunk->name[0];
-    oss << chunk->name[1];
-    oss << chunk->name[2];
-    oss << chunk->name[3];
-    oss << chunk->name[4];
-
-    std::cout << "Got unknown png chunk '" << oss.str()
-              << "' (size " << chunk->size
-              << " bytes)." << std::endl;
+    RTAC_LOG_DEBUG("Got unknown png chunk '"
+                   << std::string_view(reinterpret_cast<const char*>(chunk->name), 4)
+                   << "' (size " << chunk->size << " bytes).");
 
     //return -chunk->size; // chunk error
     //return           0;  // chunk not recognized
@@ -3,8 +3,10 @@
  */
 
 #include <rtac_base/files.h>
+#include <rtac_base/logging.h>
 
 #include <cstdlib>
+#include <array>
 #include <regex>
 
 #include <experimental/filesystem>
@@ -334,8 +336,8 @@ void read_ppm(const std::string& path, size_t& width, size_t& height,
         data.resize(3*width*height);
     }
 
-    std::cout << "Reading .ppm file (" << width << "x" << height
-              << ", max value : " << maxValue << ")" << std::endl;
+    RTAC_LOG_DEBUG("Reading .ppm file (" << width << "x" << height
+                   << ", max value : " << maxValue << ")");
 
     if(buf[1] == '3') {
         if(maxValue > 255) {
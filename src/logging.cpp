@@ -0,0 +1,419 @@
+#include <rtac_base/logging.h>
+
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <ctime>
+
+namespace rtac { namespace logging {
+
+const char* to_string(LogLevel level)
+{
+    switch(level) {
+        case LogLevel::Trace:   return "trace";
+        case LogLevel::Debug:   return "debug";
+        case LogLevel::Info:    return "info";
+        case LogLevel::Warning: return "warning";
+        case LogLevel::Error:   return "error";
+        case LogLevel::Off:     return "off";
+    }
+    return "unknown";
+}
+
+LogLevel log_level_from_string(const std::string& name)
+{
+    std::string lower(name);
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    for(int level = 0; level <= static_cast<int>(LogLevel::Off); level++) {
+        if(lower == to_string(static_cast<LogLevel>(level)))
+            return static_cast<LogLevel>(level);
+    }
+    throw std::runtime_error("Unknown log level : " + name);
+}
+
+namespace details {
+
+/**
+ * Stream buffer writing into a fixed-size message slot (output past the end
+ * of the slot is discarded).
+ */
+class SlotStreamBuffer : public std::streambuf
+{
+    protected:
+
+    bool truncated_;
+
+    int_type overflow(int_type) override {
+        truncated_ = true;
+        return traits_type::eof();
+    }
+
+    public:
+
+    void reset(char* data, std::size_t size) {
+        this->setp(data, data + size);
+        truncated_ = false;
+    }
+    std::size_t size()      const { return this->pptr() - this->pbase(); }
+    bool        truncated() const { return truncated_; }
+};
+
+struct ThreadLogState
+{
+    LogBuffer*       buffer     = nullptr;
+    bool             formatting = false;
+    SlotStreamBuffer streamBuffer;
+    std::ostream     stream;
+    std::ostream     nullStream;
+
+    ThreadLogState() : stream(&streamBuffer), nullStream(nullptr) {}
+    ~ThreadLogState() { if(buffer) buffer->release(); }
+};
+
+static thread_local ThreadLogState threadState;
+
+static uint64_t system_now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t steady_now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+LogBuffer::LogBuffer(std::size_t capacity, unsigned int threadIndex) :
+    threadIndex_(threadIndex),
+    inUse_(false),
+    head_(0),
+    dropped_(0),
+    tail_(0),
+    reportedDrops_(0)
+{
+    std::size_t size = 1;
+    while(size < capacity) size <<= 1;
+    slots_ = std::unique_ptr<Slot[]>(new Slot[size]);
+    mask_  = size - 1;
+}
+
+int init_log_level()
+{
+    int level = static_cast<int>(LogLevel::Info);
+    if(const char* env = std::getenv("RTAC_LOG_LEVEL")) {
+        try {
+            level = static_cast<int>(log_level_from_string(env));
+        }
+        catch(const std::runtime_error& e) {
+            std::cerr << "Ignoring RTAC_LOG_LEVEL : " << e.what() << std::endl;
+        }
+    }
+    int expected = -1; // Logger::set_level may have been called concurrently
+    logLevel.compare_exchange_strong(expected, level);
+    return logLevel.load();
+}
+
+bool RateLimiter::acquire(uint64_t& suppressed)
+{
+    const Logger& logger = Logger::instance();
+    uint64_t limit = logger.rate_limit();
+    if(limit > 0) {
+        uint64_t now   = steady_now();
+        uint64_t start = windowStart_.load(std::memory_order_relaxed);
+        if(now - start >= logger.rate_window()
+           && windowStart_.compare_exchange_strong(start, now, std::memory_order_relaxed))
+        {
+            count_.store(0, std::memory_order_relaxed);
+        }
+        if(count_.fetch_add(1, std::memory_order_relaxed) >= limit) {
+            suppressed_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+    return true;
+}
+
+LogMessage::LogMessage(LogLevel level, const char* file, unsigned int line,
+                       uint64_t suppressed) :
+    buffer_(nullptr),
+    slot_(nullptr)
+{
+    auto& state = threadState;
+    if(state.formatting) // logging from the formatting of a message is ignored
+        return;
+    if(!state.buffer)
+        state.buffer = Logger::instance().register_thread();
+
+    buffer_ = state.buffer;
+    slot_   = buffer_->reserve();
+    if(!slot_) return;
+
+    slot_->level      = level;
+    slot_->line       = line;
+    slot_->timestamp  = system_now();
+    slot_->file       = file;
+    slot_->suppressed = suppressed;
+
+    state.formatting = true;
+    state.streamBuffer.reset(slot_->text, LogBuffer::MaxMessageSize);
+    state.stream.clear();
+    state.stream.flags(std::ios_base::dec | std::ios_base::skipws);
+    state.stream.precision(6);
+    state.stream.width(0);
+    state.stream.fill(' ');
+}
+
+LogMessage::~LogMessage()
+{
+    if(!slot_) return;
+
+    auto& state = threadState;
+    slot_->length = state.streamBuffer.size();
+    if(state.streamBuffer.truncated())
+        std::memcpy(slot_->text + slot_->length - 3, "...", 3);
+    state.formatting = false;
+
+    LogLevel level = slot_->level;
+    bool halfFull  = buffer_->commit();
+
+    auto& logger = Logger::instance();
+    if(!logger.running_.load(std::memory_order_relaxed)) {
+        logger.flush(); // after shutdown
+    }
+    else {
+        logger.start();
+        if(halfFull || level >= LogLevel::Error)
+            logger.notify();
+    }
+}
+
+std::ostream& LogMessage::stream()
+{
+    return slot_ ? threadState.stream : threadState.nullStream;
+}
+
+}; //namespace details
+
+Logger::Logger() :
+    rateLimit_(20),
+    rateWindow_(1000000000),
+    bufferSize_(DefaultBufferSize),
+    wakeRequested_(false),
+    running_(true),
+    flushInterval_(50000000)
+{}
+
+/**
+ * The logger is never destroyed (it may be used from other static
+ * destructors). Its thread is stopped at exit, after which messages are
+ * written synchronously.
+ */
+Logger& Logger::instance()
+{
+    static Logger* logger = []() {
+        Logger* res = new Logger();
+        std::atexit(&Logger::shutdown);
+        return res;
+    }();
+    return *logger;
+}
+
+void Logger::shutdown()
+{
+    auto& logger = Logger::instance();
+    std::thread thread;
+    {
+        std::lock_guard<std::mutex> lock(logger.wakeMutex_);
+        logger.running_ = false;
+        thread.swap(logger.thread_);
+    }
+    logger.wakeCondition_.notify_one();
+    if(thread.joinable())
+        thread.join();
+    logger.flush();
+}
+
+/**
+ * Starts the flushing thread (on the first committed message : programs
+ * which never log do not pay for it).
+ */
+void Logger::start()
+{
+    std::call_once(started_, [this]() {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        if(running_)
+            thread_ = std::thread(&Logger::run, this);
+    });
+}
+
+void Logger::run()
+{
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    while(running_) {
+        wakeCondition_.wait_for(lock,
+            std::chrono::nanoseconds(flushInterval_.load(std::memory_order_relaxed)),
+            [this]() { return wakeRequested_.load() || !running_.load(); });
+        wakeRequested_ = false;
+        lock.unlock();
+        this->flush();
+        lock.lock();
+    }
+}
+
+/**
+ * Wakes the flushing thread. The notification is done without locking : a
+ * wake up may be missed, in which case messages are written after the flush
+ * interval.
+ */
+void Logger::notify()
+{
+    wakeRequested_.store(true);
+    wakeCondition_.notify_one();
+}
+
+void Logger::set_rate_limit(uint64_t messagesPerWindow, double window)
+{
+    rateWindow_.store(static_cast<uint64_t>(1.0e9*window));
+    rateLimit_.store(messagesPerWindow);
+}
+
+void Logger::set_sink(Sink sink)
+{
+    std::lock_guard<std::mutex> lock(flushMutex_);
+    sink_ = std::move(sink);
+}
+
+void Logger::set_flush_interval(double seconds)
+{
+    flushInterval_.store(static_cast<uint64_t>(1.0e9*std::max(seconds, 1.0e-3)));
+}
+
+void Logger::set_buffer_size(std::size_t messageCount)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    bufferSize_ = std::max<std::size_t>(messageCount, 2);
+}
+
+details::LogBuffer* Logger::register_thread()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(auto& buffer : buffers_) {
+        if(buffer->acquire())
+            return buffer.get();
+    }
+    buffers_.emplace_back(new details::LogBuffer(bufferSize_, buffers_.size()));
+    buffers_.back()->acquire();
+    return buffers_.back().get();
+}
+
+uint64_t Logger::dropped() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t res = 0;
+    for(auto& buffer : buffers_) {
+        res += buffer->dropped();
+    }
+    return res;
+}
+
+void Logger::emit(const LogRecord& record, std::ostream& defaultSink)
+{
+    if(sink_)
+        sink_(record);
+    else
+        format(defaultSink, record);
+}
+
+/**
+ * Writes the pending messages of all threads ordered by timestamp. Messages
+ * are only removed from the buffers after having been written.
+ */
+void Logger::flush()
+{
+    std::lock_guard<std::mutex> lock(flushMutex_);
+    {
+        std::lock_guard<std::mutex> registryLock(mutex_);
+        snapshot_.clear();
+        for(auto& buffer : buffers_) snapshot_.push_back(buffer.get());
+    }
+
+    std::ostringstream defaultSink;
+    pending_.clear();
+    heads_.resize(snapshot_.size());
+    for(std::size_t i = 0; i < snapshot_.size(); i++) {
+        auto buffer = snapshot_[i];
+        if(uint64_t drops = buffer->new_drops()) {
+            std::ostringstream oss;
+            oss << drops << " messages dropped (log buffer full)";
+            auto message = oss.str();
+            this->emit(LogRecord({LogLevel::Warning, details::system_now(),
+                                  buffer->thread_index(), __FILE__, __LINE__, 0,
+                                  std::string_view(message)}), defaultSink);
+        }
+        heads_[i] = buffer->head();
+        for(uint64_t index = buffer->tail(); index < heads_[i]; index++) {
+            pending_.push_back(std::make_pair(&buffer->slot(index), buffer->thread_index()));
+        }
+    }
+
+    std::stable_sort(pending_.begin(), pending_.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first->timestamp < rhs.first->timestamp;
+    });
+    for(const auto& item : pending_) {
+        const auto& slot = *item.first;
+        this->emit(LogRecord({slot.level, slot.timestamp, item.second, slot.file,
+                              slot.line, slot.suppressed,
+                              std::string_view(slot.text, slot.length)}), defaultSink);
+    }
+
+    for(std::size_t i = 0; i < snapshot_.size(); i++) {
+        snapshot_[i]->pop_until(heads_[i]);
+    }
+
+    auto output = defaultSink.str();
+    if(output.size() > 0) {
+        std::cerr.write(output.data(), output.size());
+        std::cerr.flush();
+    }
+}
+
+/**
+ * Default formatting :
+ * 2026-01-01 12:00:00.000000 [warning] (thread 0) file.cpp:12 : message
+ */
+void Logger::format(std::ostream& os, const LogRecord& record)
+{
+    std::time_t seconds = record.timestamp / 1000000000;
+    std::tm date;
+    localtime_r(&seconds, &date);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &date);
+
+    const char* file = std::strrchr(record.file, '/');
+    file = file ? file + 1 : record.file;
+
+    os << buffer << '.' << std::setfill('0') << std::setw(6)
+       << (record.timestamp % 1000000000) / 1000 << std::setfill(' ')
+       << " [" << record.level << "] (thread " << record.threadIndex << ") "
+       << file << ':' << record.line << " : " << record.message;
+    if(record.suppressed > 0)
+        os << " (" << record.suppressed << " similar messages suppressed)";
+    os << '\n';
+}
+
+}; //namespace logging
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, rtac::logging::LogLevel level)
+{
+    os << rtac::logging::to_string(level);
+    return os;
+}
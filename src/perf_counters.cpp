@@ -0,0 +1,218 @@
+#include <rtac_base/perf_counters.h>
+
+#include <cstring>
+#include <cerrno>
+#include <iomanip>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+namespace rtac { namespace time {
+
+// PerfCounterValues implementation //////////////////////////////////////
+double PerfCounterValues::ipc() const
+{
+    if(!validity[Cycles] || !validity[Instructions] || values[Cycles] == 0)
+        return 0.0;
+    return double(values[Instructions]) / values[Cycles];
+}
+
+double PerfCounterValues::per_element(Counter c, std::size_t elementCount) const
+{
+    if(!validity[c] || elementCount == 0)
+        return 0.0;
+    return double(values[c]) / elementCount;
+}
+
+PerfCounterValues& PerfCounterValues::operator+=(const PerfCounterValues& other)
+{
+    for(unsigned int c = 0; c < CounterCount; c++) {
+        values[c]  += other.values[c];
+        validity[c] = validity[c] || other.validity[c];
+    }
+    seconds += other.seconds;
+    return *this;
+}
+
+const char* PerfCounterValues::name(Counter c)
+{
+    switch(c) {
+        case Cycles:       return "cycles";
+        case Instructions: return "instructions";
+        case CacheMisses:  return "cache-misses";
+        case BranchMisses: return "branch-misses";
+        default:           return "unknown";
+    }
+}
+
+std::ostream& PerfCounterValues::print(std::ostream& os, std::size_t elementCount) const
+{
+    auto flags     = os.flags();
+    auto precision = os.precision();
+    os << std::fixed << std::setprecision(3) << "time : " << 1.0e3*seconds << "ms";
+    for(unsigned int c = 0; c < CounterCount; c++) {
+        os << ", " << name((Counter)c) << " : ";
+        if(!validity[c]) {
+            os << "n/a";
+            continue;
+        }
+        os << values[c];
+        if(elementCount > 0)
+            os << " (" << this->per_element((Counter)c, elementCount) << "/elem)";
+    }
+    if(validity[Cycles] && validity[Instructions])
+        os << ", IPC : " << std::setprecision(2) << this->ipc();
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
+
+// PerfCounterGroup implementation ///////////////////////////////////////
+#ifdef __linux__
+
+static int open_counter(uint64_t config, int groupFd)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = PERF_TYPE_HARDWARE;
+    attr.config         = config;
+    attr.disabled       = groupFd < 0 ? 1 : 0; // the group follows its leader
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_ID
+                        | PERF_FORMAT_TOTAL_TIME_ENABLED
+                        | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // pid = 0, cpu = -1 : calling thread on any cpu.
+    return syscall(__NR_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+
+PerfCounterGroup::PerfCounterGroup() :
+    leader_(-1)
+{
+    static const uint64_t configs[PerfCounterValues::CounterCount] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+    ids_.fill(uint64_t(-1));
+    for(unsigned int c = 0; c < PerfCounterValues::CounterCount; c++) {
+        fds_[c] = open_counter(configs[c], leader_);
+        if(fds_[c] < 0) {
+            if(error_.size() > 0) error_ += ", ";
+            error_ += std::string(PerfCounterValues::name((Counter)c))
+                    + " : " + std::strerror(errno);
+            continue;
+        }
+        ioctl(fds_[c], PERF_EVENT_IOC_ID, &ids_[c]);
+        if(leader_ < 0)
+            leader_ = fds_[c];
+    }
+}
+
+PerfCounterGroup::~PerfCounterGroup()
+{
+    // Closing the followers before the leader.
+    for(int c = PerfCounterValues::CounterCount - 1; c >= 0; c--) {
+        if(fds_[c] >= 0)
+            close(fds_[c]);
+    }
+}
+
+void PerfCounterGroup::start()
+{
+    if(leader_ >= 0) {
+        ioctl(leader_, PERF_EVENT_IOC_RESET,  PERF_IOC_FLAG_GROUP);
+        ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    start_ = Clock::now();
+}
+
+PerfCounterValues PerfCounterGroup::stop()
+{
+    auto end = Clock::now();
+    if(leader_ >= 0)
+        ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    auto res = this->read_counters();
+    res.seconds = std::chrono::duration<double>(end - start_).count();
+    return res;
+}
+
+/**
+ * Reads all counters of the group at once. If the PMU was shared with other
+ * groups (multiplexing), the values are scaled by the fraction of time the
+ * group was actually counting.
+ */
+PerfCounterValues PerfCounterGroup::read_counters() const
+{
+    PerfCounterValues res;
+    if(leader_ < 0)
+        return res;
+
+    struct {
+        uint64_t count;
+        uint64_t timeEnabled;
+        uint64_t timeRunning;
+        struct { uint64_t value; uint64_t id; } values[PerfCounterValues::CounterCount];
+    } data;
+    if(read(leader_, &data, sizeof(data)) < 0)
+        return res;
+
+    double scale = 1.0;
+    if(data.timeRunning > 0 && data.timeRunning < data.timeEnabled)
+        scale = double(data.timeEnabled) / data.timeRunning;
+    for(uint64_t i = 0; i < data.count && i < PerfCounterValues::CounterCount; i++) {
+        for(unsigned int c = 0; c < PerfCounterValues::CounterCount; c++) {
+            if(ids_[c] == data.values[i].id) {
+                res.values[c]   = scale*data.values[i].value;
+                res.validity[c] = data.timeRunning > 0;
+            }
+        }
+    }
+    return res;
+}
+
+#else //__linux__
+
+PerfCounterGroup::PerfCounterGroup() :
+    leader_(-1),
+    error_("Hardware counters are only supported on Linux")
+{
+    fds_.fill(-1);
+    ids_.fill(uint64_t(-1));
+}
+
+PerfCounterGroup::~PerfCounterGroup() {}
+
+void PerfCounterGroup::start()
+{
+    start_ = Clock::now();
+}
+
+PerfCounterValues PerfCounterGroup::stop()
+{
+    PerfCounterValues res;
+    res.seconds = std::chrono::duration<double>(Clock::now() - start_).count();
+    return res;
+}
+
+PerfCounterValues PerfCounterGroup::read_counters() const
+{
+    return PerfCounterValues();
+}
+
+#endif //__linux__
+
+}; //namespace time
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::time::PerfCounterValues& values)
+{
+    return values.print(os);
+}
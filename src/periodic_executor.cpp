@@ -0,0 +1,329 @@
+#include <rtac_base/periodic_executor.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace rtac { namespace time {
+
+PeriodicExecutor::PeriodicExecutor(const Options& options) :
+    options_(options),
+    nextId_(0),
+    stop_(false)
+{
+    if(options_.threadCount == 0)
+        options_.threadCount = 1;
+    for(unsigned int i = 0; i < options_.threadCount; i++) {
+        threads_.emplace_back(&PeriodicExecutor::run, this, i);
+    }
+}
+
+PeriodicExecutor::Ptr PeriodicExecutor::Create(const Options& options)
+{
+    return Ptr(new PeriodicExecutor(options));
+}
+
+/**
+ * Running tasks are waited for, no new run is started.
+ */
+PeriodicExecutor::~PeriodicExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for(auto& t : threads_) {
+        t.join();
+    }
+}
+
+PeriodicExecutor::TaskId PeriodicExecutor::add_task(const std::string& name, double period,
+                                                    Task task, double phase)
+{
+    return this->add_task(name, period, std::move(task), Clock::now()
+        + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(phase)));
+}
+
+PeriodicExecutor::TaskId PeriodicExecutor::add_task(const std::string& name, double period,
+                                                    Task task, Clock::time_point firstRelease)
+{
+    if(period <= 0.0)
+        throw std::runtime_error("Invalid period for periodic task " + name);
+    if(!task)
+        throw std::runtime_error("Empty periodic task " + name);
+
+    auto entry = types::Handle<Entry>(new Entry());
+    entry->name   = name;
+    entry->task   = std::move(task);
+    entry->period = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(period));
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entry->id = nextId_++;
+        tasks_[entry->id] = entry;
+        releases_.push_back(Release{firstRelease, entry});
+        std::push_heap(releases_.begin(), releases_.end());
+    }
+    cv_.notify_all();
+    return entry->id;
+}
+
+/**
+ * Removes a task. If it is running, waits for the end of the run (unless
+ * called from the task itself).
+ */
+void PeriodicExecutor::remove_task(TaskId id)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = tasks_.find(id);
+    if(it == tasks_.end())
+        return;
+    auto entry = it->second;
+    tasks_.erase(it);
+    entry->removed = true; // its pending release is discarded by the workers
+    doneCv_.wait(lock, [&]() {
+        return !entry->running || entry->runner == std::this_thread::get_id();
+    });
+}
+
+std::string PeriodicExecutor::error() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return error_;
+}
+
+void PeriodicExecutor::configure_thread(unsigned int workerIndex)
+{
+    #ifdef __linux__
+    std::string error;
+    if(options_.cpus.size() > 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(options_.cpus[workerIndex % options_.cpus.size()], &cpus);
+        int res = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if(res != 0)
+            error += "cpu affinity : " + std::string(std::strerror(res));
+    }
+    if(options_.fifoPriority > 0) {
+        sched_param param;
+        param.sched_priority = options_.fifoPriority;
+        int res = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if(res != 0) {
+            if(error.size() > 0) error += ", ";
+            error += "SCHED_FIFO : " + std::string(std::strerror(res));
+        }
+    }
+    #else
+    std::string error;
+    if(options_.cpus.size() > 0 || options_.fifoPriority > 0)
+        error = "cpu affinity and SCHED_FIFO are only supported on Linux";
+    #endif
+    if(error.size() > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(error_.size() > 0) error_ += "\n";
+        error_ += "worker " + std::to_string(workerIndex) + " : " + error;
+    }
+}
+
+void PeriodicExecutor::run(unsigned int workerIndex)
+{
+    this->configure_thread(workerIndex);
+
+    const auto spin = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options_.spinDuration));
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(!stop_) {
+        if(releases_.empty()) {
+            cv_.wait(lock);
+            continue;
+        }
+        if(releases_.front().entry->removed) {
+            std::pop_heap(releases_.begin(), releases_.end());
+            releases_.pop_back();
+            continue;
+        }
+        auto release = releases_.front().time;
+        if(Clock::now() < release - spin) {
+            // A task with an earlier release may be added while waiting.
+            cv_.wait_until(lock, release - spin);
+            continue;
+        }
+
+        std::pop_heap(releases_.begin(), releases_.end());
+        auto entry = releases_.back().entry;
+        releases_.pop_back();
+        entry->running = true;
+        entry->runner  = std::this_thread::get_id();
+        lock.unlock();
+
+        while(Clock::now() < release);
+        auto start = Clock::now();
+        bool failed = false;
+        try {
+            entry->task();
+        }
+        catch(...) {
+            failed = true;
+        }
+        auto end = Clock::now();
+
+        lock.lock();
+        entry->latency.add(std::chrono::nanoseconds(start - release).count(), 0);
+        entry->execution.add(std::chrono::nanoseconds(end - start).count(), 0);
+        if(failed)
+            entry->errors++;
+
+        auto next = release + entry->period;
+        if(end > next) {
+            auto missed = (end - next) / entry->period + 1;
+            entry->overruns++;
+            entry->skipped += missed;
+            next += missed*entry->period;
+        }
+        entry->running = false;
+        if(!entry->removed) {
+            releases_.push_back(Release{next, entry});
+            std::push_heap(releases_.begin(), releases_.end());
+            cv_.notify_all();
+        }
+        doneCv_.notify_all();
+    }
+}
+
+static PeriodicTaskStats::Timing make_timing(const details::ProfileCounters& counters)
+{
+    PeriodicTaskStats::Timing res;
+    uint64_t count = counters.count.load(std::memory_order_relaxed);
+    if(count == 0)
+        return res;
+    res.mean = 1.0e-9*counters.total.load(std::memory_order_relaxed) / count;
+    res.max  = 1.0e-9*counters.max.load(std::memory_order_relaxed);
+    auto percentile = [&](double p) {
+        uint64_t rank = std::max<uint64_t>(1, std::ceil(p*count));
+        uint64_t cumulated = 0;
+        for(unsigned int b = 0; b < details::ProfileBucketCount; b++) {
+            cumulated += counters.buckets[b].load(std::memory_order_relaxed);
+            if(cumulated >= rank)
+                return std::min(res.max, 1.0e-9*details::profile_bucket_value(b));
+        }
+        return res.max;
+    };
+    res.p50 = percentile(0.50);
+    res.p99 = percentile(0.99);
+    return res;
+}
+
+PeriodicTaskStats PeriodicExecutor::make_stats(const Entry& entry)
+{
+    PeriodicTaskStats res;
+    res.name      = entry.name;
+    res.period    = std::chrono::duration<double>(entry.period).count();
+    res.runs      = entry.execution.count.load(std::memory_order_relaxed);
+    res.overruns  = entry.overruns;
+    res.skipped   = entry.skipped;
+    res.errors    = entry.errors;
+    res.latency   = make_timing(entry.latency);
+    res.execution = make_timing(entry.execution);
+    return res;
+}
+
+PeriodicTaskStats PeriodicExecutor::stats(TaskId id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = tasks_.find(id);
+    if(it == tasks_.end())
+        throw std::runtime_error("Unknown periodic task id " + std::to_string(id));
+    return make_stats(*it->second);
+}
+
+/**
+ * Statistics of all tasks, by order of addition.
+ */
+std::vector<PeriodicTaskStats> PeriodicExecutor::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<const Entry*> entries;
+    for(auto& t : tasks_) entries.push_back(t.second.get());
+    std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) {
+        return a->id < b->id;
+    });
+    std::vector<PeriodicTaskStats> res;
+    for(auto entry : entries) res.push_back(make_stats(*entry));
+    return res;
+}
+
+void PeriodicExecutor::reset_stats()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(auto& t : tasks_) {
+        auto& entry = *t.second;
+        entry.overruns = 0;
+        entry.skipped  = 0;
+        entry.errors   = 0;
+        for(auto counters : {&entry.latency, &entry.execution}) {
+            counters->count.store(0, std::memory_order_relaxed);
+            counters->total.store(0, std::memory_order_relaxed);
+            counters->self.store(0,  std::memory_order_relaxed);
+            counters->max.store(0,   std::memory_order_relaxed);
+            for(auto& b : counters->buckets) {
+                b.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+std::ostream& PeriodicExecutor::print(std::ostream& os) const
+{
+    auto stats = this->stats();
+    std::size_t nameWidth = 8;
+    for(auto& s : stats) nameWidth = std::max(nameWidth, s.name.size() + 2);
+
+    auto flags     = os.flags();
+    auto precision = os.precision();
+    os << "PeriodicExecutor (" << this->thread_count() << " threads, times in us) :\n"
+       << std::left << std::setw(nameWidth) << "task" << std::right
+       << std::setw(12) << "period"
+       << std::setw(10) << "runs"
+       << std::setw(10) << "overruns"
+       << std::setw(10) << "skipped"
+       << std::setw(12) << "lat p50"
+       << std::setw(12) << "lat p99"
+       << std::setw(12) << "lat max"
+       << std::setw(12) << "exec mean"
+       << std::setw(12) << "exec p99"
+       << std::setw(12) << "exec max" << "\n";
+    os << std::fixed << std::setprecision(3);
+    for(auto& s : stats) {
+        os << std::left << std::setw(nameWidth) << s.name << std::right
+           << std::setw(12) << 1.0e6*s.period
+           << std::setw(10) << s.runs
+           << std::setw(10) << s.overruns
+           << std::setw(10) << s.skipped
+           << std::setw(12) << 1.0e6*s.latency.p50
+           << std::setw(12) << 1.0e6*s.latency.p99
+           << std::setw(12) << 1.0e6*s.latency.max
+           << std::setw(12) << 1.0e6*s.execution.mean
+           << std::setw(12) << 1.0e6*s.execution.p99
+           << std::setw(12) << 1.0e6*s.execution.max << "\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
+
+}; //namespace time
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::time::PeriodicExecutor& executor)
+{
+    return executor.print(os);
+}
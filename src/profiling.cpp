@@ -0,0 +1,262 @@
+#include <rtac_base/profiling.h>
+
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace rtac { namespace time {
+
+Profiler::Profiler() :
+    dumpStop_(true)
+{}
+
+Profiler& Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::~Profiler()
+{
+    this->stop_periodic_dump();
+}
+
+/**
+ * Returns the id of a scope name, registering the name if needed.
+ */
+unsigned int Profiler::site_id(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if(it != ids_.end())
+        return it->second;
+    if(names_.size() >= details::ThreadProfile::MaxSites) {
+        throw std::runtime_error("Too many profiling scope names");
+    }
+    unsigned int id = names_.size();
+    names_.push_back(name);
+    ids_[name] = id;
+    return id;
+}
+
+namespace details {
+
+/**
+ * Releases the counters of a thread when it exits.
+ */
+struct ThreadProfileGuard
+{
+    ThreadProfile* profile = nullptr;
+
+    ~ThreadProfileGuard() {
+        if(!profile) return;
+        threadProfile = nullptr;
+        Profiler::instance().release_thread(profile);
+    }
+};
+
+static thread_local ThreadProfileGuard threadProfileGuard;
+
+}; //namespace details
+
+/**
+ * Returns the counters of the calling thread (reusing the counters of an
+ * exited thread if available). They are owned by the profiler.
+ */
+details::ThreadProfile* Profiler::register_thread()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if(freeProfiles_.size() > 0) {
+        threads_.push_back(std::move(freeProfiles_.back()));
+        freeProfiles_.pop_back();
+    }
+    else {
+        threads_.emplace_back(new details::ThreadProfile());
+    }
+    details::threadProfileGuard.profile = threads_.back().get();
+    return threads_.back().get();
+}
+
+/**
+ * Merges the counters of an exited thread into the retired counters and
+ * puts them in the free list, cleared.
+ */
+void Profiler::release_thread(details::ThreadProfile* profile)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(threads_.begin(), threads_.end(),
+                           [profile](const auto& p) { return p.get() == profile; });
+    if(it == threads_.end())
+        return;
+    for(unsigned int site = 0; site < names_.size(); site++) {
+        auto counters = profile->find(site);
+        if(!counters)
+            continue;
+        retired_.counters(site).merge(*counters);
+        counters->clear();
+    }
+    freeProfiles_.push_back(std::move(*it));
+    threads_.erase(it);
+}
+
+std::size_t Profiler::allocated_profiles() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return threads_.size() + freeProfiles_.size();
+}
+
+/**
+ * Merges the counters of all threads. Names are sorted by decreasing total
+ * time. Percentiles are estimated from a histogram (12.5% resolution).
+ */
+std::vector<ProfileStats> Profiler::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    const double secondsPerTick = 1.0e-9*TickClock::nanoseconds_per_tick();
+
+    std::vector<ProfileStats> res;
+    std::vector<uint64_t> histogram(details::ProfileBucketCount);
+    for(unsigned int site = 0; site < names_.size(); site++) {
+        ProfileStats stats;
+        stats.name = names_[site];
+        uint64_t total = 0, self = 0, max = 0;
+        std::fill(histogram.begin(), histogram.end(), 0);
+        auto add = [&](const details::ThreadProfile& thread) {
+            auto counters = thread.find(site);
+            if(!counters)
+                return;
+            stats.count += counters->count.load(std::memory_order_relaxed);
+            total       += counters->total.load(std::memory_order_relaxed);
+            self        += counters->self.load(std::memory_order_relaxed);
+            max = std::max(max, counters->max.load(std::memory_order_relaxed));
+            for(unsigned int b = 0; b < details::ProfileBucketCount; b++) {
+                histogram[b] += counters->buckets[b].load(std::memory_order_relaxed);
+            }
+        };
+        for(auto& thread : threads_) add(*thread);
+        add(retired_);
+        if(stats.count == 0)
+            continue;
+
+        stats.total = secondsPerTick*total;
+        stats.self  = secondsPerTick*self;
+        stats.mean  = stats.total / stats.count;
+        stats.max   = secondsPerTick*max;
+
+        // The histogram may be slightly out of sync with count if a thread
+        // is recording concurrently.
+        uint64_t histogramCount = 0;
+        for(auto c : histogram) histogramCount += c;
+        auto percentile = [&](double p) {
+            uint64_t rank = std::max<uint64_t>(1, std::ceil(p*histogramCount));
+            uint64_t cumulated = 0;
+            for(unsigned int b = 0; b < details::ProfileBucketCount; b++) {
+                cumulated += histogram[b];
+                if(cumulated >= rank)
+                    return std::min(stats.max,
+                                    secondsPerTick*details::profile_bucket_value(b));
+            }
+            return stats.max;
+        };
+        stats.p50 = percentile(0.50);
+        stats.p95 = percentile(0.95);
+        stats.p99 = percentile(0.99);
+        res.push_back(stats);
+    }
+
+    std::sort(res.begin(), res.end(), [](const ProfileStats& a, const ProfileStats& b) {
+        return a.total > b.total;
+    });
+    return res;
+}
+
+/**
+ * Resets all counters. Samples recorded concurrently may be partially lost.
+ */
+void Profiler::reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto clear = [&](const details::ThreadProfile& thread) {
+        for(unsigned int site = 0; site < names_.size(); site++) {
+            if(auto counters = thread.find(site))
+                counters->clear();
+        }
+    };
+    for(auto& thread : threads_) clear(*thread);
+    clear(retired_);
+}
+
+std::ostream& Profiler::print(std::ostream& os) const
+{
+    auto stats = this->stats();
+    std::size_t nameWidth = 8;
+    for(auto& s : stats) nameWidth = std::max(nameWidth, s.name.size() + 2);
+
+    auto flags     = os.flags();
+    auto precision = os.precision();
+    os << "Profiler (times in us) :\n"
+       << std::left << std::setw(nameWidth) << "scope" << std::right
+       << std::setw(10) << "count"
+       << std::setw(12) << "mean"
+       << std::setw(12) << "p50"
+       << std::setw(12) << "p95"
+       << std::setw(12) << "p99"
+       << std::setw(12) << "max"
+       << std::setw(14) << "total"
+       << std::setw(14) << "self" << "\n";
+    os << std::fixed << std::setprecision(3);
+    for(auto& s : stats) {
+        os << std::left << std::setw(nameWidth) << s.name << std::right
+           << std::setw(10) << s.count
+           << std::setw(12) << 1.0e6*s.mean
+           << std::setw(12) << 1.0e6*s.p50
+           << std::setw(12) << 1.0e6*s.p95
+           << std::setw(12) << 1.0e6*s.p99
+           << std::setw(12) << 1.0e6*s.max
+           << std::setw(14) << 1.0e6*s.total
+           << std::setw(14) << 1.0e6*s.self << "\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
+
+/**
+ * Prints the statistics every period seconds from a background thread
+ * (replaces any running periodic dump).
+ */
+void Profiler::start_periodic_dump(double period, std::ostream& os, bool resetAfterDump)
+{
+    this->stop_periodic_dump();
+    dumpStop_ = false;
+    dumpThread_ = std::thread([this, period, &os, resetAfterDump]() {
+        auto duration = std::chrono::duration<double>(period);
+        std::unique_lock<std::mutex> lock(dumpMutex_);
+        while(!dumpCv_.wait_for(lock, duration, [&]{ return dumpStop_; })) {
+            this->print(os) << std::flush;
+            if(resetAfterDump)
+                this->reset();
+        }
+    });
+}
+
+void Profiler::stop_periodic_dump()
+{
+    {
+        std::lock_guard<std::mutex> lock(dumpMutex_);
+        dumpStop_ = true;
+    }
+    dumpCv_.notify_all();
+    if(dumpThread_.joinable())
+        dumpThread_.join();
+}
+
+}; //namespace time
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::time::Profiler& profiler)
+{
+    return profiler.print(os);
+}
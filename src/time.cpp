@@ -1,7 +1,87 @@
 #include <rtac_base/time.h>
 
+#include <fstream>
+#include <string>
+#include <cmath>
+#include <algorithm>
+#include <iomanip>
+
+#ifdef RTAC_HAS_TSC
+#include <cpuid.h>
+#endif
+
 namespace rtac { namespace time {
 
+namespace details {
+
+/**
+ * The TSC is used only if it is invariant (CPUID.80000007H:EDX[8]) and if the
+ * kernel did not reject it as unstable (when the clock source can be read).
+ */
+bool tsc_usable()
+{
+    #ifdef RTAC_HAS_TSC
+    unsigned int eax, ebx, ecx, edx;
+    if(!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) || !(edx & (1u << 8)))
+        return false;
+
+    std::ifstream f("/sys/devices/system/clocksource/clocksource0/current_clocksource");
+    std::string clocksource;
+    if(f >> clocksource)
+        return clocksource == "tsc";
+    return true;
+    #else
+    return false;
+    #endif
+}
+
+// TSC and CLOCK_MONOTONIC values at program start, used as calibration
+// baseline (a long baseline gives a precise rate).
+static std::pair<uint64_t,uint64_t>& tsc_baseline()
+{
+    #ifdef RTAC_HAS_TSC
+    static std::pair<uint64_t,uint64_t> baseline(__rdtsc(), monotonic_ns());
+    #else
+    static std::pair<uint64_t,uint64_t> baseline(0, monotonic_ns());
+    #endif
+    return baseline;
+}
+[[maybe_unused]] static const auto& tscBaselineInit = tsc_baseline();
+
+/**
+ * Returns the TSC period in nanoseconds, measured against CLOCK_MONOTONIC
+ * over at least 20ms since the program start.
+ */
+double tsc_calibrate()
+{
+    #ifdef RTAC_HAS_TSC
+    constexpr uint64_t MinBaseline = 20000000;
+    auto [tsc0, ns0] = tsc_baseline();
+    uint64_t ns = monotonic_ns();
+    if(ns - ns0 < MinBaseline) {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(MinBaseline - (ns - ns0)));
+    }
+    // Reading the TSC between two reads of CLOCK_MONOTONIC and keeping the
+    // tightest pair limits the error caused by preemption.
+    uint64_t bestTsc = 0, bestNs = 0, bestWindow = ~uint64_t(0);
+    for(int i = 0; i < 8; i++) {
+        uint64_t before = monotonic_ns();
+        uint64_t tsc    = __rdtsc();
+        uint64_t after  = monotonic_ns();
+        if(after - before < bestWindow) {
+            bestWindow = after - before;
+            bestTsc    = tsc;
+            bestNs     = before + (after - before) / 2;
+        }
+    }
+    return double(bestNs - ns0) / double(bestTsc - tsc0);
+    #else
+    return 1.0;
+    #endif
+}
+
+}; //namespace details
+
 Clock::Clock()
 {
     this->reset();
@@ -15,20 +95,28 @@ void Clock::reset()
     t0_ = std::chrono::high_resolution_clock::now();
 }
 
-FrameCounter::FrameCounter(int resetCount) :
+FrameCounter::FrameCounter(int resetCount, unsigned int statsWindow) :
     resetCount_(resetCount),
     count_(0),
     t0_(std::chrono::high_resolution_clock::now()),
-    period_(Duration::zero())
-{}
+    period_(Duration::zero()),
+    precisePacing_(false),
+    spinDuration_(100.0e-6),
+    lastMissed_(false)
+{
+    this->set_stats_window(statsWindow);
+}
 
 float FrameCounter::get() const
 {
+    if(precisePacing_ && period_ != Duration::zero())
+        this->wait_deadline();
+
     auto t = std::chrono::high_resolution_clock::now();
     Duration ellapsed(t - t0_);
     float res = count_ / ellapsed.count();
 
-    if(period_ != Duration::zero()) {
+    if(!precisePacing_ && period_ != Duration::zero()) {
         while(ellapsed < period_) {
             std::this_thread::sleep_for(period_ - ellapsed);
             ellapsed = (std::chrono::high_resolution_clock::now() - t0_);
@@ -41,18 +129,112 @@ float FrameCounter::get() const
     }
     count_++;
 
+    this->record_frame();
     return res;
 }
 
+/**
+ * Waits for the current deadline (sleep then spin) and sets the next one.
+ */
+void FrameCounter::wait_deadline() const
+{
+    auto period = std::chrono::duration_cast<SteadyClock::duration>(period_);
+    auto now    = SteadyClock::now();
+    if(deadline_ == SteadyClock::time_point()) {
+        // first frame : released immediately.
+        deadline_ = now + period;
+        return;
+    }
+
+    lastMissed_ = now > deadline_;
+    if(now > deadline_ + period) {
+        deadline_ = now + period;
+        return;
+    }
+
+    auto spin = std::chrono::duration_cast<SteadyClock::duration>(spinDuration_);
+    if(deadline_ - now > spin)
+        std::this_thread::sleep_until(deadline_ - spin);
+    while(SteadyClock::now() < deadline_);
+
+    deadline_ += period;
+}
+
+void FrameCounter::record_frame() const
+{
+    auto now = SteadyClock::now();
+    if(lastFrame_ != SteadyClock::time_point() && periods_.size() > 0) {
+        periods_[windowIndex_] = Duration(now - lastFrame_).count();
+        missed_[windowIndex_]  = lastMissed_;
+        windowIndex_ = (windowIndex_ + 1) % periods_.size();
+        if(windowCount_ < periods_.size())
+            windowCount_++;
+    }
+    lastFrame_  = now;
+    lastMissed_ = false;
+}
+
 void FrameCounter::limit_frame_rate(float fps)
 {
-    if(fps > 1.0e-8)
-        period_ = Duration(1.0 / fps);
+    if(fps > 1.0e-8) {
+        period_   = Duration(1.0 / fps);
+        deadline_ = SteadyClock::time_point();
+    }
 }
 
 void FrameCounter::free_frame_rate()
 {
-    period_ = Duration::zero();
+    period_   = Duration::zero();
+    deadline_ = SteadyClock::time_point();
+}
+
+/**
+ * With precise pacing enabled, the last spinDuration seconds before each
+ * deadline are busy-waited (the calling thread is kept running).
+ */
+void FrameCounter::set_precise_pacing(bool enable, double spinDuration)
+{
+    precisePacing_ = enable;
+    spinDuration_  = Duration(std::max(spinDuration, 0.0));
+    deadline_      = SteadyClock::time_point();
+}
+
+void FrameCounter::set_stats_window(unsigned int frameCount)
+{
+    periods_.assign(frameCount, 0.0);
+    missed_.assign(frameCount, false);
+    this->reset_stats();
+}
+
+void FrameCounter::reset_stats()
+{
+    windowIndex_ = 0;
+    windowCount_ = 0;
+    lastFrame_   = SteadyClock::time_point();
+    lastMissed_  = false;
+}
+
+FrameCounter::Stats FrameCounter::stats() const
+{
+    Stats res;
+    if(windowCount_ == 0)
+        return res;
+
+    res.count     = windowCount_;
+    res.minPeriod = periods_[0];
+    res.maxPeriod = periods_[0];
+    double sum = 0.0, sumSquared = 0.0;
+    for(std::size_t i = 0; i < windowCount_; i++) {
+        res.minPeriod = std::min(res.minPeriod, periods_[i]);
+        res.maxPeriod = std::max(res.maxPeriod, periods_[i]);
+        sum        += periods_[i];
+        sumSquared += periods_[i]*periods_[i];
+        if(missed_[i]) res.missed++;
+    }
+    res.meanPeriod = sum / windowCount_;
+    res.jitter = std::sqrt(std::max(sumSquared / windowCount_
+                                    - res.meanPeriod*res.meanPeriod, 0.0));
+    return res;
 }
 
 std::ostream& FrameCounter::print(std::ostream& os) const
@@ -77,3 +259,19 @@ std::ostream& operator<<(std::ostream& os, const rtac::time::FrameCounter& count
 {
     return counter.print(os);
 }
+
+std::ostream& operator<<(std::ostream& os, const rtac::time::FrameCounter::Stats& stats)
+{
+    auto flags     = os.flags();
+    auto precision = os.precision();
+    os << std::fixed << std::setprecision(3)
+       << "frames : "  << stats.count
+       << ", rate : "  << stats.frame_rate() << "Hz"
+       << ", period (min/mean/max) : " << 1.0e3*stats.minPeriod << "/"
+       << 1.0e3*stats.meanPeriod << "/" << 1.0e3*stats.maxPeriod << "ms"
+       << ", jitter : " << 1.0e3*stats.jitter << "ms"
+       << ", missed : " << stats.missed;
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
@@ -0,0 +1,261 @@
+#include <rtac_base/tracing.h>
+
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+#include <unistd.h>
+
+namespace rtac { namespace time {
+
+namespace details {
+
+TraceBuffer::TraceBuffer(std::size_t capacity, unsigned int threadIndex) :
+    head_(0),
+    clearedAt_(0),
+    exportedAt_(0),
+    inUse_(false),
+    threadIndex_(threadIndex)
+{
+    std::size_t size = 1;
+    while(size < capacity) size <<= 1;
+    events_ = std::unique_ptr<Event[]>(new Event[size]);
+    mask_   = size - 1;
+}
+
+/**
+ * Copies the events currently in the buffer, oldest first. Can be called
+ * from any thread while the owner is recording.
+ */
+std::vector<TraceBuffer::EventCopy> TraceBuffer::events() const
+{
+    // While event #head is being written (head_ is incremented afterwards),
+    // the slot of event #(head - capacity) is being overwritten, so only the
+    // last capacity - 1 events are valid.
+    auto first_valid = [this](uint64_t head) {
+        return head >= this->capacity() ? head - this->capacity() + 1 : 0;
+    };
+    uint64_t head  = head_.load(std::memory_order_acquire);
+    uint64_t first = std::max(first_valid(head),
+                              clearedAt_.load(std::memory_order_relaxed));
+    first = std::min(first, head);
+
+    std::vector<EventCopy> res;
+    res.reserve(head - first);
+    for(uint64_t i = first; i < head; i++) {
+        const Event& event = events_[i & mask_];
+        res.push_back(EventCopy({event.timestamp.load(std::memory_order_relaxed),
+                                 event.name.load(std::memory_order_relaxed),
+                                 event.value.load(std::memory_order_relaxed),
+                                 event.phase.load(std::memory_order_relaxed)}));
+    }
+
+    // Events which were overwritten while being copied are discarded. This
+    // acquire fence pairs with the release fence of record() : if a copied
+    // field was written by a newer event, newHead accounts for that event.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t newHead  = head_.load(std::memory_order_relaxed);
+    uint64_t newFirst = first_valid(newHead);
+    if(newFirst > first) {
+        res.erase(res.begin(), res.begin() + std::min<uint64_t>(newFirst - first, res.size()));
+    }
+    return res;
+}
+
+/**
+ * Drops the events recorded so far. head_ belongs to the owning thread and is
+ * left untouched, the readers skip the events before the clear index
+ * instead. Can be called from any thread.
+ */
+void TraceBuffer::clear()
+{
+    clearedAt_.store(head_.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+/**
+ * Takes ownership of a released buffer whose events are not needed anymore.
+ * The events of the previous owner are cleared. Called with the Tracer lock
+ * held.
+ */
+bool TraceBuffer::acquire()
+{
+    uint64_t head = head_.load(std::memory_order_acquire);
+    if(std::max(exportedAt_.load(std::memory_order_relaxed),
+                clearedAt_.load(std::memory_order_relaxed)) < head)
+        return false;
+    bool expected = false;
+    if(!inUse_.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        return false;
+    clearedAt_.store(head, std::memory_order_relaxed);
+    threadName_.clear();
+    return true;
+}
+
+/**
+ * Releases the trace buffer of a thread when it exits.
+ */
+struct TraceBufferGuard
+{
+    TraceBuffer* buffer = nullptr;
+
+    ~TraceBufferGuard() {
+        if(!buffer) return;
+        traceBuffer = nullptr;
+        buffer->release();
+    }
+};
+
+static thread_local TraceBufferGuard traceBufferGuard;
+
+}; //namespace details
+
+Tracer::Tracer() :
+    bufferSize_(DefaultBufferSize),
+    enabled_(true)
+{}
+
+Tracer& Tracer::instance()
+{
+    static Tracer tracer;
+    return tracer;
+}
+
+details::TraceBuffer* Tracer::register_thread()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    details::TraceBuffer* res = nullptr;
+    for(auto& buffer : buffers_) {
+        if(buffer->capacity() >= bufferSize_ && buffer->acquire()) {
+            res = buffer.get();
+            break;
+        }
+    }
+    if(!res) {
+        buffers_.emplace_back(new details::TraceBuffer(bufferSize_, buffers_.size()));
+        res = buffers_.back().get();
+        res->acquire();
+    }
+    details::traceBufferGuard.buffer = res;
+    return res;
+}
+
+std::size_t Tracer::buffer_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return buffers_.size();
+}
+
+void Tracer::set_buffer_size(std::size_t eventCount)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    bufferSize_ = std::max<std::size_t>(eventCount, 2);
+}
+
+void Tracer::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(auto& buffer : buffers_) {
+        buffer->clear();
+    }
+}
+
+static std::string json_escape(const char* str)
+{
+    std::string res;
+    for(; str && *str; str++) {
+        if(*str == '"' || *str == '\\')
+            res.push_back('\\');
+        res.push_back(*str);
+    }
+    return res;
+}
+
+/**
+ * Writes the events of all threads in the Chrome trace event format
+ * (TickClock timestamps are converted to microseconds relative to the oldest
+ * event).
+ *
+ * End events whose begin event was overwritten are dropped, and scopes still
+ * open at export time are left unterminated (the viewers extend them to the
+ * end of the trace).
+ */
+void Tracer::write_chrome_trace(std::ostream& os) const
+{
+    std::vector<std::vector<details::TraceBuffer::EventCopy>> threadEvents;
+    std::vector<std::pair<unsigned int, std::string>> threads;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for(auto& buffer : buffers_) {
+            // The events recorded after head are not necessarily copied.
+            uint64_t head = buffer->head();
+            threadEvents.push_back(buffer->events());
+            threads.push_back({buffer->thread_index(), buffer->thread_name()});
+            buffer->set_exported(head);
+        }
+    }
+
+    uint64_t t0 = std::numeric_limits<uint64_t>::max();
+    for(auto& events : threadEvents) {
+        if(events.size() > 0)
+            t0 = std::min(t0, events.front().timestamp);
+    }
+
+    auto pid = ::getpid();
+    bool first = true;
+    auto separator = [&]() -> std::ostream& {
+        if(!first) os << ",";
+        first = false;
+        return os << "\n";
+    };
+
+    auto flags     = os.flags();
+    auto precision = os.precision();
+    os << "{\"traceEvents\":[";
+    for(std::size_t t = 0; t < threadEvents.size(); t++) {
+        auto tid = threads[t].first;
+        if(threads[t].second.size() > 0) {
+            separator() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+                        << ",\"tid\":" << tid << ",\"args\":{\"name\":\""
+                        << json_escape(threads[t].second.c_str()) << "\"}}";
+        }
+        int depth = 0;
+        for(auto& event : threadEvents[t]) {
+            if(event.phase == 'B') {
+                depth++;
+            }
+            else if(event.phase == 'E') {
+                if(depth == 0) continue;
+                depth--;
+            }
+            separator() << "{\"name\":\"" << json_escape(event.name)
+                        << "\",\"ph\":\"" << event.phase << "\",\"pid\":" << pid
+                        << ",\"tid\":" << tid << std::fixed << std::setprecision(3)
+                        << ",\"ts\":" << 1.0e-3*TickClock::to_nanoseconds(event.timestamp - t0);
+            if(event.phase == 'C') {
+                os << std::defaultfloat << std::setprecision(17)
+                   << ",\"args\":{\"value\":" << event.value << "}";
+            }
+            else if(event.phase == 'i') {
+                os << ",\"s\":\"t\"";
+            }
+            os << "}";
+        }
+    }
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    os.flags(flags);
+    os.precision(precision);
+}
+
+void Tracer::write_chrome_trace(const std::string& path) const
+{
+    std::ofstream f(path);
+    if(!f.is_open()) {
+        throw std::runtime_error("Could not open file for trace export : " + path);
+    }
+    this->write_chrome_trace(f);
+}
+
+}; //namespace time
+}; //namespace rtac
@@ -0,0 +1,142 @@
+#include <rtac_base/types/BufferPool.h>
+
+namespace rtac { namespace types {
+
+std::ostream& BufferPoolStats::print(std::ostream& os) const
+{
+    uint64_t total = hits + misses;
+    os << "hits : " << hits << ", misses : " << misses;
+    if(total > 0)
+        os << " (hit rate " << (100.0*hits) / total << "%)";
+    os << ", evictions : " << evictions
+       << ", outstanding : " << outstanding
+       << ", cached : " << cachedCount << " (" << cachedBytes << " bytes)";
+    return os;
+}
+
+BufferPool::BufferPool(const Options& options) :
+    options_(options),
+    tick_(0)
+{}
+
+BufferPool::Ptr BufferPool::Create(const Options& options)
+{
+    return Ptr(new BufferPool(options));
+}
+
+/**
+ * Buffers handed out when the pool is destroyed are freed by their Handle.
+ */
+BufferPool::~BufferPool()
+{
+    this->clear();
+}
+
+/**
+ * Returns the most recently released buffer for key, or nullptr on a miss.
+ */
+void* BufferPool::take(const Key& key)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.outstanding++;
+    auto it = free_.find(key);
+    if(it == free_.end() || it->second.empty()) {
+        stats_.misses++;
+        return nullptr;
+    }
+    Entry entry = it->second.back();
+    it->second.pop_back();
+    stats_.hits++;
+    stats_.cachedCount--;
+    stats_.cachedBytes -= entry.bytes;
+    return entry.object;
+}
+
+void BufferPool::give(const Key& key, void* object, std::size_t bytes,
+                      void (*destroy)(void*), bool handedOut)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(handedOut)
+            stats_.outstanding--;
+        if(bytes <= options_.maxCachedBytes) {
+            free_[key].push_back(Entry({object, bytes, destroy, tick_++}));
+            stats_.cachedCount++;
+            stats_.cachedBytes += bytes;
+            object = nullptr;
+            this->evict(options_.maxCachedBytes);
+        }
+        else {
+            stats_.evictions++;
+        }
+    }
+    if(object)
+        destroy(object);
+}
+
+/**
+ * Frees the least recently released buffers until the cached memory is below
+ * maxBytes. Must be called with the mutex locked.
+ */
+void BufferPool::evict(std::size_t maxBytes)
+{
+    while(stats_.cachedBytes > maxBytes) {
+        std::vector<Entry>* oldestList = nullptr;
+        for(auto& item : free_) {
+            // Entries are pushed in release order, the oldest one is first.
+            if(!item.second.empty() && (!oldestList
+               || item.second.front().releaseTick < oldestList->front().releaseTick))
+            {
+                oldestList = &item.second;
+            }
+        }
+        if(!oldestList) break;
+
+        Entry entry = oldestList->front();
+        oldestList->erase(oldestList->begin());
+        stats_.evictions++;
+        stats_.cachedCount--;
+        stats_.cachedBytes -= entry.bytes;
+        entry.destroy(entry.object);
+    }
+}
+
+void BufferPool::set_max_cached_bytes(std::size_t maxBytes)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_.maxCachedBytes = maxBytes;
+    this->evict(maxBytes);
+}
+
+std::size_t BufferPool::max_cached_bytes() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return options_.maxCachedBytes;
+}
+
+void BufferPool::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for(auto& item : free_) {
+        for(auto& entry : item.second) {
+            entry.destroy(entry.object);
+        }
+    }
+    free_.clear();
+    stats_.cachedCount = 0;
+    stats_.cachedBytes = 0;
+}
+
+BufferPool::Stats BufferPool::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+}; //namespace types
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::types::BufferPoolStats& stats)
+{
+    return stats.print(os);
+}
@@ -0,0 +1,284 @@
+#include <rtac_base/types/BuildCache.h>
+
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <thread>
+#include <functional>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <experimental/filesystem>
+
+namespace rtac { namespace types {
+
+namespace fs = std::experimental::filesystem;
+
+// Calls f on each entry file of directory. Stops silently on errors.
+template <class F>
+static void for_each_entry(const std::string& directory, F&& f)
+{
+    std::error_code err;
+    for(fs::directory_iterator it(directory, err), end; !err && it != end; it.increment(err)) {
+        if(it->path().extension() == ".rtcache")
+            f(it->path());
+    }
+}
+
+// MappedFile implementation ///////////////////////////////////////////////
+MappedFile::MappedFile(void* mapping, std::size_t mappingSize, std::size_t offset) :
+    mapping_(mapping),
+    mappingSize_(mappingSize),
+    offset_(offset)
+{}
+
+MappedFile::Ptr MappedFile::Create(const std::string& path, std::size_t offset)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return nullptr;
+
+    struct stat st;
+    if(::fstat(fd, &st) != 0 || (std::size_t)st.st_size < offset || st.st_size == 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    void* mapping = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping stays valid after the file is closed.
+    if(mapping == MAP_FAILED)
+        return nullptr;
+
+    return Ptr(new MappedFile(mapping, st.st_size, offset));
+}
+
+MappedFile::~MappedFile()
+{
+    ::munmap(mapping_, mappingSize_);
+}
+
+// BuildCache implementation ///////////////////////////////////////////////
+BuildCache::BuildCache(const std::string& directory, std::size_t sizeBudget) :
+    directory_(directory),
+    sizeBudget_(sizeBudget),
+    hits_(0),
+    misses_(0)
+{
+    fs::create_directories(directory_);
+    sizeEstimate_ = this->size();
+}
+
+/**
+ * Opens (and creates if needed) a cache in directory.
+ */
+BuildCache::Ptr BuildCache::Create(const std::string& directory, std::size_t sizeBudget)
+{
+    return Ptr(new BuildCache(directory, sizeBudget));
+}
+
+std::string BuildCache::entry_path(uint64_t key) const
+{
+    std::ostringstream oss;
+    oss << directory_ << "/" << std::hex << std::setw(16) << std::setfill('0')
+        << key << ".rtcache";
+    return oss.str();
+}
+
+void BuildCache::set_size_budget(std::size_t budget)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    sizeBudget_ = budget;
+    this->evict_locked();
+}
+
+/**
+ * Maps the cache entry for key. Returns nullptr on a miss (no entry, or an
+ * invalid entry which is then removed).
+ */
+MappedFile::ConstPtr BuildCache::load(uint64_t key) const
+{
+    auto path = this->entry_path(key);
+    auto file = MappedFile::Create(path, HeaderSize);
+    if(!file) {
+        misses_++;
+        return nullptr;
+    }
+
+    const uint64_t* header = (const uint64_t*)file->mapping();
+    if(header[0] != Magic || header[1] != key || header[2] != file->size()) {
+        misses_++;
+        std::remove(path.c_str());
+        return nullptr;
+    }
+
+    // Updating modification time for LRU eviction.
+    ::utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+    hits_++;
+    return file;
+}
+
+/**
+ * Writes an entry for key then evicts old entries if the cache exceeds its
+ * size budget. Returns false if the entry could not be written (or is larger
+ * than the whole budget).
+ */
+bool BuildCache::store(uint64_t key, const void* data, std::size_t size)
+{
+    if(size + HeaderSize > sizeBudget_)
+        return false;
+
+    auto path = this->entry_path(key);
+    std::ostringstream tmpPath;
+    tmpPath << path << ".tmp." << ::getpid() << "."
+            << std::hash<std::thread::id>()(std::this_thread::get_id());
+    {
+        std::ofstream f(tmpPath.str(), std::ios::binary);
+        uint64_t header[HeaderSize / sizeof(uint64_t)] = {Magic, key, size, 0};
+        f.write((const char*)header, HeaderSize);
+        f.write((const char*)data, size);
+        if(!f) {
+            std::remove(tmpPath.str().c_str());
+            return false;
+        }
+    }
+    if(std::rename(tmpPath.str().c_str(), path.c_str()) != 0) {
+        std::remove(tmpPath.str().c_str());
+        return false;
+    }
+
+    // Replacing an existing entry overestimates the size, which only triggers
+    // the next scan earlier.
+    std::lock_guard<std::mutex> lock(mutex_);
+    sizeEstimate_ += size + HeaderSize;
+    if(sizeEstimate_ > sizeBudget_)
+        this->evict_locked();
+    return true;
+}
+
+void BuildCache::remove(uint64_t key)
+{
+    auto path = this->entry_path(key);
+    std::error_code err;
+    auto size = fs::file_size(path, err);
+    if(std::remove(path.c_str()) == 0 && !err) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sizeEstimate_ -= std::min<std::size_t>(size, sizeEstimate_);
+    }
+}
+
+void BuildCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for_each_entry(directory_, [](const fs::path& path) {
+        std::error_code err;
+        fs::remove(path, err);
+    });
+    sizeEstimate_ = 0;
+}
+
+/**
+ * Removes the least recently used entries until the cache fits in its size
+ * budget.
+ */
+void BuildCache::evict()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    this->evict_locked();
+}
+
+/**
+ * Scans the cache directory, evicts entries if needed and updates the size
+ * estimate. Must be called with the mutex locked.
+ */
+void BuildCache::evict_locked()
+{
+    struct Entry {
+        fs::path            path;
+        std::size_t         size;
+        fs::file_time_type  time;
+    };
+    std::vector<Entry> entries;
+    std::size_t total = 0;
+    for_each_entry(directory_, [&](const fs::path& path) {
+        std::error_code err;
+        auto size = fs::file_size(path, err);
+        if(err) return; // removed by another process
+        auto time = fs::last_write_time(path, err);
+        if(err) return;
+        entries.push_back(Entry({path, size, time}));
+        total += size;
+    });
+    sizeEstimate_ = total;
+    if(total <= sizeBudget_)
+        return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        return a.time < b.time;
+    });
+    std::error_code err;
+    for(auto& entry : entries) {
+        if(total <= sizeBudget_)
+            break;
+        fs::remove(entry.path, err);
+        total -= entry.size;
+    }
+    sizeEstimate_ = total;
+}
+
+std::size_t BuildCache::size() const
+{
+    std::size_t total = 0;
+    for_each_entry(directory_, [&](const fs::path& path) {
+        std::error_code err;
+        auto size = fs::file_size(path, err);
+        if(!err) total += size;
+    });
+    return total;
+}
+
+uint64_t BuildCache::hash(const void* data, std::size_t size, uint64_t seed)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    for(std::size_t i = 0; i < size; i++) {
+        seed ^= bytes[i];
+        seed *= 0x100000001b3;
+    }
+    return seed;
+}
+
+// CachedBuildTarget implementation ////////////////////////////////////////
+/**
+ * Key of the cache entry of this target : the parameters hash combined with
+ * the target type name, so that two target types with the same parameters
+ * do not share entries.
+ */
+uint64_t CachedBuildTarget::cache_key() const
+{
+    return BuildCache::hash(this->target_name(),
+                            BuildCache::hash(this->parameters_hash()));
+}
+
+void CachedBuildTarget::build_output() const
+{
+    if(!cache_) {
+        this->do_build();
+        return;
+    }
+
+    uint64_t key = this->cache_key();
+    auto entry = cache_->load(key);
+    if(entry && this->deserialize(entry))
+        return;
+
+    this->do_build();
+
+    std::vector<uint8_t> data;
+    this->serialize(data);
+    cache_->store(key, data.data(), data.size());
+}
+
+}; //namespace types
+}; //namespace rtac
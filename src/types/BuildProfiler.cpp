@@ -0,0 +1,166 @@
+#include <rtac_base/types/BuildProfiler.h>
+
+#include <iomanip>
+#include <algorithm>
+
+#include <rtac_base/types/BuildTarget.h>
+
+namespace rtac { namespace types {
+
+std::atomic<BuildProfiler*> BuildProfiler::active_(nullptr);
+
+BuildProfiler::BuildProfiler() :
+    t0_(Clock::now())
+{}
+
+BuildProfiler::Ptr BuildProfiler::Create()
+{
+    return Ptr(new BuildProfiler());
+}
+
+BuildProfiler::~BuildProfiler()
+{
+    this->stop();
+}
+
+/**
+ * Makes this profiler the active one (replacing any other active profiler).
+ */
+void BuildProfiler::start()
+{
+    active_.store(this, std::memory_order_release);
+}
+
+/**
+ * Stops recording if this is the active profiler. The profiler must not be
+ * destroyed while builds which started with it active are still running.
+ */
+void BuildProfiler::stop()
+{
+    BuildProfiler* expected = this;
+    active_.compare_exchange_strong(expected, nullptr);
+}
+
+void BuildProfiler::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.clear();
+}
+
+void BuildProfiler::record(const BuildTarget& target, const BuildTarget* cause,
+                           Clock::time_point start, Clock::time_point end)
+{
+    Event event;
+    event.target   = target.target_name();
+    if(!cause)
+        event.cause = "first build";
+    else if(cause == &target)
+        event.cause = "parameters changed";
+    else
+        event.cause = cause->target_name();
+    event.start    = std::chrono::duration<double>(start - t0_).count();
+    event.duration = std::chrono::duration<double>(end - start).count();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto thread = threads_.emplace(std::this_thread::get_id(), threads_.size());
+    event.thread = thread.first->second;
+    events_.push_back(std::move(event));
+}
+
+std::vector<BuildProfiler::Event> BuildProfiler::events() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_;
+}
+
+/**
+ * Per target statistics, sorted by decreasing total build time.
+ */
+std::vector<BuildProfiler::Stats> BuildProfiler::stats() const
+{
+    std::map<std::string, Stats> stats;
+    for(auto& event : this->events()) {
+        auto& s = stats[event.target];
+        s.target = event.target;
+        s.count++;
+        s.total += event.duration;
+        s.max    = std::max(s.max, event.duration);
+        s.causes[event.cause]++;
+    }
+
+    std::vector<Stats> res;
+    for(auto& item : stats) {
+        item.second.mean = item.second.total / item.second.count;
+        res.push_back(item.second);
+    }
+    std::sort(res.begin(), res.end(), [](const Stats& a, const Stats& b) {
+        return a.total > b.total;
+    });
+    return res;
+}
+
+static std::string json_escape(const std::string& str)
+{
+    std::string res;
+    for(auto c : str) {
+        if(c == '"' || c == '\\')
+            res.push_back('\\');
+        res.push_back(c);
+    }
+    return res;
+}
+
+void BuildProfiler::write_chrome_trace(std::ostream& os) const
+{
+    auto events    = this->events();
+    auto flags     = os.flags();
+    auto precision = os.precision();
+    os << "{\"traceEvents\":[";
+    for(std::size_t i = 0; i < events.size(); i++) {
+        if(i > 0) os << ",";
+        os << "\n{\"name\":\"" << json_escape(events[i].target)
+           << "\",\"cat\":\"build\",\"ph\":\"X\",\"pid\":0"
+           << ",\"tid\":"  << events[i].thread
+           << std::fixed << std::setprecision(3)
+           << ",\"ts\":"   << 1.0e6*events[i].start
+           << ",\"dur\":"  << 1.0e6*events[i].duration
+           << ",\"args\":{\"cause\":\"" << json_escape(events[i].cause) << "\"}}";
+    }
+    os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    os.flags(flags);
+    os.precision(precision);
+}
+
+std::ostream& BuildProfiler::print(std::ostream& os) const
+{
+    auto flags     = os.flags();
+    auto precision = os.precision();
+    os << "BuildProfiler :\n"
+       << std::left << std::setw(40) << "target" << std::right
+       << std::setw(8)  << "builds"
+       << std::setw(14) << "total (ms)"
+       << std::setw(14) << "mean (ms)"
+       << std::setw(14) << "max (ms)" << "  causes\n";
+    for(auto& s : this->stats()) {
+        os << std::left << std::setw(40) << s.target << std::right
+           << std::setw(8) << s.count << std::fixed << std::setprecision(3)
+           << std::setw(14) << 1.0e3*s.total
+           << std::setw(14) << 1.0e3*s.mean
+           << std::setw(14) << 1.0e3*s.max << " ";
+        for(auto& cause : s.causes) {
+            os << " " << cause.first << " (" << cause.second << ")";
+        }
+        os << "\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+    return os;
+}
+
+}; //namespace types
+}; //namespace rtac
+
+std::ostream& operator<<(std::ostream& os, const rtac::types::BuildProfiler& profiler)
+{
+    return profiler.print(os);
+}
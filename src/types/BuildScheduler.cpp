@@ -0,0 +1,139 @@
+#include <rtac_base/types/BuildScheduler.h>
+
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <condition_variable>
+
+namespace rtac { namespace types {
+
+BuildScheduler::BuildScheduler(const Executor::Ptr& executor) :
+    executor_(executor)
+{}
+
+BuildScheduler::Ptr BuildScheduler::Create(unsigned int threadCount)
+{
+    if(threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    return Ptr(new BuildScheduler(ThreadExecutor::Create(threadCount)));
+}
+
+BuildScheduler::Ptr BuildScheduler::Create(const Executor::Ptr& executor)
+{
+    if(!executor)
+        return Create();
+    return Ptr(new BuildScheduler(executor));
+}
+
+/**
+ * Fills nodes with the targets needing a build in dependency post-order (the
+ * order in which BuildTarget::build would build them). A target which does
+ * not need a build has no dependency needing a build, so the walk stops
+ * there.
+ */
+void BuildScheduler::collect_dirty(const BuildTarget& target, std::vector<Node>& nodes)
+{
+    constexpr unsigned int Clean = std::numeric_limits<unsigned int>::max();
+    std::unordered_map<const BuildTarget*, unsigned int> visited;
+
+    auto visit = [&](const BuildTarget* t, auto& visit) -> unsigned int {
+        auto it = visited.find(t);
+        if(it != visited.end())
+            return it->second;
+        if(!t->needs_build()) {
+            visited[t] = Clean;
+            return Clean;
+        }
+
+        std::vector<unsigned int> deps;
+        for(auto& dep : t->dependencies()) {
+            unsigned int index = visit(dep.target().get(), visit);
+            if(index != Clean && std::find(deps.begin(), deps.end(), index) == deps.end())
+                deps.push_back(index);
+        }
+
+        unsigned int index = nodes.size();
+        nodes.push_back(Node({t, {}, (unsigned int)deps.size(), nullptr}));
+        for(auto d : deps) {
+            nodes[d].dependents.push_back(index);
+        }
+        visited[t] = index;
+        return index;
+    };
+    visit(&target, visit);
+}
+
+void BuildScheduler::build(const BuildTarget& target) const
+{
+    std::vector<Node> nodes;
+    collect_dirty(target, nodes);
+    if(nodes.size() == 0)
+        return;
+    if(nodes.size() == 1) {
+        nodes[0].target->build_node();
+        return;
+    }
+
+    // Nodes are in serial build order. Once a node failed, the nodes after it
+    // are not started but the nodes before it are still built : one of them
+    // may fail as well, and its exception is the one a serial build throws.
+    std::mutex              mutex;
+    std::condition_variable done;
+    unsigned int            running     = 0;
+    unsigned int            firstFailed = nodes.size();
+
+    std::function<void(unsigned int)> run = [&](unsigned int i) {
+        bool skip;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            skip = i > firstFailed;
+        }
+        if(!skip) {
+            try {
+                nodes[i].target->build_node();
+            }
+            catch(...) {
+                nodes[i].error = std::current_exception();
+            }
+        }
+
+        std::vector<unsigned int> ready;
+        std::lock_guard<std::mutex> lock(mutex);
+        running--;
+        if(nodes[i].error) {
+            firstFailed = std::min(firstFailed, i);
+        }
+        else if(!skip) {
+            for(auto d : nodes[i].dependents) {
+                if(--nodes[d].pending == 0 && d < firstFailed)
+                    ready.push_back(d);
+            }
+        }
+        running += ready.size();
+        for(auto d : ready) {
+            executor_->post([&run, d]() { run(d); });
+        }
+        // Notifying with the lock held : the waiting thread cannot return
+        // (and destroy the locals above) before this task is done with them.
+        if(running == 0)
+            done.notify_all();
+    };
+
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for(unsigned int i = 0; i < nodes.size(); i++) {
+            if(nodes[i].pending == 0) {
+                running++;
+                executor_->post([&run, i]() { run(i); });
+            }
+        }
+        done.wait(lock, [&]{ return running == 0; });
+    }
+
+    if(firstFailed < nodes.size())
+        std::rethrow_exception(nodes[firstFailed].error);
+}
+
+}; //namespace types
+}; //namespace rtac
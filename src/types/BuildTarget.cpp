@@ -1,4 +1,10 @@
 #include <rtac_base/types/BuildTarget.h>
+#include <rtac_base/types/BuildProfiler.h>
+#include <rtac_base/logging.h>
+
+#include <cxxabi.h>
+#include <cstdlib>
+#include <typeinfo>
 
 namespace rtac { namespace types {
 
@@ -34,23 +40,106 @@ BuildTargetHandle::TargetPtr BuildTargetHandle::target() const
 BuildTarget::BuildTarget(const Dependencies& deps) :
     needsBuild_(true),
     version_(0),
-    dependencies_(deps)
+    dependencies_(deps),
+    visited_(0),
+    cause_(nullptr)
+{
+    for(auto& dep : dependencies_) {
+        this->register_dependency(dep);
+    }
+}
+
+// The copy is a new node in the dependency graph. It has the same
+// dependencies but no dependents.
+BuildTarget::BuildTarget(const BuildTarget& other) :
+    BuildTarget(other.dependencies_)
 {}
 
-bool BuildTarget::needs_build() const
+BuildTarget& BuildTarget::operator=(const BuildTarget& other)
 {
-    if(needsBuild_)
-        return true;
+    if(&other == this)
+        return *this;
+    this->unregister_dependencies();
+    dependencies_ = other.dependencies_;
     for(auto& dep : dependencies_) {
-        if(!dep.target()) {
-            std::cerr << "Dep is null !" << std::endl << std::flush;
+        this->register_dependency(dep);
+    }
+    this->bump_version(true);
+    return *this;
+}
+
+BuildTarget::~BuildTarget()
+{
+    this->unregister_dependencies();
+}
+
+void BuildTarget::register_dependency(const BuildTargetHandle& dep) const
+{
+    if(!dep.target()) {
+        RTAC_LOG_ERROR("Null dependency registered on a BuildTarget (ignored)");
+        return;
+    }
+    dep.target()->dependents_.push_back(this);
+}
+
+void BuildTarget::unregister_dependencies() const
+{
+    for(auto& dep : dependencies_) {
+        if(!dep.target())
+            continue;
+        auto& dependents = dep.target()->dependents_;
+        for(auto it = dependents.begin(); it != dependents.end(); it++) {
+            if(*it == this) {
+                dependents.erase(it);
+                break;
+            }
         }
-        if(dep.has_changed()) {
-            this->bump_version(true);
-            return true;
+    }
+}
+
+/**
+ * Returns a new traversal marker. A graph traversal tags each visited target
+ * with its marker, so each target is visited once per traversal without
+ * having to allocate a visited set.
+ */
+uint64_t BuildTarget::next_generation()
+{
+    static std::atomic<uint64_t> generation(0);
+    return ++generation;
+}
+
+/**
+ * Marks all the targets depending (directly or not) on this one as needing a
+ * rebuild and bumps their version.
+ *
+ * A target which already needs a build is not traversed : its own dependents
+ * were invalidated when it was invalidated. Each target is therefore visited
+ * at most once between two builds.
+ */
+void BuildTarget::invalidate_dependents() const
+{
+    // (target, invalidated dependency) pairs
+    std::vector<std::pair<const BuildTarget*, const BuildTarget*>> stack;
+    for(auto dependent : dependents_) {
+        stack.push_back({dependent, this});
+    }
+    while(stack.size() > 0) {
+        auto [target, cause] = stack.back();
+        stack.pop_back();
+        if(target->needsBuild_)
+            continue;
+        target->needsBuild_ = true;
+        target->version_++;
+        target->cause_ = cause;
+        for(auto dependent : target->dependents_) {
+            stack.push_back({dependent, target});
         }
     }
-    return false;
+}
+
+bool BuildTarget::needs_build() const
+{
+    return needsBuild_;
 }
 
 unsigned int BuildTarget::version() const
@@ -60,17 +149,28 @@ unsigned int BuildTarget::version() const
 
 void BuildTarget::bump_version(bool needsRebuild) const
 {
-    if(needsRebuild) needsBuild_ = true;
+    bool wasDirty = needsBuild_;
+    if(needsRebuild) {
+        needsBuild_ = true;
+        if(!wasDirty) cause_ = this;
+    }
     version_++;
+    if(!wasDirty) {
+        this->invalidate_dependents();
+    }
 }
 
 void BuildTarget::add_dependency(const ConstPtr& dep)
 {
-    //this->check_circular_dependencies(dep);
     if(dep->depends_on(this)) {
         throw CircularDependencyError();
     }
     this->dependencies_.push_back(BuildTargetHandle(dep));
+    this->register_dependency(this->dependencies_.back());
+    if(dep->needs_build() && !needsBuild_) {
+        this->bump_version(true);
+        cause_ = dep.get();
+    }
 }
 
 const BuildTarget::Dependencies& BuildTarget::dependencies() const
@@ -78,15 +178,28 @@ const BuildTarget::Dependencies& BuildTarget::dependencies() const
     return dependencies_;
 }
 
+/**
+ * Depth first search in the dependency graph. Each target is visited at
+ * most once, so this is linear in the size of the graph.
+ */
 bool BuildTarget::depends_on(const BuildTarget* other) const
 {
-    if(other == this) {
-        return true;
-    }
-    for(auto& dep : dependencies_) {
-        if(dep.target()->depends_on(other)) {
+    uint64_t generation = next_generation();
+    std::vector<const BuildTarget*> stack({this});
+    visited_ = generation;
+    while(stack.size() > 0) {
+        auto target = stack.back();
+        stack.pop_back();
+        if(target == other) {
             return true;
         }
+        for(auto& dep : target->dependencies_) {
+            auto t = dep.target().get();
+            if(t && t->visited_ != generation) {
+                t->visited_ = generation;
+                stack.push_back(t);
+            }
+        }
     }
     return false;
 }
@@ -107,10 +220,42 @@ void BuildTarget::build() const
         dep.acknowledge();
     }
     
-    this->do_build();
+    this->profiled_build();
     this->needsBuild_ = false;
 }
 
+void BuildTarget::build_node() const
+{
+    this->clean();
+    for(auto& dep : dependencies_) {
+        dep.acknowledge();
+    }
+    this->profiled_build();
+    this->needsBuild_ = false;
+}
+
+
+void BuildTarget::profiled_build() const
+{
+    auto profiler = BuildProfiler::active();
+    if(!profiler) {
+        this->build_output();
+        return;
+    }
+    auto start = BuildProfiler::Clock::now();
+    this->build_output();
+    profiler->record(*this, cause_, start, BuildProfiler::Clock::now());
+}
+
+std::string BuildTarget::target_name() const
+{
+    const char* mangled = typeid(*this).name();
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+    std::string name(status == 0 && demangled ? demangled : mangled);
+    std::free(demangled);
+    return name;
+}
 
 }; //namespace types
 }; //namespace rtac
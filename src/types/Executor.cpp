@@ -0,0 +1,78 @@
+#include <rtac_base/types/Executor.h>
+
+namespace rtac { namespace types {
+
+ThreadExecutor::ThreadExecutor(unsigned int threadCount) :
+    state_(new State())
+{
+    if(threadCount == 0)
+        threadCount = 1;
+    threads_.reserve(threadCount);
+    for(unsigned int i = 0; i < threadCount; i++) {
+        threads_.emplace_back(&ThreadExecutor::run, state_);
+    }
+}
+
+ThreadExecutor::Ptr ThreadExecutor::Create(unsigned int threadCount)
+{
+    return Ptr(new ThreadExecutor(threadCount));
+}
+
+ThreadExecutor::~ThreadExecutor()
+{
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->stop = true;
+        state_->tasks.clear();
+    }
+    state_->cv.notify_all();
+
+    for(auto& thread : threads_) {
+        // The last reference to the executor may be released by one of its
+        // own tasks. The thread cannot join itself, it is detached instead
+        // and will exit as soon as the current task returns.
+        if(thread.get_id() == std::this_thread::get_id())
+            thread.detach();
+        else
+            thread.join();
+    }
+}
+
+void ThreadExecutor::run(Handle<State> state)
+{
+    while(true) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->cv.wait(lock, [&]{ return state->stop || !state->tasks.empty(); });
+            if(state->stop)
+                return;
+            task = std::move(state->tasks.front());
+            state->tasks.pop_front();
+        }
+        try {
+            task();
+        }
+        catch(...) {}
+    }
+}
+
+void ThreadExecutor::post(Task&& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if(state_->stop)
+            return;
+        state_->tasks.push_back(std::move(task));
+    }
+    state_->cv.notify_one();
+}
+
+std::size_t ThreadExecutor::pending() const
+{
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->tasks.size();
+}
+
+}; //namespace types
+}; //namespace rtac
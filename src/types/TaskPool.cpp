@@ -0,0 +1,375 @@
+#include <rtac_base/types/TaskPool.h>
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <chrono>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace rtac { namespace types {
+
+static thread_local const TaskPool* currentPool   = nullptr;
+static thread_local int             currentWorker = -1;
+
+/**
+ * Parses a sysfs cpu list ("0-3,8,10-11").
+ */
+static std::vector<int> parse_cpu_list(const std::string& list)
+{
+    std::vector<int> res;
+    std::istringstream iss(list);
+    std::string item;
+    while(std::getline(iss, item, ',')) {
+        if(item.empty() || item == "\n") continue;
+        auto dash = item.find('-');
+        int first = std::stoi(item.substr(0, dash));
+        int last  = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+        for(int cpu = first; cpu <= last; cpu++) {
+            res.push_back(cpu);
+        }
+    }
+    return res;
+}
+
+static std::vector<int> allowed_cpus()
+{
+    std::vector<int> res;
+    #ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if(sched_getaffinity(0, sizeof(cpus), &cpus) == 0) {
+        for(int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if(CPU_ISSET(cpu, &cpus)) res.push_back(cpu);
+        }
+    }
+    #endif
+    if(res.empty()) {
+        for(unsigned int cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++) {
+            res.push_back(cpu);
+        }
+    }
+    return res;
+}
+
+TaskGroup::TaskGroup(TaskPool& pool) :
+    pool_(pool),
+    pending_(0),
+    cancelled_(false)
+{}
+
+/**
+ * Waits for the remaining tasks (their exceptions are lost).
+ */
+TaskGroup::~TaskGroup()
+{
+    if(pending_.load(std::memory_order_acquire) > 0) {
+        try {
+            this->wait();
+        }
+        catch(...) {}
+    }
+}
+
+void TaskGroup::run(std::function<void()> task)
+{
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    pool_.push(TaskPool::Job({std::move(task), this}));
+}
+
+void TaskGroup::execute(const std::function<void()>& task)
+{
+    if(!cancelled_.load(std::memory_order_relaxed)) {
+        try {
+            task();
+        }
+        catch(...) {
+            std::lock_guard<std::mutex> lock(exceptionMutex_);
+            if(!exception_)
+                exception_ = std::current_exception();
+            cancelled_ = true;
+        }
+    }
+    // The group may be destroyed by the waiting thread as soon as this is
+    // done.
+    pending_.fetch_sub(1, std::memory_order_release);
+}
+
+void TaskGroup::wait()
+{
+    unsigned int idle = 0;
+    while(pending_.load(std::memory_order_acquire) > 0) {
+        if(pool_.try_run_one()) {
+            idle = 0;
+        }
+        else if(++idle < 64) {
+            std::this_thread::yield();
+        }
+        else {
+            // Remaining tasks are long and already running.
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+    }
+
+    std::exception_ptr exception;
+    {
+        std::lock_guard<std::mutex> lock(exceptionMutex_);
+        std::swap(exception, exception_);
+        cancelled_ = false;
+    }
+    if(exception)
+        std::rethrow_exception(exception);
+}
+
+TaskPool::TaskPool(const Options& options) :
+    options_(options),
+    epoch_(0),
+    sleepers_(0),
+    stop_(false),
+    steals_(0)
+{
+    cpus_ = allowed_cpus();
+    if(options_.numaNode >= 0) {
+        auto nodes = numa_nodes();
+        if(options_.numaNode < (int)nodes.size()) {
+            std::vector<int> nodeCpus;
+            for(int cpu : nodes[options_.numaNode]) {
+                if(std::find(cpus_.begin(), cpus_.end(), cpu) != cpus_.end())
+                    nodeCpus.push_back(cpu);
+            }
+            if(nodeCpus.size() > 0)
+                cpus_ = nodeCpus;
+            else
+                error_ = "no allowed cpu on NUMA node " + std::to_string(options_.numaNode);
+        }
+        else {
+            error_ = "unknown NUMA node " + std::to_string(options_.numaNode);
+        }
+    }
+
+    unsigned int threadCount = options_.threadCount;
+    if(threadCount == 0)
+        threadCount = std::max<std::size_t>(1, cpus_.size() - 1);
+
+    for(unsigned int i = 0; i < threadCount; i++) {
+        queues_.emplace_back(new WorkerQueue());
+    }
+    threads_.reserve(threadCount);
+    for(unsigned int i = 0; i < threadCount; i++) {
+        threads_.emplace_back(&TaskPool::run, this, i);
+    }
+}
+
+TaskPool::Ptr TaskPool::Create(const Options& options)
+{
+    return Ptr(new TaskPool(options));
+}
+
+TaskPool::Ptr TaskPool::Create(unsigned int threadCount)
+{
+    Options options;
+    options.threadCount = threadCount;
+    return Create(options);
+}
+
+/**
+ * Pending tasks are discarded (tasks already running are waited for).
+ */
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stop_ = true;
+    }
+    sleepCondition_.notify_all();
+
+    for(auto& thread : threads_) {
+        // Same as ThreadExecutor : the pool may be released by one of its
+        // own tasks.
+        if(thread.get_id() == std::this_thread::get_id())
+            thread.detach();
+        else
+            thread.join();
+    }
+}
+
+TaskPool& TaskPool::global()
+{
+    static Ptr pool = TaskPool::Create();
+    return *pool;
+}
+
+std::string TaskPool::error() const
+{
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    return error_;
+}
+
+int TaskPool::worker_index() const
+{
+    return currentPool == this ? currentWorker : -1;
+}
+
+void TaskPool::configure_thread(unsigned int workerIndex)
+{
+    if(!options_.pinThreads && options_.numaNode < 0)
+        return;
+
+    std::string error;
+    #ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    if(options_.pinThreads) {
+        CPU_SET(cpus_[workerIndex % cpus_.size()], &cpus);
+    }
+    else {
+        for(int cpu : cpus_) CPU_SET(cpu, &cpus);
+    }
+    int res = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if(res != 0)
+        error = "cpu affinity : " + std::string(std::strerror(res));
+    #else
+    error = "cpu affinity is only supported on Linux";
+    #endif
+    if(error.size() > 0) {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        if(error_.size() > 0) error_ += "\n";
+        error_ += "worker " + std::to_string(workerIndex) + " : " + error;
+    }
+}
+
+void TaskPool::run(unsigned int workerIndex)
+{
+    currentPool   = this;
+    currentWorker = workerIndex;
+    this->configure_thread(workerIndex);
+
+    while(!stop_.load()) {
+        // The epoch is read before looking for work, so that a task pushed
+        // after the search prevents the worker from going to sleep.
+        uint64_t epoch = epoch_.load();
+        Job job;
+        if(this->pop(job)) {
+            this->execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepers_++;
+        sleepCondition_.wait(lock, [&]() {
+            return stop_.load() || epoch_.load() != epoch;
+        });
+        sleepers_--;
+    }
+}
+
+void TaskPool::push(Job&& job)
+{
+    int worker = this->worker_index();
+    WorkerQueue& queue = worker >= 0 ? *queues_[worker] : injected_;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    epoch_.fetch_add(1);
+    if(sleepers_.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        sleepCondition_.notify_one();
+    }
+}
+
+/**
+ * Looks for a task : the newest one of the calling worker, then the oldest
+ * one submitted from outside, then the oldest one of another worker.
+ */
+bool TaskPool::pop(Job& job)
+{
+    int worker = this->worker_index();
+    if(worker >= 0) {
+        auto& queue = *queues_[worker];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(!queue.jobs.empty()) {
+            job = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            return true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(injected_.mutex);
+        if(!injected_.jobs.empty()) {
+            job = std::move(injected_.jobs.front());
+            injected_.jobs.pop_front();
+            return true;
+        }
+    }
+
+    std::size_t count = queues_.size();
+    std::size_t start = worker >= 0 ? worker + 1
+                      : std::hash<std::thread::id>()(std::this_thread::get_id());
+    for(std::size_t i = 0; i < count; i++) {
+        std::size_t victim = (start + i) % count;
+        if((int)victim == worker) continue;
+        auto& queue = *queues_[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(!queue.jobs.empty()) {
+            job = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TaskPool::execute(Job& job)
+{
+    if(job.group) {
+        job.group->execute(job.task);
+        return;
+    }
+    try {
+        job.task();
+    }
+    catch(...) {}
+}
+
+bool TaskPool::try_run_one()
+{
+    Job job;
+    if(!this->pop(job))
+        return false;
+    this->execute(job);
+    return true;
+}
+
+void TaskPool::post(Task&& task)
+{
+    if(stop_.load()) return;
+    this->push(Job({std::move(task), nullptr}));
+}
+
+std::vector<std::vector<int>> TaskPool::numa_nodes()
+{
+    std::vector<std::vector<int>> res;
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string list;
+    if(online && std::getline(online, list)) {
+        for(int node : parse_cpu_list(list)) {
+            std::ifstream f("/sys/devices/system/node/node"
+                            + std::to_string(node) + "/cpulist");
+            std::string cpus;
+            if(!f || !std::getline(f, cpus)) continue;
+            if(res.size() <= (std::size_t)node) res.resize(node + 1);
+            res[node] = parse_cpu_list(cpus);
+        }
+    }
+    if(res.empty())
+        res.push_back(allowed_cpus());
+    return res;
+}
+
+}; //namespace types
+}; //namespace rtac
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <csignal>
+using namespace std;
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <rtac_base/allocation_tracker.h>
+#include <rtac_base/types/CallbackQueue.h>
+using namespace rtac::memory;
+
+int main()
+{
+    int errors = 0;
+
+    cout << "Hooks installed : " << AllocationTracker::hooks_installed() << endl;
+    if(!AllocationTracker::hooks_installed()) errors++;
+
+    // Allocations are counted per thread.
+    auto before = AllocationTracker::thread_counters();
+    {
+        std::vector<int> v(1000);
+        v.push_back(1);
+    }
+    auto diff = AllocationTracker::thread_counters() - before;
+    cout << "vector : " << diff << endl;
+    if(diff.allocations != 2 || diff.deallocations != 2) errors++;
+    if(diff.allocatedBytes < 1001*sizeof(int) || diff.allocatedBytes != diff.freedBytes) errors++;
+
+    // (the std::thread state is allocated by this thread, before counting)
+    std::atomic<bool> go(false);
+    std::thread other([&go]() {
+        while(!go) std::this_thread::yield();
+        std::vector<int> v(100);
+    });
+    before = AllocationTracker::thread_counters();
+    go = true;
+    other.join();
+    diff = AllocationTracker::thread_counters() - before;
+    cout << "other thread (seen from this thread) : " << diff << endl;
+    if(diff.allocations != 0) errors++;
+
+    // Scopes
+    {
+        NoAllocationScope outer("outer", AllocationPolicy::Count);
+        int x = 0;
+        for(int i = 0; i < 100; i++) x += i;
+        {
+            NoAllocationScope inner("inner", AllocationPolicy::Count);
+            std::vector<int> v(10);
+            if(inner.violations() != 1) errors++;
+        }
+        cout << "outer scope violations : " << outer.violations()
+             << " (" << outer.bytes() << " bytes)" << endl;
+        if(outer.violations() != 1 || x != 4950) errors++;
+    }
+    {
+        NoAllocationScope scope("reported scope (expected report)");
+        std::vector<int> v(10);
+    }
+
+    // A synchronous CallbackQueue call does not allocate.
+    rtac::types::CallbackQueue<int, const std::vector<float>&> queue;
+    int sum = 0;
+    queue.add_callback([&](int a, const std::vector<float>& v) { sum += a + v.size(); });
+    queue.add_callback([&](int a, const std::vector<float>&)   { sum += a; });
+    std::vector<float> data(16);
+    {
+        NoAllocationScope scope("CallbackQueue::call", AllocationPolicy::Count);
+        for(int i = 0; i < 1000; i++) queue.call(i, data);
+        cout << "CallbackQueue::call allocations : " << scope.violations() << endl;
+        if(scope.violations() != 0) errors++;
+    }
+
+    // Abort policy (in a child process).
+    pid_t pid = fork();
+    if(pid == 0) {
+        NoAllocationScope scope("abort scope", AllocationPolicy::Abort);
+        std::vector<int> v(10);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    bool aborted = WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+    cout << "Abort policy aborted the process : " << aborted << endl;
+    if(!aborted) errors++;
+
+    cout << "Global counters : " << AllocationTracker::global_counters() << endl;
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <cstdio>
+using namespace std;
+
+#include <rtac_base/benchmark.h>
+using namespace rtac::bench;
+
+Result make_result(const std::string& name, double median, double mad, std::size_t count = 20)
+{
+    Result r;
+    r.name        = name;
+    r.family      = name.substr(0, name.find('/'));
+    r.iterations  = 1000;
+    r.time.count  = count;
+    r.time.median = median;
+    r.time.mad    = mad;
+    return r;
+}
+
+bool near(double a, double b) { return std::abs(a - b) <= 1.0e-9*std::max(1.0, std::abs(b)); }
+
+int main()
+{
+    int errors = 0;
+
+    // Robust statistics : the outlier moves the mean but not the median.
+    auto stats = SampleStats::compute({1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0, 9.0, 100.0});
+    cout << "median : " << stats.median << ", mad : " << stats.mad
+         << ", mean : " << stats.mean << ", robust mean : " << stats.robustMean
+         << ", outliers : " << stats.outliers << endl;
+    if(stats.count != 10 || !near(stats.median, 5.5) || !near(stats.mad, 1.4826*2.5)) errors++;
+    if(stats.outliers != 1 || !near(stats.robustMean, 5.0) || !near(stats.mean, 14.5)) errors++;
+    if(!near(stats.min, 1.0) || !near(stats.max, 100.0)) errors++;
+    if(SampleStats::compute({}).count != 0) errors++;
+    stats = SampleStats::compute({2.0, 2.0, 2.0});
+    if(stats.mad != 0.0 || stats.outliers != 0 || !near(stats.robustMean, 2.0)) errors++;
+
+    // Comparisons : changes must exceed both the threshold and the noise.
+    std::vector<Result> olds = {
+        make_result("a/size:1", 1.0e-3, 1.0e-5),
+        make_result("b/size:1", 1.0e-3, 1.0e-5),
+        make_result("c/size:1", 1.0e-3, 1.0e-3), // very noisy
+        make_result("d/size:1", 1.0e-3, 0.0),
+        make_result("gone",     1.0e-3, 1.0e-5),
+    };
+    std::vector<Result> news = {
+        make_result("a/size:1", 1.2e-3, 1.0e-5),
+        make_result("b/size:1", 0.8e-3, 1.0e-5),
+        make_result("c/size:1", 1.2e-3, 1.0e-3),
+        make_result("d/size:1", 1.02e-3, 0.0), // below the 5% threshold
+        make_result("added",    1.0e-3, 1.0e-5),
+    };
+    auto comparisons = compare(olds, news);
+    print_comparisons(cout, comparisons);
+    std::map<std::string, Comparison::Verdict> verdicts;
+    for(auto& c : comparisons) verdicts[c.name] = c.verdict;
+    if(verdicts.size() != 6) errors++;
+    if(verdicts["a/size:1"] != Comparison::Regressed) errors++;
+    if(verdicts["b/size:1"] != Comparison::Improved)  errors++;
+    if(verdicts["c/size:1"] != Comparison::Unchanged) errors++;
+    if(verdicts["d/size:1"] != Comparison::Unchanged) errors++;
+    if(verdicts["gone"]     != Comparison::Missing)   errors++;
+    if(verdicts["added"]    != Comparison::New)       errors++;
+
+    // JSON round trip.
+    news[0].params = {{"size", 1}};
+    news[0].time.robustMean = 1.19e-3;
+    news[0].time.outliers   = 2;
+    news[0].bytesPerSecond  = 3.5e9;
+    news[0].counters["cycles"] = 1234.5;
+    news[1].error = "not supported";
+    const std::string path = "benchmark_test.json";
+    write_json(path, "test_suite", news);
+    auto readBack = read_json(path);
+    std::remove(path.c_str());
+    if(readBack.size() != news.size()) {
+        errors++;
+    }
+    else {
+        for(std::size_t i = 0; i < news.size(); i++) {
+            auto& a = news[i];
+            auto& b = readBack[i];
+            if(a.name != b.name || a.family != b.family || a.error != b.error) errors++;
+            if(!a.error.empty()) continue;
+            if(a.params != b.params || a.iterations != b.iterations
+               || a.time.count != b.time.count || a.time.outliers != b.time.outliers
+               || !near(a.time.median, b.time.median) || !near(a.time.mad, b.time.mad)
+               || !near(a.time.robustMean, b.time.robustMean)
+               || !near(a.bytesPerSecond, b.bytesPerSecond) || a.counters != b.counters)
+                errors++;
+        }
+        if(compare(news, readBack).size() != news.size() - 1) errors++;
+        for(auto& c : compare(news, readBack)) {
+            if(c.verdict != Comparison::Unchanged) errors++;
+        }
+    }
+
+    // The output functions leave the stream formatting untouched.
+    std::ostringstream oss;
+    oss << std::setprecision(4);
+    auto flags = oss.flags();
+    print_result(oss, news[0]);
+    print_result(oss, news[1]);
+    print_comparisons(oss, comparisons);
+    write_json(oss, "test_suite", news);
+    if(oss.precision() != 4 || oss.flags() != flags) errors++;
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <vector>
+#include <random>
+using namespace std;
+
+#include <rtac_base/time.h>
+#include <rtac_base/algorithm.h>
+using namespace rtac::algorithm;
+using namespace rtac::types;
+
+struct Datum {
+    float value;
+    int   index;
+};
+
+struct Criterion {
+    float binSize;
+    int operator()(const Datum& d) const { return std::floor(d.value / binSize); }
+};
+
+int check_bins(const std::vector<VectorView<Datum>>& bins, const Criterion& criterion,
+               bool stable)
+{
+    int errors = 0;
+    for(int b = 0; b < bins.size(); b++) {
+        for(int i = 0; i < bins[b].size(); i++) {
+            if(criterion(bins[b][i]) != b) errors++;
+            if(stable && i > 0 && bins[b][i].index < bins[b][i-1].index) errors++;
+        }
+    }
+    return errors;
+}
+
+int main()
+{
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<float> dist(-1.0f, 11.0f);
+    
+    std::size_t N = 1000000;
+    std::vector<Datum> data(N);
+    for(int i = 0; i < N; i++) {
+        data[i] = Datum({dist(gen), i});
+    }
+    Criterion criterion({1.0f});
+
+    Binning binning;
+    std::vector<VectorView<Datum>> bins;
+    rtac::time::Clock clock;
+    binning(data, 10, criterion, bins);
+    cout << "Stable binning   : " << clock.interval() << "s" << endl;
+    for(int b = 0; b < bins.size(); b++) {
+        cout << "bin " << b << " : " << bins[b].size() << endl;
+    }
+    int errors = check_bins(bins, criterion, true);
+
+    binning.set_stable(false);
+    for(int i = 0; i < N; i++) {
+        data[i] = Datum({dist(gen), i});
+    }
+    clock.reset();
+    binning(data, 10, criterion, bins);
+    cout << "Unstable binning : " << clock.interval() << "s" << endl;
+    errors += check_bins(bins, criterion, false);
+
+    auto overlapped = rtac::algorithm::binning(data, 10, criterion, 1);
+    cout << "Overlapped bin 0 : " << overlapped[0].size() << " ("
+         << bins[0].size() + bins[1].size() << " expected)" << endl;
+    if(overlapped[0].size() != bins[0].size() + bins[1].size()) errors++;
+
+    // Negative overlaps are ignored.
+    auto negative = rtac::algorithm::binning(data, 10, criterion, -3);
+    for(int b = 0; b < negative.size(); b++) {
+        if(negative[b].size() != bins[b].size()) errors++;
+    }
+    errors += check_bins(negative, criterion, false);
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
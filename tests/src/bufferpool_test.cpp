@@ -0,0 +1,100 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+using namespace std;
+
+#include <rtac_base/types/BufferPool.h>
+using namespace rtac::types;
+
+int main()
+{
+    int errors = 0;
+    auto pool = BufferPool::Create();
+
+    // Storage is recycled between successive frames.
+    const float* firstData = nullptr;
+    for(int frame = 0; frame < 10; frame++) {
+        SharedVector<float> v = pool->shared_vector<float>(1024);
+        if(frame == 0) firstData = v.data();
+        else if(v.data() != firstData) errors++;
+        if(v.size() != 1024) errors++;
+    }
+    cout << "SharedVector : " << pool->stats() << endl;
+    if(pool->stats().hits != 9 || pool->stats().misses != 1) errors++;
+
+    // Different sizes and types have separate buffers.
+    {
+        auto a = pool->vector<float>(1024);
+        auto b = pool->vector<float>(2048);
+        auto c = pool->vector<double>(1024);
+        if(pool->stats().outstanding != 3) errors++;
+        if(a->data() != firstData || b->size() != 2048 || c->size() != 1024) errors++;
+    }
+
+    // Point clouds and images.
+    {
+        auto cloud = pool->point_cloud(320, 240);
+        cloud.set_pose(PointCloud<>::Pose(PointCloud<>::Pose::Vec3(1,2,3)));
+        auto pc = &cloud.point_cloud();
+        cloud = PointCloud<>();
+        auto cloud2 = pool->point_cloud(320, 240);
+        if(&cloud2.point_cloud() != pc) errors++;
+        if(cloud2.width() != 320 || cloud2.height() != 240) errors++;
+        if(cloud2.pose().translation().norm() != 0.0f) errors++; // state is reset
+
+        auto image = pool->image<uint16_t>({640, 480});
+        if(image.width() != 640 || image.size() != 640*480) errors++;
+    }
+    cout << "Point clouds and images : " << pool->stats() << endl;
+
+    // Memory cap : least recently released buffers are freed first.
+    {
+        auto capped = BufferPool::Create();
+        capped->set_max_cached_bytes(2*1024*sizeof(float));
+        {
+            auto a = capped->vector<float>(1024);
+            auto b = capped->vector<float>(1024);
+            auto c = capped->vector<float>(1024);
+        }
+        auto stats = capped->stats();
+        cout << "Capped : " << stats << endl;
+        if(stats.cachedCount != 2 || stats.evictions != 1) errors++;
+
+        capped->preallocate_vectors<float>(4096, 1); // larger than the cap
+        if(capped->stats().cachedCount != 2) errors++;
+        capped->set_max_cached_bytes(1 << 20);
+        capped->preallocate_point_clouds(100, 100, 2);
+        auto cloud = capped->point_cloud(100, 100);
+        if(capped->stats().hits != 1) errors++;
+    }
+
+    // Handles may outlive the pool.
+    {
+        auto shortLived = BufferPool::Create();
+        auto v = shortLived->vector<int>(16);
+        shortLived.reset();
+        v.reset(); // freed, not returned
+    }
+
+    // Concurrent use.
+    {
+        auto shared = BufferPool::Create();
+        std::vector<std::thread> threads;
+        for(int t = 0; t < 4; t++) {
+            threads.emplace_back([shared]() {
+                for(int i = 0; i < 1000; i++) {
+                    auto v = shared->shared_vector<float>(256 << (i % 3));
+                    v.data()[0] = i;
+                }
+            });
+        }
+        for(auto& t : threads) t.join();
+        auto stats = shared->stats();
+        cout << "Concurrent : " << stats << endl;
+        if(stats.hits + stats.misses != 4000 || stats.outstanding != 0) errors++;
+        if(stats.misses > 12) errors++;
+    }
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
@@ -0,0 +1,126 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cmath>
+#include <unistd.h>
+using namespace std;
+
+#include <rtac_base/types/BuildCache.h>
+using namespace rtac::types;
+
+// Target computing a table of values of a function. The table is used
+// directly from the cache mapping when it was loaded from the cache.
+class TableTarget : public CachedBuildTarget
+{
+    public:
+
+    using Ptr = rtac::types::Handle<TableTarget>;
+
+    protected:
+
+    unsigned int size_;
+    float        scale_;
+
+    mutable std::vector<float>          table_;
+    mutable MappedFile::ConstPtr        cached_;
+    mutable int                         buildCount_;
+
+    TableTarget(unsigned int size, float scale) :
+        size_(size), scale_(scale), buildCount_(0)
+    {}
+
+    void do_build() const {
+        buildCount_++;
+        cached_ = nullptr;
+        table_.resize(size_);
+        for(unsigned int i = 0; i < size_; i++) {
+            table_[i] = scale_*std::sin(0.01f*i);
+        }
+    }
+
+    uint64_t parameters_hash() const {
+        return BuildCache::hash(scale_, BuildCache::hash(size_));
+    }
+
+    void serialize(std::vector<uint8_t>& data) const {
+        data.resize(sizeof(float)*table_.size());
+        std::memcpy(data.data(), table_.data(), data.size());
+    }
+
+    bool deserialize(const MappedFile::ConstPtr& data) const {
+        if(data->size() != sizeof(float)*size_)
+            return false;
+        table_.clear();
+        cached_ = data;
+        return true;
+    }
+
+    public:
+
+    static Ptr Create(unsigned int size, float scale) {
+        return Ptr(new TableTarget(size, scale));
+    }
+
+    void set_scale(float scale) { scale_ = scale; this->bump_version(); }
+
+    int build_count() const { return buildCount_; }
+    const float* table() const {
+        this->build();
+        return cached_ ? (const float*)cached_->data() : table_.data();
+    }
+};
+
+int main()
+{
+    int errors = 0;
+    std::string directory = "/tmp/rtac_buildcache_test_" + std::to_string(::getpid());
+    auto cache = BuildCache::Create(directory, 1 << 20);
+
+    auto target0 = TableTarget::Create(10000, 2.0f);
+    target0->set_cache(cache);
+    float v0 = target0->table()[1234];
+    cout << "First build  : builds " << target0->build_count()
+         << ", hits " << cache->hits() << ", misses " << cache->misses() << endl;
+
+    // Same parameters (e.g. next process start) : loaded from the cache.
+    auto target1 = TableTarget::Create(10000, 2.0f);
+    target1->set_cache(cache);
+    float v1 = target1->table()[1234];
+    cout << "Second build : builds " << target1->build_count()
+         << ", hits " << cache->hits() << ", misses " << cache->misses() << endl;
+    if(target1->build_count() != 0 || cache->hits() != 1 || v0 != v1) errors++;
+
+    target1->set_scale(3.0f);
+    target1->table();
+    if(target1->build_count() != 1 || cache->misses() != 2) errors++;
+
+    // Eviction : 40kB entries in a 100kB cache.
+    cache->set_size_budget(100000);
+    for(int i = 0; i < 5; i++) {
+        target1->set_scale(10.0f + i);
+        target1->table();
+    }
+    cout << "Cache size   : " << cache->size() << " (budget " << cache->size_budget() << ")" << endl;
+    if(cache->size() > cache->size_budget()) errors++;
+
+    cache->clear();
+    if(cache->size() != 0) errors++;
+    ::rmdir(directory.c_str());
+
+    // A missing cache directory does not make builds throw.
+    try {
+        target1->set_scale(20.0f);
+        target1->table();
+        if(cache->store(1, &v0, sizeof(v0))) errors++;
+        cache->evict();
+        if(cache->size() != 0 || cache->load(1)) errors++;
+    }
+    catch(const std::exception& e) {
+        cout << "Unexpected exception : " << e.what() << endl;
+        errors++;
+    }
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
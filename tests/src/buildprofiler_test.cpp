@@ -0,0 +1,77 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <thread>
+using namespace std;
+
+#include <rtac_base/types/BuildTarget.h>
+#include <rtac_base/types/BuildScheduler.h>
+#include <rtac_base/types/BuildProfiler.h>
+using namespace rtac::types;
+
+class Target : public BuildTarget
+{
+    public:
+
+    using Ptr = rtac::types::Handle<Target>;
+
+    protected:
+
+    std::string name_;
+
+    Target(const std::string& name) : name_(name) {}
+
+    void do_build() const {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+
+    public:
+
+    static Ptr Create(const std::string& name) { return Ptr(new Target(name)); }
+
+    std::string target_name() const { return name_; }
+};
+
+int main()
+{
+    int errors = 0;
+
+    auto geometry0 = Target::Create("geometry0");
+    auto geometry1 = Target::Create("geometry1");
+    auto accel     = Target::Create("accel");
+    accel->add_dependency(geometry0);
+    accel->add_dependency(geometry1);
+
+    // Not recorded : no active profiler.
+    accel->build();
+
+    auto profiler = BuildProfiler::Create();
+    profiler->start();
+
+    geometry1->bump_version();
+    accel->build();
+    geometry0->bump_version();
+    BuildScheduler::Create(2)->build(accel);
+    profiler->stop();
+
+    geometry0->bump_version();
+    accel->build(); // not recorded
+
+    cout << *profiler;
+    auto events = profiler->events();
+    if(events.size() != 4) errors++;
+    if(events.size() > 1 && (events[0].target != "geometry1"
+                             || events[0].cause  != "parameters changed"
+                             || events[1].target != "accel"
+                             || events[1].cause  != "geometry1"))
+        errors++;
+
+    std::ostringstream trace;
+    profiler->write_chrome_trace(trace);
+    cout << trace.str();
+    if(trace.str().find("\"cause\":\"geometry0\"") == std::string::npos) errors++;
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdexcept>
+using namespace std;
+
+#include <rtac_base/types/BuildTarget.h>
+#include <rtac_base/types/BuildScheduler.h>
+using namespace rtac::types;
+
+class Target : public BuildTarget
+{
+    public:
+
+    using Ptr = rtac::types::Handle<Target>;
+
+    int id_;
+    bool fails_;
+    int  delayMs_;
+    mutable std::atomic<int> buildCount_;
+
+    static std::atomic<int> running;
+    static std::atomic<int> maxRunning;
+
+    protected:
+
+    Target(int id) : id_(id), fails_(false), delayMs_(20), buildCount_(0) {}
+
+    void do_build() const {
+        int r = ++running;
+        for(int m = maxRunning; r > m && !maxRunning.compare_exchange_weak(m, r););
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMs_));
+        buildCount_++;
+        running--;
+        if(fails_) {
+            throw std::runtime_error("target " + std::to_string(id_) + " failed");
+        }
+    }
+
+    public:
+
+    static Ptr Create(int id) { return Ptr(new Target(id)); }
+};
+std::atomic<int> Target::running(0);
+std::atomic<int> Target::maxRunning(0);
+
+int main()
+{
+    int errors = 0;
+    auto scheduler = BuildScheduler::Create(8);
+
+    // A wide graph : 8 independent targets sharing one dependency, all
+    // feeding a root target.
+    auto shared = Target::Create(0);
+    auto root   = Target::Create(100);
+    std::vector<Target::Ptr> leaves;
+    for(int i = 1; i <= 8; i++) {
+        leaves.push_back(Target::Create(i));
+        leaves.back()->add_dependency(shared);
+        root->add_dependency(leaves.back());
+    }
+    root->add_dependency(shared);
+
+    auto t0 = std::chrono::steady_clock::now();
+    scheduler->build(root);
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    cout << "Wide build : " << 1.0e3*elapsed << "ms, max concurrent builds : "
+         << Target::maxRunning << " (serial build ~ 200ms)" << endl;
+    if(shared->buildCount_ != 1 || root->buildCount_ != 1) errors++;
+    for(auto& leaf : leaves) {
+        if(leaf->buildCount_ != 1) errors++;
+    }
+    if(root->needs_build()) errors++;
+
+    // Only the dirty subgraph is rebuilt.
+    leaves[3]->bump_version();
+    scheduler->build(root);
+    cout << "Partial rebuild : leaf 3 built " << leaves[3]->buildCount_
+         << " times, leaf 2 built " << leaves[2]->buildCount_ << " times (expected 2 1)" << endl;
+    if(leaves[3]->buildCount_ != 2 || leaves[2]->buildCount_ != 1
+       || root->buildCount_ != 2 || shared->buildCount_ != 1)
+        errors++;
+
+    // Exceptions : the first failing target in serial build order is reported.
+    leaves[5]->fails_ = true;
+    leaves[2]->fails_ = true;
+    shared->bump_version();
+    try {
+        scheduler->build(root);
+        errors++;
+    }
+    catch(const std::runtime_error& e) {
+        cout << "Build failed : " << e.what() << " (expected target 3 failed)" << endl;
+        if(std::string(e.what()) != "target 3 failed") errors++;
+    }
+    if(!root->needs_build()) errors++;
+
+    leaves[5]->fails_ = false;
+    leaves[2]->fails_ = false;
+    scheduler->build(root);
+    if(root->needs_build()) errors++;
+
+    // The reported failure does not depend on which target fails first in
+    // time. Serial build order is l1, m, l2, r : m fails after l2 did, but a
+    // serial build would have stopped at m.
+    {
+        auto r  = Target::Create(10);
+        auto m  = Target::Create(11);
+        auto l1 = Target::Create(12);
+        auto l2 = Target::Create(13);
+        m->add_dependency(l1);
+        r->add_dependency(m);
+        r->add_dependency(l2);
+        l1->delayMs_ = 50;
+        l2->delayMs_ = 1;
+        m->fails_  = true;
+        l2->fails_ = true;
+        try {
+            scheduler->build(r);
+            errors++;
+        }
+        catch(const std::runtime_error& e) {
+            cout << "Build failed : " << e.what() << " (expected target 11 failed)" << endl;
+            if(std::string(e.what()) != "target 11 failed") errors++;
+        }
+        if(l1->buildCount_ != 1 || m->buildCount_ != 1 || r->buildCount_ != 0) errors++;
+    }
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
@@ -0,0 +1,158 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <future>
+using namespace std;
+
+#include <rtac_base/types/CallbackQueue.h>
+using namespace rtac::types;
+
+struct Tracked {
+    static std::atomic<int> copies;
+    int value;
+    Tracked(int v = 0) : value(v) {}
+    Tracked(const Tracked& other) : value(other.value) { copies++; }
+    Tracked(Tracked&& other) = default;
+    Tracked& operator=(const Tracked& other) { value = other.value; copies++; return *this; }
+    Tracked& operator=(Tracked&& other) = default;
+};
+std::atomic<int> Tracked::copies(0);
+
+int main()
+{
+    CallbackQueue<int> queue;
+    std::atomic<int> total(0);
+
+    auto id0 = queue.add_callback([&](int v) { total += v; });
+    auto id1 = queue.add_callback([&](int v) { total += 10*v; });
+    cout << "Callback count : " << queue.callback_count() << endl;
+    queue.call(1);
+    cout << "Total : " << total << " (expected 11)" << endl;
+
+    queue.remove_callback(id1);
+    queue.call(1);
+    cout << "Total : " << total << " (expected 12)" << endl;
+
+    // Callbacks are allowed to modify the queue.
+    CallbackQueue<int>::CallbackId selfId;
+    selfId = queue.add_callback([&](int) {
+        queue.remove_callback(selfId);
+        queue.add_callback([&](int v) { total += 100*v; });
+    });
+    queue.call(1);
+    queue.call(1);
+    cout << "Total : " << total << " (expected 114)" << endl;
+    cout << "Callback count : " << queue.callback_count() << " (expected 2)" << endl;
+
+    // Concurrent publishers while callbacks are added and removed.
+    int errors = 0;
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> publishers;
+    for(int i = 0; i < 4; i++) {
+        publishers.emplace_back([&]() {
+            while(!stop) queue.call(0);
+        });
+    }
+    for(int i = 0; i < 10000; i++) {
+        auto id = queue.add_callback([&](int v) { total += v; });
+        if(!queue.remove_callback(id)) errors++;
+    }
+    stop = true;
+    for(auto& t : publishers) t.join();
+    cout << "Callback count : " << queue.callback_count() << " (expected 2)" << endl;
+    if(queue.callback_count() != 2) errors++;
+
+    queue.remove_callback(id0);
+
+    // Asynchronous callbacks. The publisher is never blocked by a slow
+    // subscriber with the DropOldest and KeepLatest policies.
+    using Queue = CallbackQueue<Tracked>;
+    Queue moveQueue;
+    std::atomic<int> received(0);
+    auto asyncId = moveQueue.add_async_callback([&](Tracked v) {
+        received += v.value;
+    });
+    for(int i = 0; i < 100; i++) {
+        moveQueue.call(Tracked(1));
+    }
+    while(moveQueue.async_stats(asyncId).processed < 100) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    cout << "Async received : " << received << " (expected 100)" << endl;
+    if(received != 100) errors++;
+    // call() gives its own copy to each subscriber, then the arguments are
+    // only moved through the asynchronous queue.
+    cout << "Async copies : " << Tracked::copies << " (expected 100)" << endl;
+    if(Tracked::copies != 100) errors++;
+
+    CallbackQueue<int> slowQueue;
+    auto executor = ThreadExecutor::Create(2);
+    std::atomic<int> last(-1);
+    CallbackQueue<int>::AsyncOptions latest;
+    latest.policy   = CallbackQueue<int>::AsyncPolicy::KeepLatest;
+    latest.executor = executor;
+    auto latestId = slowQueue.add_async_callback([&](int v) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        last = v;
+    }, latest);
+    CallbackQueue<int>::AsyncOptions dropping;
+    dropping.policy   = CallbackQueue<int>::AsyncPolicy::DropOldest;
+    dropping.capacity = 4;
+    dropping.executor = executor;
+    auto droppingId = slowQueue.add_async_callback([&](int) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }, dropping);
+    for(int i = 0; i < 50; i++) {
+        slowQueue.call(i);
+    }
+    // processed is incremented after the callback returns : waiting for the
+    // stats rather than for the last value.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    auto stats = slowQueue.async_stats(latestId);
+    while(stats.processed + stats.dropped < 50 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        stats = slowQueue.async_stats(latestId);
+    }
+    cout << "KeepLatest : processed " << stats.processed << ", dropped " << stats.dropped
+         << ", max depth " << stats.maxDepth << ", mean latency "
+         << 1.0e3*stats.meanLatency << "ms" << endl;
+    if(stats.processed + stats.dropped != 50 || stats.maxDepth != 1 || last != 49) errors++;
+    stats = slowQueue.async_stats(droppingId);
+    cout << "DropOldest : dropped " << stats.dropped << ", max depth "
+         << stats.maxDepth << " (expected 4)" << endl;
+    if(stats.maxDepth != 4) errors++;
+    slowQueue.remove_callback(droppingId);
+
+    // Future based single shots : many waiters polled from a single thread.
+    std::vector<std::future<CallbackQueue<int>::ArgsTuple>> futures;
+    for(int i = 0; i < 200; i++) {
+        futures.push_back(queue.next_call());
+    }
+    std::thread caller([&]() { queue.call(42); });
+    int ready = 0;
+    while(ready < (int)futures.size()) {
+        ready = 0;
+        for(auto& f : futures) {
+            if(f.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+                ready++;
+        }
+    }
+    caller.join();
+    int wrongValues = 0;
+    for(auto& f : futures) {
+        if(std::get<0>(f.get()) != 42) wrongValues++;
+    }
+    cout << "Future waiters : " << futures.size() << ", wrong values : " << wrongValues << endl;
+    errors += wrongValues;
+
+    unsigned int callbackCount = queue.callback_count();
+    auto timedOut = queue.wait_next_call(std::chrono::milliseconds(10));
+    cout << "Timed out : " << !timedOut.has_value() << " (expected 1)" << endl;
+    if(timedOut) errors++;
+    if(queue.callback_count() != callbackCount) errors++; // expired waiter removed
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
@@ -0,0 +1,79 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <cmath>
+using namespace std;
+
+#include <rtac_base/time.h>
+using namespace rtac::time;
+
+int main()
+{
+    int errors = 0;
+
+    // Precise pacing at 200Hz with 2ms of work per frame.
+    FrameCounter counter(1, 100);
+    counter.limit_frame_rate(200.0f);
+    counter.set_precise_pacing(true);
+
+    const int N = 200;
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0; i <= N; i++) {
+        counter.get();
+        std::this_thread::sleep_for(2ms);
+    }
+    double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    auto stats = counter.stats();
+    cout << "Precise pacing : " << stats << endl;
+    cout << "Total time for " << N << " frames : " << total << "s" << endl;
+
+    // Only structural properties and loose bounds are checked, timing on a
+    // loaded machine is arbitrarily late.
+    if(stats.count != 100) errors++;
+    // Deadlines are absolute, frames are never released early.
+    if(total < N*5.0e-3) errors++;
+    // No drift : the deadlines do not depend on the work duration (the 2ms of
+    // work per frame would add 40% here).
+    if(total > 1.3*N*5.0e-3) errors++;
+    if(stats.meanPeriod < 4.5e-3 || stats.meanPeriod > 7.5e-3) errors++;
+
+    // A frame which overruns its deadline is counted as missed.
+    counter.reset_stats();
+    for(int i = 0; i < 10; i++) {
+        counter.get();
+        std::this_thread::sleep_for(i == 5 ? 12ms : 1ms);
+    }
+    stats = counter.stats();
+    cout << "With an overrun : " << stats << endl;
+    if(stats.missed < 1) errors++;
+    if(stats.maxPeriod < 12.0e-3) errors++;
+
+    // After a late frame, the deadlines restart from the late frame instead
+    // of releasing the next frames back to back to catch up.
+    counter.reset_stats();
+    counter.get();
+    std::this_thread::sleep_for(20ms);
+    counter.get();
+    auto t1 = std::chrono::steady_clock::now();
+    for(int i = 0; i < 4; i++) {
+        counter.get();
+    }
+    double afterRestart = std::chrono::duration<double>(std::chrono::steady_clock::now() - t1).count();
+    cout << "4 frames after a restart : " << 1.0e3*afterRestart << "ms (expected 20ms)" << endl;
+    if(afterRestart < 3.0*5.0e-3) errors++; // ~0 when catching up
+
+    // Without limit the stats still track the frame rate.
+    counter.free_frame_rate();
+    counter.reset_stats();
+    for(int i = 0; i < 20; i++) {
+        counter.get();
+        std::this_thread::sleep_for(1ms);
+    }
+    stats = counter.stats();
+    cout << "Free frame rate : " << stats << endl;
+    if(stats.count != 19 || stats.missed != 0) errors++;
+    if(stats.minPeriod < 1.0e-3) errors++;
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
@@ -0,0 +1,156 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+using namespace std;
+
+// Trace messages are removed at compile time in this file.
+#define RTAC_LOG_MIN_LEVEL RTAC_LOG_LEVEL_DEBUG
+#include <rtac_base/logging.h>
+using namespace rtac::logging;
+
+struct Entry {
+    LogLevel    level;
+    uint64_t    timestamp;
+    std::string message;
+    uint64_t    suppressed;
+};
+
+std::mutex         entriesMutex;
+std::vector<Entry> entries;
+
+std::vector<Entry> take_entries()
+{
+    Logger::instance().flush();
+    std::lock_guard<std::mutex> lock(entriesMutex);
+    std::vector<Entry> res;
+    res.swap(entries);
+    return res;
+}
+
+int thread_count()
+{
+    std::ifstream f("/proc/self/status");
+    std::string line;
+    while(std::getline(f, line)) {
+        if(line.find("Threads:") == 0) return std::stoi(line.substr(8));
+    }
+    return -1;
+}
+
+void limited(int i)
+{
+    RTAC_LOG_WARNING("limited " << i);
+}
+
+int main()
+{
+    int errors = 0;
+
+    // The flushing thread only starts with the first committed message.
+    RTAC_LOG_DEBUG("filtered before any message");
+    auto& logger = Logger::instance();
+    int threadsBefore = thread_count();
+    logger.set_level(LogLevel::Error);
+    RTAC_LOG_WARNING("filtered before any message");
+    if(thread_count() != threadsBefore) errors++;
+    logger.set_level(LogLevel::Info);
+
+    logger.set_sink([](const LogRecord& record) {
+        Logger::format(std::cout, record);
+        std::lock_guard<std::mutex> lock(entriesMutex);
+        entries.push_back(Entry({record.level, record.timestamp,
+                                 std::string(record.message), record.suppressed}));
+    });
+    logger.set_rate_limit(0);
+
+    // Messages of several threads, ordered by timestamp.
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; t++) {
+        threads.emplace_back([t]() {
+            for(int i = 0; i < 50; i++) {
+                RTAC_LOG_INFO("thread " << t << ", message " << i);
+            }
+        });
+    }
+    for(auto& t : threads) t.join();
+    auto res = take_entries();
+    if(thread_count() != threadsBefore + 1) errors++;
+    uint64_t dropped = logger.dropped();
+    cout << "Multi-thread : " << res.size() << " messages, " << dropped << " dropped" << endl;
+    if(res.size() + dropped != 200) errors++;
+    for(std::size_t i = 1; i < res.size(); i++) {
+        if(res[i].timestamp < res[i-1].timestamp) {
+            cout << "Messages are not ordered" << endl;
+            errors++;
+            break;
+        }
+    }
+
+    // Runtime and compile time filtering.
+    int evaluated = 0;
+    logger.set_level(LogLevel::Warning);
+    RTAC_LOG_INFO("filtered " << evaluated++);
+    RTAC_LOG_WARNING("not filtered");
+    logger.set_level(LogLevel::Trace);
+    RTAC_LOG_TRACE("removed at compile time " << evaluated++);
+    RTAC_LOG_DEBUG("debug");
+    res = take_entries();
+    cout << "Filtering : " << res.size() << " messages, " << evaluated << " evaluated" << endl;
+    if(res.size() != 2 || evaluated != 0) errors++;
+    if(res.size() == 2 && res[0].level != LogLevel::Warning) errors++;
+
+    // Rate limiting of a call site.
+    logger.set_rate_limit(5, 10.0);
+    for(int i = 0; i < 100; i++) limited(i);
+    logger.set_rate_limit(0);
+    limited(100);
+    res = take_entries();
+    cout << "Rate limit : " << res.size() << " messages" << endl;
+    if(res.size() != 6) errors++;
+    if(res.size() == 6 && res.back().suppressed != 95) errors++;
+
+    // Long messages are truncated.
+    RTAC_LOG_ERROR(std::string(1000, 'x'));
+    res = take_entries();
+    if(res.size() != 1 || res[0].message.size() != details::LogBuffer::MaxMessageSize
+       || res[0].message.substr(res[0].message.size() - 3) != "...")
+    {
+        cout << "Truncation failed" << endl;
+        errors++;
+    }
+
+    // Background flush (no explicit flush).
+    logger.set_flush_interval(0.01);
+    RTAC_LOG_INFO("background");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    {
+        std::lock_guard<std::mutex> lock(entriesMutex);
+        cout << "Background flush : " << entries.size() << " messages" << endl;
+        if(entries.size() != 1) errors++;
+        entries.clear();
+    }
+
+    // Full buffers drop messages instead of blocking.
+    logger.set_buffer_size(8);
+    logger.set_flush_interval(10.0);
+    std::thread([]() {
+        for(int i = 0; i < 100; i++) {
+            RTAC_LOG_INFO("burst " << i);
+        }
+    }).join();
+    res = take_entries();
+    uint64_t burstDropped = logger.dropped() - dropped;
+    cout << "Burst : " << res.size() << " messages, " << burstDropped << " dropped" << endl;
+    std::size_t delivered = 0;
+    for(auto& e : res) {
+        if(e.message.find("burst") == 0) delivered++;
+    }
+    if(delivered + burstDropped != 100) errors++;
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
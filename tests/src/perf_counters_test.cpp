@@ -0,0 +1,50 @@
+#include <iostream>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+using namespace std;
+
+#include <rtac_base/perf_counters.h>
+using namespace rtac::time;
+
+int main()
+{
+    int errors = 0;
+
+    PerfCounterGroup counters;
+    if(!counters.available()) {
+        cout << "Hardware counters not available (" << counters.error()
+             << "), measuring time only." << endl;
+    }
+    else if(counters.error().size() > 0) {
+        cout << "Some counters are missing : " << counters.error() << endl;
+    }
+
+    std::vector<float> data(1 << 22);
+    std::iota(data.begin(), data.end(), 0.0f);
+
+    volatile float sink = 0.0f;
+    auto values = counters.measure([&]() {
+        float sum = 0.0f;
+        for(auto v : data) sum += v;
+        sink = sum;
+    });
+    cout << "Sum            : ";
+    values.print(cout, data.size()) << endl;
+    if(values.seconds <= 0.0) errors++;
+    if(values.valid(PerfCounterValues::Instructions)
+       && values.instructions() < data.size() / 16)
+        errors++;
+
+    // Accumulated over several regions.
+    PerfCounterValues total;
+    for(int i = 0; i < 4; i++) {
+        PerfRegion region(counters, total);
+        std::reverse(data.begin(), data.end());
+    }
+    cout << "4 x reverse    : " << total << endl;
+    if(total.seconds <= values.seconds / 100) errors++;
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
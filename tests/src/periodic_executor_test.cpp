@@ -0,0 +1,78 @@
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <cmath>
+using namespace std;
+
+#include <rtac_base/periodic_executor.h>
+using namespace rtac::time;
+
+int main()
+{
+    int errors = 0;
+
+    PeriodicExecutor::Options options;
+    options.threadCount  = 2;
+    options.cpus         = {0};
+    options.fifoPriority = 10;
+    auto executor = PeriodicExecutor::Create(options);
+
+    std::atomic<int> fastCount(0), slowCount(0), overrunCount(0);
+    auto fast = executor->add_task("fast_1kHz", 1.0e-3, [&]() { fastCount++; });
+    auto slow = executor->add_task("slow_100Hz", 10.0e-3, [&]() { slowCount++; });
+    auto overrun = executor->add_task("overrun_200Hz", 5.0e-3, [&]() {
+        overrunCount++;
+        std::this_thread::sleep_for(std::chrono::microseconds(7000));
+    });
+    auto throwing = executor->add_task("throwing_100Hz", 10.0e-3, [&]() {
+        throw std::runtime_error("task error");
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    executor->remove_task(overrun);
+    int overrunCountAfterRemove = overrunCount;
+    cout << *executor << endl;
+    if(executor->error().size() > 0)
+        cout << "Thread configuration errors (expected without privileges) :\n"
+             << executor->error() << endl;
+
+    auto fastStats = executor->stats(fast);
+    auto slowStats = executor->stats(slow);
+    cout << "fast runs : " << fastCount << ", slow runs : " << slowCount
+         << ", overrun runs : " << overrunCountAfterRemove << endl;
+    if(std::abs(fastCount - 500) > 25) errors++;
+    if(std::abs(slowCount - 50)  > 3)  errors++;
+    if(fastStats.runs != (uint64_t)fastCount && fastStats.runs + 1 != (uint64_t)fastCount)
+        errors++;
+    if(fastStats.latency.p50 > 1.0e-3) errors++;
+    if(slowStats.overruns != 0) errors++;
+
+    // 7ms runs at 5ms period : every run overruns and skips one release.
+    if(std::abs(overrunCountAfterRemove - 50) > 3) errors++;
+    if(executor->stats(throwing).errors == 0) errors++;
+
+    // The removed task is not run anymore and its stats are gone.
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    if(overrunCount != overrunCountAfterRemove) errors++;
+    try {
+        executor->stats(overrun);
+        errors++;
+    }
+    catch(const std::runtime_error&) {}
+
+    // Tasks can remove themselves.
+    std::atomic<int> selfCount(0);
+    PeriodicExecutor::TaskId selfId;
+    std::atomic<bool> added(false);
+    selfId = executor->add_task("self_removing", 1.0e-3, [&]() {
+        if(!added) return;
+        if(++selfCount == 5) executor->remove_task(selfId);
+    });
+    added = true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    cout << "self removing task runs : " << selfCount << endl;
+    if(selfCount != 5) errors++;
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
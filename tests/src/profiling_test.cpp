@@ -0,0 +1,74 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <chrono>
+using namespace std;
+
+#include <rtac_base/profiling.h>
+using namespace rtac::time;
+
+void child()
+{
+    RTAC_PROFILE_SCOPE("frame/child");
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void frame()
+{
+    RTAC_PROFILE_SCOPE("frame");
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    child();
+    child();
+}
+
+void empty_scope()
+{
+    RTAC_PROFILE_SCOPE("empty");
+}
+
+int main()
+{
+    int errors = 0;
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; t++) {
+        threads.emplace_back([]() {
+            for(int i = 0; i < 10; i++) frame();
+        });
+    }
+    for(auto& t : threads) t.join();
+
+    // The counters of exited threads are kept and their storage is reused.
+    std::size_t profiles = Profiler::instance().allocated_profiles();
+    for(int t = 0; t < 20; t++) {
+        std::thread([]() { empty_scope(); }).join();
+    }
+    cout << "Allocated thread profiles : " << Profiler::instance().allocated_profiles() << endl;
+    if(Profiler::instance().allocated_profiles() != profiles) errors++;
+
+    for(int i = 0; i < 1000000; i++) {
+        empty_scope();
+    }
+
+    cout << Profiler::instance();
+    for(auto& s : Profiler::instance().stats()) {
+        if(s.name == "frame") {
+            // self time excludes the two children (~2ms of ~3ms)
+            if(s.count != 40 || s.self > 0.5*s.total) errors++;
+        }
+        else if(s.name == "frame/child") {
+            // percentiles have a 12.5% resolution
+            if(s.count != 80 || s.p50 < 0.875e-3 || s.p50 > s.p99 || s.p99 > s.max) errors++;
+        }
+        else if(s.name == "empty") {
+            cout << "Scope overhead : " << 1.0e9*s.total / s.count << "ns (measured part)" << endl;
+            if(s.count != 1000020) errors++;
+        }
+    }
+
+    Profiler::instance().reset();
+    if(Profiler::instance().stats().size() != 0) errors++;
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
@@ -0,0 +1,54 @@
+#include <iostream>
+#include <vector>
+#include <random>
+using namespace std;
+
+#include <rtac_base/reductions.h>
+using namespace rtac::algorithm;
+using namespace rtac::operators;
+
+int main()
+{
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    unsigned int W = 1000, H = 1000;
+    std::vector<float> data(W*H);
+    for(auto& v : data) v = dist(gen);
+    
+    double ref = 0.0;
+    float  refMin = data[0], refMax = data[0];
+    for(auto v : data) {
+        ref += v;
+        refMin = std::min(refMin, v);
+        refMax = std::max(refMax, v);
+    }
+    cout << "Reference sum : " << ref << endl;
+    cout << "Direct        : " << reduce(data.data(), data.size()) << endl;
+    cout << "Pairwise      : " << reduce(data.data(), data.size(), Accumulation::Pairwise) << endl;
+    cout << "Kahan         : " << reduce(data.data(), data.size(), Accumulation::Kahan) << endl;
+    cout << "Product of 2s : " << reduce<float, Multiplication>(
+        std::vector<float>(10, 2.0f).data(), 10) << " (expected 1024)" << endl;
+
+    auto minMaxSum = fused_reduce<float, Minimum, Maximum, Addition>(data.data(), data.size());
+    cout << "Fused min/max/sum : " << minMaxSum[0] << " " << minMaxSum[1] << " "
+         << minMaxSum[2] << " (expected " << refMin << " " << refMax << ")" << endl;
+    int errors = 0;
+    if(minMaxSum[0] != refMin || minMaxSum[1] != refMax) errors++;
+
+    // Reducing the first half of each line, results written every other
+    // element.
+    std::vector<float> lines(2*H);
+    reduce_lines(data.data(), lines.data(), W / 2, H, W, 2);
+    for(unsigned int h = 0; h < H; h++) {
+        double lineRef = 0.0;
+        for(unsigned int w = 0; w < W / 2; w++) lineRef += data[W*h + w];
+        if(std::abs(lineRef - lines[2*h]) > 1.0e-3) errors++;
+    }
+    cout << "Line errors : " << errors << endl;
+
+    std::vector<int> integers(100000, 1);
+    cout << "Integer sum : " << reduce(integers.data(), integers.size()) << endl;
+
+    return errors;
+}
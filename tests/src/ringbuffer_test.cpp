@@ -0,0 +1,154 @@
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <memory>
+using namespace std;
+
+#include <rtac_base/types/Handle.h>
+#include <rtac_base/types/RingBuffer.h>
+#include <rtac_base/types/Image.h>
+#include <rtac_base/types/PointCloud.h>
+using namespace rtac::types;
+
+struct Record {
+    uint64_t index;
+    double   value;
+};
+
+int main()
+{
+    int errors = 0;
+
+    // SPSC : order and completeness between two threads.
+    {
+        SpscRingBuffer<Record> queue(1000);
+        cout << "SPSC capacity : " << queue.capacity() << endl;
+        if(queue.capacity() != 1024) errors++;
+
+        const uint64_t count = 1000000;
+        std::thread producer([&]() {
+            for(uint64_t i = 0; i < count; i++) {
+                while(!queue.try_push(Record({i, 0.5*i})));
+            }
+        });
+        uint64_t expected = 0, outOfOrder = 0;
+        Record record;
+        while(expected < count) {
+            if(queue.try_pop(record)) {
+                if(record.index != expected) outOfOrder++;
+                expected++;
+            }
+        }
+        producer.join();
+        cout << "SPSC out of order : " << outOfOrder << endl;
+        if(outOfOrder != 0 || !queue.empty()) errors++;
+    }
+
+    // Batches
+    {
+        SpscRingBuffer<int> queue(8);
+        std::vector<int> input = {0,1,2,3,4,5,6,7,8,9};
+        auto pushed = queue.try_push_batch(input.begin(), input.size());
+        std::vector<int> output;
+        auto popped = queue.try_pop_batch(std::back_inserter(output), 5);
+        pushed += queue.try_push_batch(input.begin() + pushed, input.size() - pushed);
+        popped += queue.try_pop_batch(std::back_inserter(output), 100);
+        cout << "Batch : pushed " << pushed << ", popped " << popped << endl;
+        if(pushed != 10 || popped != 10 || output != input) errors++;
+    }
+
+    // MPMC : every item is received exactly once.
+    {
+        MpmcRingBuffer<uint64_t> queue(256);
+        const unsigned int producers = 4, consumers = 4;
+        const uint64_t perProducer = 100000;
+        std::atomic<uint64_t> received(0), sum(0);
+        std::vector<std::thread> threads;
+        for(unsigned int p = 0; p < producers; p++) {
+            threads.emplace_back([&, p]() {
+                for(uint64_t i = 0; i < perProducer; i++) {
+                    while(!queue.try_push(p*perProducer + i)) std::this_thread::yield();
+                }
+            });
+        }
+        for(unsigned int c = 0; c < consumers; c++) {
+            threads.emplace_back([&]() {
+                uint64_t value;
+                while(received.load() < producers*perProducer) {
+                    if(queue.try_pop(value)) {
+                        sum += value;
+                        received++;
+                    }
+                    else {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for(auto& t : threads) t.join();
+        uint64_t n = producers*perProducer;
+        cout << "MPMC received : " << received << ", sum ok : " << (sum == n*(n-1)/2) << endl;
+        if(received != n || sum != n*(n-1)/2) errors++;
+    }
+
+    // Handles to frames are moved through the queue and released with it.
+    {
+        using ImageT = Image<float, std::vector>;
+        auto image = std::make_shared<ImageT>(ImageT::Shape({640,480}));
+        PointCloud<> cloud(100, 1);
+        {
+            MpmcRingBuffer<Handle<ImageT>> images(4);
+            SpscRingBuffer<PointCloud<>::Ptr> clouds(4);
+            images.try_push(image);
+            clouds.try_push(cloud);
+            Handle<ImageT> received;
+            images.try_pop(received);
+            if(received != image) errors++;
+            images.try_push(image);
+            if(image.use_count() != 3) errors++;
+        }
+        cout << "Image use count after destruction : " << image.use_count() << endl;
+        if(image.use_count() != 1) errors++;
+        if(PointCloud<>::Ptr(cloud).use_count() != 2) errors++;
+    }
+
+    // Blocking wrapper : consumer sleeps until data arrives, close() wakes it.
+    {
+        BlockingRingBuffer<SpscRingBuffer<int>> queue(4);
+        std::vector<int> received;
+        std::thread consumer([&]() {
+            int value;
+            while(queue.pop(value)) received.push_back(value);
+        });
+        for(int i = 0; i < 100; i++) {
+            if(!queue.push(i)) errors++;
+            if(i % 10 == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        queue.close();
+        consumer.join();
+        cout << "Blocking : received " << received.size() << " items" << endl;
+        if(received.size() != 100 || received.back() != 99) errors++;
+        if(queue.push(0)) errors++;
+
+        BlockingRingBuffer<MpmcRingBuffer<int>> empty(4);
+        int value;
+        auto t0 = std::chrono::steady_clock::now();
+        if(empty.pop_for(value, std::chrono::milliseconds(20))) errors++;
+        if(std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(20)) errors++;
+
+        // A rejected item is not moved from.
+        BlockingRingBuffer<MpmcRingBuffer<std::unique_ptr<int>>> full(2);
+        while(full.try_push(std::make_unique<int>(0)));
+        auto item = std::make_unique<int>(1);
+        if(full.try_push(std::move(item)) || !item) errors++;
+        if(full.push_for(std::move(item), std::chrono::milliseconds(1)) || !item) errors++;
+        full.close();
+        if(full.push(std::move(item)) || !item) errors++;
+    }
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
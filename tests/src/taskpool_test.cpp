@@ -0,0 +1,114 @@
+#include <iostream>
+#include <vector>
+#include <numeric>
+#include <atomic>
+#include <stdexcept>
+#include <future>
+using namespace std;
+
+#include <rtac_base/types/TaskPool.h>
+#include <rtac_base/reductions.h>
+using namespace rtac::types;
+
+int main()
+{
+    int errors = 0;
+    auto pool = TaskPool::Create(4);
+    cout << "Worker count : " << pool->thread_count() << endl;
+
+    // parallel_for covers the range exactly once.
+    std::vector<int> hits(100000, 0);
+    pool->parallel_for(0, hits.size(), [&](std::size_t begin, std::size_t end) {
+        for(auto i = begin; i < end; i++) hits[i]++;
+    }, 1000);
+    for(auto h : hits) {
+        if(h != 1) { errors++; cout << "parallel_for error" << endl; break; }
+    }
+
+    // parallel_reduce is deterministic.
+    std::vector<double> data(1000000);
+    for(std::size_t i = 0; i < data.size(); i++) data[i] = 1.0 / (i + 1);
+    auto sum = [&]() {
+        return pool->parallel_reduce(0, data.size(), 0.0,
+            [&](std::size_t begin, std::size_t end) {
+                return std::accumulate(data.begin() + begin, data.begin() + end, 0.0);
+            },
+            [](double a, double b) { return a + b; }, 4096);
+    };
+    double sum0 = sum();
+    for(int i = 0; i < 10; i++) {
+        if(sum() != sum0) { errors++; cout << "parallel_reduce not deterministic" << endl; break; }
+    }
+    cout << "Harmonic sum : " << sum0 << endl;
+
+    // Nested parallelism : every outer task runs an inner parallel_for on the
+    // same pool (this would deadlock with blocking waits).
+    std::atomic<int> innerCount(0);
+    pool->parallel_for(0, 64, [&](std::size_t begin, std::size_t end) {
+        for(auto i = begin; i < end; i++) {
+            pool->parallel_for(0, 1000, [&](std::size_t b, std::size_t e) {
+                innerCount += e - b;
+            }, 10);
+        }
+    }, 1);
+    cout << "Nested : " << innerCount << " (expected 64000), steals : "
+         << pool->steals() << endl;
+    if(innerCount != 64000) errors++;
+
+    // Task groups and exceptions.
+    {
+        TaskGroup group(*pool);
+        std::atomic<int> done(0);
+        for(int i = 0; i < 100; i++) {
+            group.run([&done, i]() {
+                if(i == 50) throw std::runtime_error("task 50 failed");
+                done++;
+            });
+        }
+        try {
+            group.wait();
+            cout << "Exception not propagated" << endl;
+            errors++;
+        }
+        catch(const std::runtime_error& e) {
+            cout << "Caught : " << e.what() << " (" << done << " tasks done)" << endl;
+        }
+
+        // The group can be reused after an exception.
+        done = 0;
+        for(int i = 0; i < 10; i++) group.run([&done]() { done++; });
+        group.wait();
+        if(done != 10) errors++;
+    }
+
+    // Executor interface.
+    {
+        std::promise<int> promise;
+        auto future = promise.get_future();
+        Executor& executor = *pool;
+        executor.post([&promise]() { promise.set_value(42); });
+        if(future.get() != 42) errors++;
+    }
+
+    // Reductions now run on the global pool.
+    std::vector<float> ones(1 << 20, 1.0f);
+    float total = rtac::algorithm::reduce(ones.data(), ones.size(),
+                                          rtac::algorithm::Accumulation::Direct, 8);
+    cout << "reduce : " << total << endl;
+    if(total != ones.size()) errors++;
+
+    auto nodes = TaskPool::numa_nodes();
+    cout << "NUMA nodes : " << nodes.size() << ", node 0 cpus : " << nodes[0].size() << endl;
+    TaskPoolOptions options;
+    options.numaNode   = 0;
+    options.pinThreads = true;
+    auto pinned = TaskPool::Create(options);
+    cout << "Pinned pool : " << pinned->thread_count() << " workers, error : '"
+         << pinned->error() << "'" << endl;
+    std::atomic<int> pinnedCount(0);
+    pinned->parallel_for(0, 1000, [&](std::size_t b, std::size_t e) { pinnedCount += e - b; }, 1);
+    if(pinnedCount != 1000) errors++;
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
@@ -0,0 +1,134 @@
+#include <iostream>
+#include <vector>
+#include <cmath>
+using namespace std;
+
+#include <rtac_base/types/TextureSampler2D.h>
+#include <rtac_base/types/HostMapping.h>
+using namespace rtac::types;
+using namespace rtac;
+
+using Sampler = TextureSampler2D<float>;
+
+struct NormalizerUV {
+    using InputT  = Point2<float>;
+    using OutputT = Point2<float>;
+
+    Point2<float> size;
+
+    Point2<float> operator()(const Point2<float>& p) const {
+        return Point2<float>({p.x / size.x, p.y / size.y});
+    }
+};
+
+int check_batched(const Sampler& sampler, const std::vector<float>& u,
+                                         const std::vector<float>& v)
+{
+    std::vector<float> batched(u.size());
+    sampler.fetch(u.data(), v.data(), batched.data(), u.size());
+
+    int errors = 0;
+    for(int i = 0; i < u.size(); i++) {
+        if(std::abs(batched[i] - sampler(u[i], v[i])) > 1.0e-6f)
+            errors++;
+    }
+    return errors;
+}
+
+int main()
+{
+    // 4x2 texture
+    std::vector<float> data({0.0f, 1.0f, 2.0f, 3.0f,
+                             4.0f, 5.0f, 6.0f, 7.0f});
+    Sampler sampler;
+    sampler.set_image(4, 2, data.data());
+    cout << sampler << endl;
+
+    // Nearest, normalized, repeat (default Texture2D configuration)
+    cout << "Nearest  : " << sampler(0.0f, 0.0f) << " "
+                          << sampler(0.99f, 0.99f) << " "
+                          << sampler(1.0f, 0.0f)   << " (expected 0 7 0)" << endl;
+
+    // Linear, texel centers
+    sampler.set_filter_mode(Sampler::FilterLinear);
+    cout << "Linear   : " << sampler(0.125f, 0.25f) << " "
+                          << sampler(0.25f,  0.25f) << " "
+                          << sampler(0.25f,  0.5f)  << " (expected 0 0.5 2.5)" << endl;
+
+    // Clamp / mirror / border on each axis
+    sampler.set_wrap_mode(Sampler::WrapClamp);
+    cout << "Clamp    : " << sampler(-1.0f, 0.25f) << " " << sampler(2.0f, 0.75f)
+         << " (expected 0 7)" << endl;
+    sampler.set_wrap_mode(Sampler::WrapBorder, Sampler::WrapClamp);
+    sampler.set_border_color(-1.0f);
+    cout << "Border   : " << sampler(-1.0f, 0.25f) << " (expected -1)" << endl;
+    sampler.set_filter_mode(Sampler::FilterNearest);
+    sampler.set_wrap_mode(Sampler::WrapMirror);
+    cout << "Mirror   : " << sampler(1.1f, 0.25f) << " (expected 3)" << endl;
+
+    // Unnormalized coordinates (repeat falls back to clamp)
+    sampler.use_normalized_coordinates(false);
+    sampler.set_wrap_mode(Sampler::WrapRepeat);
+    cout << "Unnorm.  : " << sampler(2.5f, 1.5f) << " " << sampler(10.0f, 0.0f)
+         << " (expected 6 3)" << endl;
+    sampler.use_normalized_coordinates(true);
+
+    // Batched fetch must give the same result as single fetches.
+    std::vector<float> u(1000), v(1000);
+    for(int i = 0; i < u.size(); i++) {
+        u[i] = 3.0f*i / u.size() - 1.0f;
+        v[i] = 1.0f - 2.3f*i / u.size();
+    }
+    int errors = 0;
+    for(auto filter : {Sampler::FilterNearest, Sampler::FilterLinear}) {
+        for(auto wrap : {Sampler::WrapRepeat, Sampler::WrapClamp,
+                         Sampler::WrapMirror, Sampler::WrapBorder}) {
+            sampler.set_filter_mode(filter);
+            sampler.set_wrap_mode(wrap);
+            errors += check_batched(sampler, u, v);
+        }
+    }
+    cout << "Batched fetch errors : " << errors << endl;
+
+    // Host mapping composed with a coordinate normalizer.
+    sampler.set_filter_mode(Sampler::FilterNearest);
+    sampler.set_wrap_mode(Sampler::WrapClamp);
+    auto mapping = HostMapping<float, NormalizerUV>::Create(sampler,
+        NormalizerUV({Point2<float>({4.0f, 2.0f})}));
+    auto map = mapping->host_map();
+    cout << "Mapping  : " << map(Point2<float>({2.0f, 1.0f})) << " (expected 6)" << endl;
+
+    std::vector<Point2<float>> pixels({{0,0},{1,0},{2,0},{3,0},{0,1},{1,1},{2,1},{3,1}});
+    std::vector<float> mapped(pixels.size());
+    mapping->map(pixels.data(), mapped.data(), pixels.size());
+    cout << "Mapped   :";
+    for(auto value : mapped) cout << " " << value;
+    cout << endl;
+
+    // Degenerate inputs : empty images are rejected, a sampler without an
+    // image returns the border color, and NaN coordinates are well defined.
+    try {
+        Sampler empty(Sampler::ImageType({0, 0}));
+        errors++;
+    }
+    catch(const std::runtime_error&) {}
+    Sampler unset;
+    unset.set_border_color(-1.0f);
+    float out[3];
+    unset.fetch(u.data(), v.data(), out, 3);
+    if(unset(0.5f, 0.5f) != -1.0f || out[0] != -1.0f || out[2] != -1.0f) errors++;
+    const float nan = std::nanf("");
+    for(auto wrap : {Sampler::WrapRepeat, Sampler::WrapMirror}) {
+        sampler.set_wrap_mode(wrap);
+        sampler.set_filter_mode(Sampler::FilterNearest);
+        float batchedNan;
+        sampler.fetch(&nan, &nan, &batchedNan, 1);
+        if(sampler(nan, nan) != sampler(0.0f, 0.0f) || batchedNan != sampler(0.0f, 0.0f))
+            errors++;
+        sampler.set_filter_mode(Sampler::FilterLinear);
+        sampler(nan, 0.5f);
+    }
+    cout << "Errors : " << errors << endl;
+
+    return errors;
+}
@@ -0,0 +1,48 @@
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <cmath>
+using namespace std;
+
+#include <rtac_base/time.h>
+using namespace rtac::time;
+
+int main()
+{
+    int errors = 0;
+    cout << "Using TSC            : " << TickClock::uses_tsc() << endl;
+    cout << "Nanoseconds per tick : " << TickClock::nanoseconds_per_tick() << endl;
+
+    // Tick durations must match std::chrono durations.
+    for(int ms : {5, 50}) {
+        auto t0 = std::chrono::steady_clock::now();
+        auto ticks0 = TickClock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        auto ticks1 = TickClock::now();
+        auto t1 = std::chrono::steady_clock::now();
+
+        double reference = std::chrono::duration<double>(t1 - t0).count();
+        double measured  = TickClock::to_seconds(ticks1 - ticks0);
+        cout << "Sleep " << ms << "ms : " << 1.0e3*measured << "ms (reference "
+             << 1.0e3*reference << "ms)" << endl;
+        if(std::abs(measured - reference) > 0.01*reference + 1.0e-5) errors++;
+    }
+
+    // Cost of a timestamp.
+    const int N = 10000000;
+    uint64_t acc = 0;
+    Clock clock;
+    for(int i = 0; i < N; i++) {
+        acc += TickClock::now();
+    }
+    double tickCost = clock.interval() / N;
+    for(int i = 0; i < N; i++) {
+        acc += std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    }
+    double chronoCost = clock.interval() / N;
+    cout << "TickClock::now : " << 1.0e9*tickCost << "ns, high_resolution_clock::now : "
+         << 1.0e9*chronoCost << "ns" << (acc ? "" : " ") << endl;
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
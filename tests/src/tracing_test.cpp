@@ -0,0 +1,108 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+using namespace std;
+
+#include <rtac_base/tracing.h>
+using namespace rtac::time;
+
+int count_occurences(const std::string& str, const std::string& pattern)
+{
+    int count = 0;
+    for(auto pos = str.find(pattern); pos != std::string::npos;
+        pos = str.find(pattern, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+int main()
+{
+    int errors = 0;
+    Tracer::instance().set_buffer_size(64);
+
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 2; t++) {
+        threads.emplace_back([t]() {
+            Tracer::set_thread_name("worker" + std::to_string(t));
+            for(int i = 0; i < 10; i++) {
+                RTAC_TRACE_SCOPE("frame");
+                {
+                    RTAC_TRACE_SCOPE("stage");
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+                RTAC_TRACE_COUNTER("iteration", i);
+            }
+            RTAC_TRACE_INSTANT("done");
+        });
+    }
+    for(auto& t : threads) t.join();
+
+    std::ostringstream oss;
+    Tracer::instance().write_chrome_trace(oss);
+    auto trace = oss.str();
+    cout << trace.substr(0, 600) << "..." << endl;
+    if(count_occurences(trace, "\"ph\":\"B\"") != 40) errors++;
+    if(count_occurences(trace, "\"ph\":\"C\"") != 20) errors++;
+    if(count_occurences(trace, "\"name\":\"worker1\"") != 1) errors++;
+
+    // Ring buffer : only the last 63 events of a thread are kept (the slot
+    // being written is never read). The oldest one is an end event whose
+    // begin was overwritten, and is dropped at export.
+    std::thread([]() {
+        for(int i = 0; i < 1000; i++) {
+            RTAC_TRACE_SCOPE("overflow");
+        }
+    }).join();
+    oss.str("");
+    Tracer::instance().write_chrome_trace(oss);
+    int overflowEvents = count_occurences(oss.str(), "\"overflow\"");
+    cout << "Overflow events kept : " << overflowEvents << " (expected 62)" << endl;
+    if(overflowEvents != 62) errors++;
+
+    // Clearing while a thread is recording.
+    std::atomic<int> step(0);
+    std::thread recorder([&]() {
+        for(int i = 0; i < 10; i++) RTAC_TRACE_INSTANT("before_clear");
+        step = 1;
+        while(step != 2) std::this_thread::yield();
+        for(int i = 0; i < 3; i++) RTAC_TRACE_INSTANT("after_clear");
+    });
+    while(step != 1) std::this_thread::yield();
+    Tracer::instance().clear();
+    step = 2;
+    recorder.join();
+    oss.str("");
+    Tracer::instance().write_chrome_trace(oss);
+    int before = count_occurences(oss.str(), "\"before_clear\"");
+    int after  = count_occurences(oss.str(), "\"after_clear\"");
+    cout << "After clear : " << before << " old events, " << after
+         << " new events (expected 0 3)" << endl;
+    if(before != 0 || after != 3 || count_occurences(oss.str(), "\"overflow\"") != 0)
+        errors++;
+
+    // Buffers of exited threads : their events are kept until the next
+    // export, after which the buffers are reused by new threads.
+    std::thread([]() { RTAC_TRACE_INSTANT("exited"); }).join();
+    std::thread([]() { RTAC_TRACE_INSTANT("exited"); }).join();
+    oss.str("");
+    Tracer::instance().write_chrome_trace(oss);
+    int exited = count_occurences(oss.str(), "\"exited\"");
+    std::size_t buffers = Tracer::instance().buffer_count();
+    for(int t = 0; t < 20; t++) {
+        std::thread([]() { RTAC_TRACE_INSTANT("reused"); }).join();
+        oss.str("");
+        Tracer::instance().write_chrome_trace(oss);
+    }
+    cout << "Exited threads : " << exited << " events (expected 2), "
+         << Tracer::instance().buffer_count() << " buffers (expected "
+         << buffers << ")" << endl;
+    if(exited != 2 || Tracer::instance().buffer_count() != buffers) errors++;
+    if(count_occurences(oss.str(), "\"reused\"") != 1) errors++;
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}
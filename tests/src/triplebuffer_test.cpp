@@ -0,0 +1,73 @@
+#include <iostream>
+#include <vector>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+using namespace std;
+
+#include <rtac_base/types/TripleBuffer.h>
+#include <rtac_base/types/Image.h>
+#include <rtac_base/types/PointCloud.h>
+using namespace rtac::types;
+
+using ImageT = Image<float, std::vector>;
+
+int main()
+{
+    int errors = 0;
+
+    // The consumer only ever sees complete frames, in increasing order.
+    {
+        TripleBuffer<ImageT> mailbox(ImageT::Shape({64,48}));
+        if(mailbox.update()) errors++; // nothing published yet
+
+        const int frameCount = 20000;
+        std::atomic<bool> done(false);
+        std::thread producer([&]() {
+            for(int frame = 1; frame <= frameCount; frame++) {
+                auto& image = mailbox.back();
+                std::fill(image.data(), image.data() + image.size(), (float)frame);
+                mailbox.publish();
+            }
+            done = true;
+        });
+
+        std::set<const float*> storages;
+        int last = 0, torn = 0, backwards = 0;
+        while(!done || mailbox.has_update()) {
+            if(!mailbox.update()) continue;
+            const auto& image = mailbox.front();
+            storages.insert(image.data());
+            int frame = image[0];
+            if(frame <= last) backwards++;
+            for(std::size_t i = 0; i < image.size(); i++) {
+                if(image[i] != frame) { torn++; break; }
+            }
+            last = frame;
+        }
+        producer.join();
+
+        cout << "Published : " << mailbox.published() << ", consumed : "
+             << mailbox.consumed() << ", last frame : " << last << endl;
+        cout << "Torn frames : " << torn << ", out of order : " << backwards
+             << ", buffers seen : " << storages.size() << endl;
+        if(torn || backwards || last != frameCount || storages.size() > 3) errors++;
+        if(mailbox.published() != frameCount) errors++;
+    }
+
+    // Point clouds are preallocated for the given shape, without shared storage.
+    {
+        TripleBuffer<PointCloud<>> mailbox(PointCloud<>::Shape({100,2}));
+        auto& back = mailbox.back();
+        if(back.width() != 100 || back.height() != 2) errors++;
+        back[0] = Point3<float>({1,2,3});
+        mailbox.publish();
+        if(!mailbox.update() || mailbox.front()[0].x != 1) errors++;
+        if(&mailbox.front().point_cloud() == &mailbox.back().point_cloud()) errors++;
+        if(mailbox.update()) errors++;
+    }
+
+    cout << "Errors : " << errors << endl;
+    return errors;
+}